@@ -60,6 +60,8 @@ extern "C"
 
 // Application headers
 #include "hzlPlatform_RgbLed.h"
+#include "hzlPlatform_LogEvents.h"
+#include "hzlPlatform_Telemetry.h"
 #include "hzl.h"
 
 #define HZL_PLATFORM_VERSION "v1.1.1"
@@ -78,18 +80,131 @@ extern "C"
 #define HZL_PLATFORM_ERR_HZL_NO_CLIENTS_YET      HZL_PLATFORM_RGB_COLOR_WHITE
 
 // FreeRTOS task priorities
+// The stages of the TaskHzl pipeline can be tuned at compile time: the TaskHzl verifying the
+// received frames, the TaskHzlTx securing the frames to transmit, the TaskHzlApp consuming the
+// decrypted data and producing the plaintext to transmit.
+#ifndef HZL_PLATFORM_TASK_PRIORITY_HZL
 #define HZL_PLATFORM_TASK_PRIORITY_HZL (tskIDLE_PRIORITY + 2)
+#endif
+#ifndef HZL_PLATFORM_TASK_PRIORITY_HZL_TX
+#define HZL_PLATFORM_TASK_PRIORITY_HZL_TX (tskIDLE_PRIORITY + 1)
+#endif
+#ifndef HZL_PLATFORM_TASK_PRIORITY_HZL_APP
+#define HZL_PLATFORM_TASK_PRIORITY_HZL_APP (tskIDLE_PRIORITY + 1)
+#endif
+#define HZL_PLATFORM_TASK_PRIORITY_LOG (tskIDLE_PRIORITY + 1)
+#define HZL_PLATFORM_TASK_PRIORITY_ENTROPY (tskIDLE_PRIORITY + 1)
+
+// FreeRTOS task stack sizes in words
+#ifndef HZL_PLATFORM_TASK_STACK_WORDS_HZL
+#define HZL_PLATFORM_TASK_STACK_WORDS_HZL 500U
+#endif
+#define HZL_PLATFORM_TASK_STACK_WORDS_HZL_TX HZL_PLATFORM_TASK_STACK_WORDS_HZL
+#define HZL_PLATFORM_TASK_STACK_WORDS_HZL_APP (configMINIMAL_STACK_SIZE * 2U)
+#define HZL_PLATFORM_TASK_STACK_WORDS_LOG (configMINIMAL_STACK_SIZE * 5U)
+#define HZL_PLATFORM_TASK_STACK_WORDS_ENTROPY (configMINIMAL_STACK_SIZE * 2U)
+
+// Entropy pool configuration
+// Random bytes generated ahead of time by the CSEc for the Hazelnet library; it must fit
+// at least one handshake or session renewal.
+#define HZL_PLATFORM_ENTROPY_POOL_LEN 128U
+// Upon a CSEc failure, the TaskEntropy tries refilling the pool again after this long.
+#define HZL_PLATFORM_ENTROPY_RETRY_TICKS 100U
+
+// Deferred logging configuration
+// Log messages wait in a queue drained by the low-priority TaskLog, which transmits at most
+// HZL_PLATFORM_LOG_BURST messages at once and then one every HZL_PLATFORM_LOG_TICKS_PER_MSG.
+// Repetitions of the same message within HZL_PLATFORM_LOG_COALESCE_TICKS are transmitted once
+// as "<message> xN".
+#define HZL_PLATFORM_LOG_QUEUE_LEN 8U
+#define HZL_PLATFORM_LOG_MSG_MAX_LEN 61U
+#define HZL_PLATFORM_LOG_BURST 4U
+#define HZL_PLATFORM_LOG_TICKS_PER_MSG 100U
+#define HZL_PLATFORM_LOG_COALESCE_TICKS 1000U
+// Upon power-down, time given to the TaskLog to transmit the remaining messages.
+#define HZL_PLATFORM_LOG_DEINIT_TIMEOUT_TICKS 1000U
+
+// CAN FD buses
+// Amount of buses (FLEXCAN instances) the node is attached to, from 1 to 3 on the S32K144.
+// Each bus has its own Hazelnet context (hzlCtx0, hzlCtx1, hzlCtx2), its own RX slots, TX queue
+// and mailboxes and its own TaskHzl, so the buses are served independently. Bus 0 is FLEXCAN0
+// (canCom1 in Processor Expert), bus 1 FLEXCAN1 (canCom2), bus 2 FLEXCAN2 (canCom3).
+#ifndef HZL_PLATFORM_BUSES_AMOUNT
+#define HZL_PLATFORM_BUSES_AMOUNT 1U
+#endif
+// The log messages, the buttons and the latency histograms dump are handled on this bus.
+#define HZL_PLATFORM_BUS_MAIN 0U
+
+// TaskHzl pipeline
+// The work of each bus is split into three tasks: the TaskHzl verifies and decrypts the received
+// frames and reacts to them, the TaskHzlApp consumes the decrypted data and produces the
+// plaintext to transmit, the TaskHzlTx secures and transmits it. They are connected by bounded
+// queues: a full queue discards the message instead of blocking the stage filling it. The
+// Hazelnet context of the bus is shared by the TaskHzl and the TaskHzlTx under a mutex.
+// Define HZL_PLATFORM_TASKHZL_SINGLE to do all of it in the TaskHzl alone instead.
+// Define HZL_PLATFORM_AGGREGATION on all nodes to let the TaskHzlTx pack the messages for the
+// same Group into one secured frame, see hzlPlatform_Aggregation.h.
+#define HZL_PLATFORM_PIPELINE_APP_QUEUE_LEN 8U
+#define HZL_PLATFORM_PIPELINE_TX_QUEUE_LEN 8U
+#if defined(HZL_PLATFORM_AGGREGATION) && defined(HZL_PLATFORM_TASKHZL_SINGLE)
+#error "The message aggregation is a stage of the TaskHzl pipeline."
+#endif
 
 // CAN transmission configuration
-#define HZL_PLATFORM_CANFD_TX_MAILBOX_INDEX 0U
-#define HZL_PLATFORM_CANFD_TX_TRIES 10U
-#define HZL_PLATFORM_CANFD_TX_TIMEOUT_TICKS 30U
+// The frames to transmit wait in a queue, from which a pool of consecutive TX mailboxes is
+// refilled upon every transmission completion, without blocking the caller.
+#define HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX 0U
+#define HZL_PLATFORM_CANFD_TX_MAILBOX_AMOUNT 3U
+#define HZL_PLATFORM_CANFD_TX_QUEUE_LEN 16U
+// With the TX queue full and no transmission completed for this long, the bus is considered
+// unreachable.
+#define HZL_PLATFORM_CANFD_TX_STALL_TIMEOUT_TICKS 300U
+
+// CAN FD bit timing
+// The arbitration phase runs at the nominal bitrate set in Processor Expert (bitrate_value0).
+// The data phase of the frames runs at HZL_PLATFORM_CANFD_DATA_BITRATE, programmed at
+// initialisation from the FLEXCAN protocol clock (pe_clock_value0), which must be a multiple of
+// it. With a data-phase bitrate different from the nominal one, the mailboxes transmit with
+// Bit Rate Switch (BRS). Define it equal to the nominal bitrate to disable BRS: all transceivers
+// on the bus must support the data-phase bitrate.
+#define HZL_PLATFORM_CANFD_PROTOCOL_CLOCK_HZ 40000000UL
+#define HZL_PLATFORM_CANFD_NOMINAL_BITRATE 500000UL
+#ifndef HZL_PLATFORM_CANFD_DATA_BITRATE
+#define HZL_PLATFORM_CANFD_DATA_BITRATE 2000000UL
+#endif
+#define HZL_PLATFORM_CANFD_BRS \
+    (HZL_PLATFORM_CANFD_DATA_BITRATE != HZL_PLATFORM_CANFD_NOMINAL_BITRATE)
 
 // CAN reception configuration
-#define HZL_PLATFORM_CANFD_RX_MAILBOX_INDEX 1U
+// The incoming frames are spread over a pool of consecutive RX mailboxes, so a new frame can
+// land while the previous ones are still being copied out by the ISR.
+// With 64-byte payloads the S32K144 FLEXCAN0 RAM fits only 7 mailboxes in total (TX included),
+// see max_num_mb0 in ProcessorExpert.pe.
+#define HZL_PLATFORM_CANFD_MAILBOX_AMOUNT_MAX 7U
+#define HZL_PLATFORM_CANFD_RX_MAILBOX_FIRST_INDEX \
+    (HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_TX_MAILBOX_AMOUNT)
+#define HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT 4U
+// FLEXCAN1 and FLEXCAN2 have half the RAM of FLEXCAN0: only 3 mailboxes with 64-byte payloads,
+// used as 1 TX mailbox followed by 2 RX mailboxes.
+#define HZL_PLATFORM_CANFD_SMALL_MAILBOX_AMOUNT_MAX 3U
+#define HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT 1U
+#define HZL_PLATFORM_CANFD_SMALL_RX_MAILBOX_AMOUNT 2U
+// Received frames waiting for the TaskHzl to process them.
 #define HZL_PLATFORM_CANFD_RX_QUEUE_LEN 8U
-#define HZL_PLATFORM_CANFD_RX_QUEUE_POP_TIMEOUT_TICKS 50U
-#define HZL_PLATFORM_HZL_MAX_SECURITY_WARNINGS_BEFORE_REQ 5U
+// They wait in two lanes: the handshake and Session renewal frames (REQ, RES, REN), which
+// are always processed first, and the application data. The last free slots are reserved to the
+// former, so a burst of data frames cannot push a RES out and stall a handshake for
+// timeoutReqToResMillis. Define HZL_PLATFORM_CANFD_RX_SINGLE_LANE for a single lane in
+// reception order without reservation.
+#define HZL_PLATFORM_CANFD_RX_CONTROL_RESERVED_SLOTS 2U
+// Preallocated frame slots the mailboxes receive into: one armed per RX mailbox plus the
+// ones waiting for the TaskHzl. Handed over with SPSC rings of capacity (power of 2) enough to
+// hold all slots.
+#define HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT \
+    (HZL_PLATFORM_CANFD_RX_QUEUE_LEN + HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT)
+#define HZL_PLATFORM_CANFD_RX_RING_CAPACITY 16U
+// Button 2 held down at least this long is a long press.
+#define HZL_PLATFORM_BUTTON_LONG_PRESS_MICROS 1000000U
 
 
 typedef enum hzlPlatform_TaskEventBitmap
@@ -98,8 +213,19 @@ typedef enum hzlPlatform_TaskEventBitmap
     HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED = 0x01U,
     HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED = 0x02U,
     HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED = 0x04U,
+    HZL_PLATFORM_TASK_EVENT_CANFD_RX = 0x08U,
+    HZL_PLATFORM_TASK_EVENT_BUTTON_2_LONG_PRESSED = 0x10U,
+    /** Decrypted data handed over to the TaskHzlApp, see #HZL_PLATFORM_PIPELINE_APP_QUEUE_LEN. */
+    HZL_PLATFORM_TASK_EVENT_APP_RX = 0x20U,
+    /** Request held back by hzlPlatform_HandshakeBackoff.h: transmit it once due. */
+    HZL_PLATFORM_TASK_EVENT_HANDSHAKE_DEFERRED = 0x40U,
 } hzlPlatform_TaskEventBitmap_t;
 
+/**
+ * CAN ID each node transmits with. The Client with SID s uses
+ * #HZL_PLATFORM_CANID_FROM_ALICE - 1 + s, which is how the acceptance filters of
+ * hzlPlatform_CanFilter.h tell the CAN IDs of the other nodes.
+ */
 typedef enum hzlPlatform_CanId
 {
     HZL_PLATFORM_CANID_FROM_SERVER = 0x700U,
@@ -111,30 +237,50 @@ typedef enum hzlPlatform_CanId
 #if defined(HZL_PLATFORM_ROLE_SERVER)
 #define HZL_PLATFORM_CANID_FROM_ME HZL_PLATFORM_CANID_FROM_SERVER
 #define HZL_PLATFORM_COUNTER_START 0xF0U
-#define HZL_PLATFORM_TX_TIMER_TICKS 2000U
+#define HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE 2000U
 #elif defined(HZL_PLATFORM_ROLE_ALICE)
 #define HZL_PLATFORM_CANID_FROM_ME HZL_PLATFORM_CANID_FROM_ALICE
 #define HZL_PLATFORM_COUNTER_START 0xA0U
-#define HZL_PLATFORM_TX_TIMER_TICKS 3000U
+#define HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE 3000U
 #elif defined(HZL_PLATFORM_ROLE_BOB)
 #define HZL_PLATFORM_CANID_FROM_ME HZL_PLATFORM_CANID_FROM_BOB
 #define HZL_PLATFORM_COUNTER_START 0xB0U
-#define HZL_PLATFORM_TX_TIMER_TICKS 4000U
+#define HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE 4000U
 #elif defined(HZL_PLATFORM_ROLE_CHARLIE)
 #define HZL_PLATFORM_CANID_FROM_ME HZL_PLATFORM_CANID_FROM_CHARLIE
 #define HZL_PLATFORM_COUNTER_START 0xC0U
-#define HZL_PLATFORM_TX_TIMER_TICKS 5000U
+#define HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE 5000U
+#elif defined(HZL_PLATFORM_ROLE_CLIENT)
+// Any Client of a larger configuration, e.g. the fleet of the host simulation, by its SID.
+#if !defined(HZL_PLATFORM_CLIENT_SID) || HZL_PLATFORM_CLIENT_SID < 1 || HZL_PLATFORM_CLIENT_SID > 32
+#error "HZL_PLATFORM_ROLE_CLIENT requires HZL_PLATFORM_CLIENT_SID, the SID of the Client: 1 to 32."
+#endif
+#define HZL_PLATFORM_CANID_FROM_ME \
+    ((hzlPlatform_CanId_t) (HZL_PLATFORM_CANID_FROM_ALICE - 1U + HZL_PLATFORM_CLIENT_SID))
+#define HZL_PLATFORM_COUNTER_START 0xD0U
+#define HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE 3000U
 #else
-#error "Define one of the following macros at compile time: HZL_PLATFORM_ROLE_{SERVER|ALICE|BOB|CHARLIE}"
+#error "Define at compile time one of: HZL_PLATFORM_ROLE_{SERVER|ALICE|BOB|CHARLIE|CLIENT}"
+#endif
+// Period of the traffic generator (hzlPlatform_TrafficGen.h), which can be shortened at compile
+// time to load the bus.
+#ifndef HZL_PLATFORM_TX_TIMER_TICKS
+#define HZL_PLATFORM_TX_TIMER_TICKS HZL_PLATFORM_TX_TIMER_TICKS_OF_ROLE
+#endif
+
+#if HZL_PLATFORM_BUSES_AMOUNT < 1U || HZL_PLATFORM_BUSES_AMOUNT > HZL_PLATFORM_TELEMETRY_BUSES_MAX
+#error "The S32K144 has 3 FLEXCAN instances: HZL_PLATFORM_BUSES_AMOUNT must be 1, 2 or 3."
 #endif
 
 #if defined(HZL_PLATFORM_ROLE_SERVER)
+#define HZL_PLATFORM_HZL_CTX_T hzl_ServerCtx_t
 #define HZL_PLATFORM_HZL_INIT hzl_ServerInit
 #define HZL_PLATFORM_HZL_BUILD_UNSECURED hzl_ServerBuildUnsecured
 #define HZL_PLATFORM_HZL_PROCESS_RECEIVED hzl_ServerProcessReceived
 #define HZL_PLATFORM_HZL_BUILD_SECURED_FD hzl_ServerBuildSecuredFd
 #define HZL_PLATFORM_HZL_DEINIT hzl_ServerDeInit
 #else
+#define HZL_PLATFORM_HZL_CTX_T hzl_ClientCtx_t
 #define HZL_PLATFORM_HZL_INIT hzl_ClientInit
 #define HZL_PLATFORM_HZL_BUILD_UNSECURED hzl_ClientBuildUnsecured
 #define HZL_PLATFORM_HZL_PROCESS_RECEIVED hzl_ClientProcessReceived
@@ -151,52 +297,134 @@ void
 hzlPlatform_InitFreeRtos(void);
 
 /**
- * Initialised the FLEXCAN driver for a CAN FD bus, accpeting all CAN IDs (no filtering)
- * and automatically pushing received messages into the queue returned by the function for the
- * main application/task to pop when it has time.
- * @return queue of received messages.
+ * Initialised the FLEXCAN driver for the given CAN FD bus, accepting only the CAN IDs of the
+ * nodes the given SID exchanges messages with (see hzlPlatform_CanFilter.h), and automatically
+ * handing received messages over to the given task, which obtains them with
+ * hzlPlatform_FlexcanRxAcquire() when it has time.
+ *
+ * With #HZL_PLATFORM_CANFD_RX_ACCEPT_ALL defined, all CAN IDs are accepted instead.
+ * The self reception of the FLEXCAN is disabled, so the node never receives its own frames,
+ * unless #HZL_PLATFORM_CANFD_RX_SELF is defined.
+ *
+ * The task is notified of every reception. The notification is read with xTaskNotifyWait().
+ * The set notification bitflag is #HZL_PLATFORM_TASK_EVENT_CANFD_RX.
+ *
+ * @param bus index of the bus, below #HZL_PLATFORM_BUSES_AMOUNT.
+ * @param ownSid SID of this node in the Hazelnet configuration of the bus.
+ * @param taskToNotify the TaskHzl of the bus.
+ */
+void
+hzlPlatform_FlexcanInit(uint8_t bus, uint8_t ownSid, TaskHandle_t taskToNotify);
+
+/**
+ * Obtains the oldest received, unprocessed CAN FD message of the given bus, if any. Non-blocking.
+ * The handshake and Session renewal messages come before any application data, see
+ * #HZL_PLATFORM_CANFD_RX_CONTROL_RESERVED_SLOTS.
+ *
+ * The message is not copied: it's the very slot the FLEXCAN driver received into, so it must be
+ * processed in place and given back with hzlPlatform_FlexcanRxRelease() before acquiring the
+ * next one. Only the task notified of the receptions of the bus may call this function.
+ *
+ * @return the received message or NULL if there is none
  */
-QueueHandle_t
-hzlPlatform_FlexcanInit(void);
+const flexcan_msgbuff_t*
+hzlPlatform_FlexcanRxAcquire(uint8_t bus);
 
 /**
- * Deinitialises the FLEXCAN driver for the CAN FD bus.
+ * Gives the message obtained with hzlPlatform_FlexcanRxAcquire() on the same bus back to the
+ * FLEXCAN driver to receive into it again. The message must not be accessed afterwards.
  */
 void
-hzlPlatform_FlexcanDeinit(void);
+hzlPlatform_FlexcanRxRelease(uint8_t bus);
 
 /**
- * Blocking transmission of a CAN FD message with automatic retries when busy.
+ * Time of the reception of the message obtained with hzlPlatform_FlexcanRxAcquire() on the same
+ * bus, taken by the FLEXCAN interrupt, in microseconds of hzlPlatform_ClockMicros().
  *
- * Tries to transmit a few times in case the CAN driver is busy or the internal blocking timeouts
- * are reached. In case no transmission could succeed, a fatal error state is entered, as it's
- * probably a bus connector issue in the context of this demo platform.
+ * Used to measure the latency from the bus to the application.
+ */
+uint64_t
+hzlPlatform_FlexcanRxAcquiredMicros(uint8_t bus);
+
+/**
+ * Amount of received CAN FD frames of the given bus that were overwritten in a reception mailbox
+ * by a newer one before the FLEXCAN interrupt could copy them out, i.e. frames lost in hardware.
+ *
+ * A non-zero value means that #HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT is too small for the
+ * bus load or that the interrupt latency is too high.
+ */
+uint32_t
+hzlPlatform_FlexcanRxLostFramesInHw(uint8_t bus);
+
+/**
+ * Deinitialises the FLEXCAN driver of the given CAN FD bus, after waiting up to
+ * #HZL_PLATFORM_CANFD_TX_STALL_TIMEOUT_TICKS for the queued frames to be transmitted.
  */
 void
-hzlPlatform_FlexcanTransmit(const uint8_t* payload, const size_t payloadLen);
+hzlPlatform_FlexcanDeinit(uint8_t bus);
+
+/**
+ * Non-blocking transmission of a CAN FD message on the given bus.
+ *
+ * The message is copied into the TX queue of the bus and the function returns immediately: the
+ * TX mailboxes pick the queued messages up in order as the previous ones complete, from the
+ * FLEXCAN interrupt. Safe to call from any task, for any bus.
+ *
+ * If the TX queue is full, the message is discarded and counted in #hzlPlatform_Telemetry.
+ * If in addition no transmission completed for #HZL_PLATFORM_CANFD_TX_STALL_TIMEOUT_TICKS,
+ * a fatal error state is entered, as it's probably a bus connector issue in the context of this
+ * demo platform.
+ */
+void
+hzlPlatform_FlexcanTransmit(uint8_t bus, const uint8_t* payload, const size_t payloadLen);
 
 /**
  * Creates a periodic timer a flag every #HZL_PLATFORM_TX_TIMER_TICKS ticks
- * that notifies the given task on expiration.
+ * that notifies the given task on expiration. One timer per bus.
  *
- * The notification is read with ulTaskNotifyTake().
+ * The notification is read with xTaskNotifyWait().
  * The set notification bitflag is #HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED.
  */
 void
-hzlPlatform_PeriodicTxTimerInit(TaskHandle_t taskToNotify);
+hzlPlatform_PeriodicTxTimerInit(uint8_t bus, TaskHandle_t taskToNotify);
 
 /**
  * Sets the Button 1 (SW3 on the eval-board) and 2 (Sw2) to notify the given task on button press.
  *
  * **No** debouncing is performed.
  *
- * The notification is read with ulTaskNotifyTake().
- * The set notification bitflags are #HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED
- * and #HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED.
+ * Button 1 notifies when pressed down, Button 2 when released, to tell a short press from a
+ * press longer than #HZL_PLATFORM_BUTTON_LONG_PRESS_MICROS.
+ *
+ * The notification is read with xTaskNotifyWait().
+ * The set notification bitflags are #HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED,
+ * #HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED and #HZL_PLATFORM_TASK_EVENT_BUTTON_2_LONG_PRESSED.
  */
 void
 hzlPlatform_Button1And2Init(TaskHandle_t taskToNotify);
 
+/**
+ * Creates the low-priority TaskEntropy filling the pool of random bytes read by
+ * hzlPlatform_EntropyGet().
+ *
+ * To be called after the CSEc RNG is initialised.
+ */
+void
+hzlPlatform_EntropyInit(void);
+
+/**
+ * Provides random bytes from the pool, if it holds enough of them, otherwise generates them
+ * with the CSEc on the spot.
+ *
+ * Callable from the TaskHzl of every bus: the requests are served one at the time.
+ *
+ * @param bytes where to write the random bytes.
+ * @param amount amount of random bytes.
+ * @return false if the CSEc failed generating them.
+ */
+bool
+hzlPlatform_EntropyGet(uint8_t* bytes, size_t amount);
+
 /**
  * Wrapper/adapter of a True Random Number Generator into the function signature the Hazelnet
  * library (both Client and Server) can use. See #hzl_TrngFunc.
@@ -212,11 +440,64 @@ hzl_Err_t
 hzlPlatform_HzlAdapterCurrentTime(hzl_Timestamp_t* timestamp);
 
 /**
- * Main application as a FreeRTOS task.
+ * Creates the low-priority TaskLog transmitting the messages passed to hzlPlatform_Log().
+ *
+ * To be called after the Hazelnet context is initialised, as it's used to build the messages.
+ */
+void
+hzlPlatform_LogInit(void);
+
+/**
+ * Queues a short (<= #HZL_PLATFORM_LOG_MSG_MAX_LEN chars, longer ones are truncated) ASCII
+ * string to be written to the bus in the form of a CBS UAD message, which all other parties are
+ * configured to ignore.
+ *
+ * Never blocks: if the queue is full, the message is discarded and counted in the telemetry.
+ * Safe to call from any task, not from ISRs.
+ *
+ * Prefer hzlPlatform_LogEvent() for frequent messages.
+ *
+ * @param string a human readable message.
+ */
+void
+hzlPlatform_Log(const char* string);
+
+/**
+ * Queues a binary log event, see hzlPlatform_LogEvents.h, with the same behaviour as
+ * hzlPlatform_Log().
+ *
+ * Transmits only the event ID and its arguments, leaving the formatting to the host decoder.
+ *
+ * @param event the event to log.
+ * @param args as many bytes as the arguments of the event; may be NULL if it has none.
+ */
+void
+hzlPlatform_LogEvent(hzlPlatform_LogEvent_t event, const uint8_t* args);
+
+/**
+ * Waits up to the given amount of ticks for the queued log messages to be handed over to
+ * the FLEXCAN driver, then stops the TaskLog, so the Hazelnet context can be deinitialised.
+ *
+ * Must be called from a task with higher priority than the TaskLog.
+ */
+void
+hzlPlatform_LogDeinit(TickType_t maxWaitTicks);
+
+/**
+ * Main application as a FreeRTOS task, one per bus.
+ *
+ * Sleeps until any of the #hzlPlatform_TaskEventBitmap_t events is notified to it.
+ *
+ * Only the TaskHzl of #HZL_PLATFORM_BUS_MAIN is created at startup: it initialises the shared
+ * services (CSEc, entropy pool, log, buttons) and then creates the TaskHzl of every other bus.
+ * Unless #HZL_PLATFORM_TASKHZL_SINGLE is defined, each TaskHzl only verifies the received
+ * messages and creates the TaskHzlApp and TaskHzlTx of its bus for the rest of the pipeline.
  *
- * @param rxCanMsgsQueue queue where the FLEXCAN driver places the received CAN FD messages.
+ * @param busIdx index of the bus, cast to a pointer: NULL for #HZL_PLATFORM_BUS_MAIN. The task
+ *        obtains the received CAN FD messages of its bus on its own from
+ *        hzlPlatform_FlexcanRxAcquire().
  */
-void hzlPlatform_TaskHzl(QueueHandle_t rxCanMsgsQueue);
+void hzlPlatform_TaskHzl(void* busIdx);
 
 #ifdef __cplusplus
 }
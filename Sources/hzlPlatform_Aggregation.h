@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Aggregation of small application messages for the same Group into one secured frame, so they
+ * share the CBS header, counter nonce and tag on the bus instead of paying them once each.
+ *
+ * The plaintext of an aggregate is a sequence of records, each a length byte followed by that
+ * many bytes of message, filling at most the 49 bytes of plaintext of a 64-byte SADFD. A batch
+ * is open per Group and is secured once it is full or once its oldest message waited
+ * #HZL_PLATFORM_AGGREGATION_BUDGET_MICROS, whatever comes first.
+ *
+ * Used by the TaskHzlTx with #HZL_PLATFORM_AGGREGATION defined, which all nodes must agree on:
+ * the receivers split every secured plaintext back into its records.
+ */
+
+#ifndef HZL_PLATFORM_AGGREGATION_H_
+#define HZL_PLATFORM_AGGREGATION_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "hzl.h"
+#include "hzlPlatform_TrafficGen.h"
+
+/** Largest plaintext of an aggregate: the one of a SADFD in a 64-byte CAN FD frame. */
+#define HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX HZL_PLATFORM_TRAFFIC_PAYLOAD_LIMIT
+/** Largest message, alone in its aggregate after its length byte. */
+#define HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN (HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX - 1U)
+
+#ifndef HZL_PLATFORM_AGGREGATION_BUDGET_MICROS
+/** Longest wait of a message for others to share its frame with. */
+#define HZL_PLATFORM_AGGREGATION_BUDGET_MICROS 2000U
+#endif
+#ifndef HZL_PLATFORM_AGGREGATION_BATCHES
+/** Groups with an open batch at the same time. One more flushes the batch due first. */
+#define HZL_PLATFORM_AGGREGATION_BATCHES 4U
+#endif
+
+#if HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN > HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN
+#error "Aggregated messages must leave room for their length byte: MAX_LEN <= 48."
+#endif
+#if HZL_PLATFORM_AGGREGATION_BATCHES < 1U
+#error "At least one aggregation batch is required."
+#endif
+
+/**
+ * Messages for one Group waiting to be secured together.
+ */
+typedef struct hzlPlatform_AggBatch
+{
+    /** When the batch must be secured at the latest, set by its first message. */
+    uint64_t deadlineMicros;
+    hzl_Gid_t gid;
+    /** Messages in the batch, 0 when the batch is free. */
+    uint8_t messages;
+    /** Bytes of the plaintext used by the records. */
+    uint8_t len;
+    uint8_t data[HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX];
+} hzlPlatform_AggBatch_t;
+
+/**
+ * Batches of a bus. Initialise with hzlPlatform_AggregatorInit() before use.
+ */
+typedef struct hzlPlatform_Aggregator
+{
+    hzlPlatform_AggBatch_t batches[HZL_PLATFORM_AGGREGATION_BATCHES];
+} hzlPlatform_Aggregator_t;
+
+/**
+ * Frees all batches, discarding their messages.
+ */
+static inline void
+hzlPlatform_AggregatorInit(hzlPlatform_Aggregator_t* const agg)
+{
+    memset(agg, 0, sizeof(*agg));
+}
+
+/**
+ * The batch a message for the Group goes into: the open one of the Group, else a free one,
+ * else the one due first, which must be secured and freed before with hzlPlatform_AggBatchFits()
+ * false.
+ */
+static inline hzlPlatform_AggBatch_t*
+hzlPlatform_AggregatorBatchOf(hzlPlatform_Aggregator_t* const agg, const hzl_Gid_t gid)
+{
+    hzlPlatform_AggBatch_t* freeBatch = NULL;
+    hzlPlatform_AggBatch_t* dueFirst = &agg->batches[0];
+    for (size_t i = 0U; i < HZL_PLATFORM_AGGREGATION_BATCHES; i++)
+    {
+        hzlPlatform_AggBatch_t* const batch = &agg->batches[i];
+        if (batch->messages == 0U)
+        {
+            freeBatch = (freeBatch == NULL) ? batch : freeBatch;
+        }
+        else if (batch->gid == gid)
+        {
+            return batch;
+        }
+        else if (batch->deadlineMicros < dueFirst->deadlineMicros)
+        {
+            dueFirst = batch;
+        }
+    }
+    return (freeBatch != NULL) ? freeBatch : dueFirst;
+}
+
+/**
+ * Whether a message of the given length for the Group can be appended to the batch without
+ * securing it first.
+ */
+static inline bool
+hzlPlatform_AggBatchFits(const hzlPlatform_AggBatch_t* const batch,
+                         const hzl_Gid_t gid,
+                         const size_t dataLen)
+{
+    return batch->messages == 0U
+           || (batch->gid == gid
+               && batch->len + 1U + dataLen <= HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX);
+}
+
+/**
+ * Appends a message as a record, opening the batch for the Group if free.
+ *
+ * @param dataLen 1 to #HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN, fitting into the batch
+ * @param deadlineMicros when to secure the batch at the latest, if this is its first message
+ */
+static inline void
+hzlPlatform_AggBatchAppend(hzlPlatform_AggBatch_t* const batch,
+                           const hzl_Gid_t gid,
+                           const uint8_t* const data,
+                           const size_t dataLen,
+                           const uint64_t deadlineMicros)
+{
+    if (batch->messages == 0U)
+    {
+        batch->gid = gid;
+        batch->len = 0U;
+        batch->deadlineMicros = deadlineMicros;
+    }
+    batch->data[batch->len] = (uint8_t) dataLen;
+    memcpy(&batch->data[batch->len + 1U], data, dataLen);
+    batch->len = (uint8_t) (batch->len + 1U + dataLen);
+    batch->messages++;
+}
+
+/**
+ * Whether not even a 1-byte message fits anymore, so the batch is worth securing right away.
+ */
+static inline bool
+hzlPlatform_AggBatchIsFull(const hzlPlatform_AggBatch_t* const batch)
+{
+    return batch->len + 2U > HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX;
+}
+
+/**
+ * Earliest deadline of the open batches, UINT64_MAX if all are free.
+ */
+static inline uint64_t
+hzlPlatform_AggregatorNextDeadline(const hzlPlatform_Aggregator_t* const agg)
+{
+    uint64_t deadline = UINT64_MAX;
+    for (size_t i = 0U; i < HZL_PLATFORM_AGGREGATION_BATCHES; i++)
+    {
+        const hzlPlatform_AggBatch_t* const batch = &agg->batches[i];
+        if (batch->messages > 0U && batch->deadlineMicros < deadline)
+        {
+            deadline = batch->deadlineMicros;
+        }
+    }
+    return deadline;
+}
+
+/**
+ * Whether a received plaintext is a sequence of non-empty records ending exactly at its end.
+ * Only then its records can be walked with their length bytes.
+ */
+static inline bool
+hzlPlatform_AggIsWellFormed(const uint8_t* const plaintext, const size_t plaintextLen)
+{
+    size_t offset = 0U;
+    while (offset < plaintextLen)
+    {
+        if (plaintext[offset] == 0U)
+        {
+            return false;
+        }
+        offset += 1U + plaintext[offset];
+    }
+    return offset == plaintextLen && plaintextLen > 0U;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_AGGREGATION_H_ */
@@ -33,7 +33,9 @@
  */
 
 #include "hzlPlatform.h"
+#include "hzlPlatform_Clock.h"
 #include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_Telemetry.h"
 
 #include "pins_driver.h"
 
@@ -48,10 +50,37 @@
 
 static TaskHandle_t taskToNotifyOnButtonPress = NULL;
 
+/**
+ * @internal
+ * Time when the Button 2 was pressed down, valid while isButton2Down.
+ */
+static uint64_t button2DownSinceMicros = 0U;
+static bool isButton2Down = false;
+
+/**
+ * @internal
+ * Sends the event bit to the task-to-notify from the buttons ISR.
+ */
+static void
+hzlPlatform_ButtonsNotifyFromIsr(const hzlPlatform_TaskEventBitmap_t event,
+                                 BaseType_t* const isTaskWaitingForButtons)
+{
+    hzlPlatform_TelemetryEventRaised(HZL_PLATFORM_BUS_MAIN, event);
+    xTaskNotifyFromISR(
+        taskToNotifyOnButtonPress,
+        event,
+        eSetBits, // The task's notification value is bitwise ORed with ulValue.
+        isTaskWaitingForButtons
+        );
+}
+
 /**
  * @internal
  * Sets the event bit for the Button 1 or 2 pressed to the event bitmap of the task-to-notify.
  *
+ * Button 1 interrupts on the rising edge only, Button 2 on both edges: its press is reported
+ * upon release, as short or long depending on how long it was held down.
+ *
  * Note: no debouncing is applied. As long as the button is not broken and it reports being pressed
  * when it's not, there is no need to verify the de-pressing of the button correctly, as the usage
  * of the buttons is not critical in any case.
@@ -59,26 +88,37 @@ static TaskHandle_t taskToNotifyOnButtonPress = NULL;
 static void
 hzlPlatform_CallbackOnButtonsPress(void)
 {
+    BaseType_t isTaskWaitingForButtons = pdFALSE;
+    // Only the pins whose edge triggered this interrupt, as the other button may be held down.
+    const uint32_t edgePinsBitmap = PINS_DRV_GetPortIntFlag(BUTTONS_1_2_PORT);
     const pins_channel_type_t highPinsBitmap = PINS_DRV_ReadPins(BUTTONS_1_2_GPIO);
-    if (highPinsBitmap & (1U << BUTTON1_PIN))
+    if ((edgePinsBitmap & (1U << BUTTON1_PIN)) && (highPinsBitmap & (1U << BUTTON1_PIN)))
     {
-        xTaskNotifyFromISR(
-            taskToNotifyOnButtonPress,
-            HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED,
-            eSetBits, // The task's notification value is bitwise ORed with ulValue.
-            NULL  // pxHigherPriorityTaskWoken: not time critical if someone was waiting for this event
-            );
+        hzlPlatform_ButtonsNotifyFromIsr(HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED,
+                                         &isTaskWaitingForButtons);
     }
-    if (highPinsBitmap & (1U << BUTTON2_PIN))
+    if (edgePinsBitmap & (1U << BUTTON2_PIN))
     {
-        xTaskNotifyFromISR(
-            taskToNotifyOnButtonPress,
-            HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED,
-            eSetBits, // The task's notification value is bitwise ORed with ulValue.
-            NULL  // pxHigherPriorityTaskWoken: not time critical if someone was waiting for this event
-            );
+        const uint64_t now = hzlPlatform_ClockMicros();
+        if (highPinsBitmap & (1U << BUTTON2_PIN))
+        {
+            button2DownSinceMicros = now;
+            isButton2Down = true;
+        }
+        else if (isButton2Down)
+        {
+            isButton2Down = false;
+            hzlPlatform_ButtonsNotifyFromIsr(
+                (now - button2DownSinceMicros >= HZL_PLATFORM_BUTTON_LONG_PRESS_MICROS)
+                ? HZL_PLATFORM_TASK_EVENT_BUTTON_2_LONG_PRESSED
+                : HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED,
+                &isTaskWaitingForButtons);
+        }
     }
     PINS_DRV_ClearPortIntFlagCmd(BUTTONS_1_2_PORT);
+    // The task sleeps until an event arrives: switch to it right after this interrupt instead of
+    // waiting for the next tick.
+    portYIELD_FROM_ISR(isTaskWaitingForButtons);
 }
 
 void
@@ -89,7 +129,8 @@ hzlPlatform_Button1And2Init(TaskHandle_t taskToNotify)
     PINS_DRV_SetMuxModeSel(BUTTONS_1_2_PORT, BUTTON2_PIN, PORT_MUX_AS_GPIO);
     // Rising edge = when pressed down = voltage goes from low to high
     PINS_DRV_SetPinIntSel(BUTTONS_1_2_PORT, BUTTON1_PIN, PORT_INT_RISING_EDGE);
-    PINS_DRV_SetPinIntSel(BUTTONS_1_2_PORT, BUTTON2_PIN, PORT_INT_RISING_EDGE);
+    // Falling edge = when released, to measure how long it was held down
+    PINS_DRV_SetPinIntSel(BUTTONS_1_2_PORT, BUTTON2_PIN, PORT_INT_EITHER_EDGE);
     // Buttons direction is set to input: 0=input, 1=output, thus we have to negate the bitmap.
     const pins_channel_type_t inputPinsBitmap = (1U << BUTTON1_PIN) | (1U << BUTTON2_PIN);
     PINS_DRV_SetPinsDirection(BUTTONS_1_2_GPIO, ~inputPinsBitmap);
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * CAN ID acceptance filtering derived from the Hazelnet configuration.
+ *
+ * Every node transmits with a CAN ID derived from its SID (see #hzlPlatform_CanId_t), so the
+ * frames a node has to receive are the ones of the SIDs it exchanges messages with: the Server
+ * hears all configured Clients, a Client hears the Server and the other members of its Groups.
+ * The FLEXCAN RX mailboxes are programmed to accept only those CAN IDs, so foreign traffic
+ * on a shared bus is discarded by the hardware without ever raising an interrupt.
+ *
+ * The table is generated from the Server configuration by toolsupport/hzlconfiggen into
+ * hzl_HardcodedConfigCanFilter.c and kept in flash. All roles.
+ */
+
+#ifndef HZL_PLATFORM_CANFILTER_H_
+#define HZL_PLATFORM_CANFILTER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/** Entries of the SID-indexed table: SID 0 is the Server, up to 32 Clients. */
+#define HZL_PLATFORM_CANFILTER_SIDS_AMOUNT 33U
+/** SID of the Server. */
+#define HZL_PLATFORM_CANFILTER_SID_SERVER 0U
+
+/**
+ * SIDs each SID receives frames from, as a bitmap: bit s set for SID s.
+ * Empty for SIDs that are not in the configuration.
+ */
+extern const uint64_t hzlPlatform_CanFilterPeersBySid[HZL_PLATFORM_CANFILTER_SIDS_AMOUNT];
+
+/**
+ * Bitmap of the SIDs the given SID receives frames from, 0 if the SID is not configured.
+ */
+static inline uint64_t
+hzlPlatform_CanFilterPeers(const uint8_t sid)
+{
+    return (sid < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT)
+           ? hzlPlatform_CanFilterPeersBySid[sid]
+           : 0U;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_CANFILTER_H_ */
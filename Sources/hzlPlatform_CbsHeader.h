@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Peeking into the CBS header of a received frame before Hazelnet processes it.
+ *
+ * Only for the header type 0 of the configurations in Sources/hzlconfig: 1 byte each of GID,
+ * SID and PTY (payload type), in this order. The PTY values are the ones of the CBS protocol.
+ */
+
+#ifndef HZL_PLATFORM_CBSHEADER_H_
+#define HZL_PLATFORM_CBSHEADER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Length of the CBS header type 0. */
+#define HZL_PLATFORM_CBS_HEADER_LEN 3U
+/** Position of the GID in the CBS header type 0. */
+#define HZL_PLATFORM_CBS_HEADER_GID_IDX 0U
+/** Position of the SID in the CBS header type 0. */
+#define HZL_PLATFORM_CBS_HEADER_SID_IDX 1U
+/** Position of the PTY in the CBS header type 0. */
+#define HZL_PLATFORM_CBS_HEADER_PTY_IDX 2U
+/**
+ * Bytes of a SADFD besides its plaintext: the CBS header type 0, 3 of counter nonce, 1 of
+ * plaintext length and 8 of tag, as in the configurations of Sources/hzlconfig.
+ */
+#define HZL_PLATFORM_CBS_SADFD_OVERHEAD 15U
+
+/** CBS payload types. */
+typedef enum hzlPlatform_CbsPty
+{
+    HZL_PLATFORM_CBS_PTY_SADFD = 0U,  ///< Secured application data over CAN FD
+    HZL_PLATFORM_CBS_PTY_SADTP = 1U,  ///< Secured application data over ISO-TP
+    HZL_PLATFORM_CBS_PTY_UAD = 2U,  ///< Unsecured application data
+    HZL_PLATFORM_CBS_PTY_REQ = 3U,  ///< Request of the Session information by a Client
+    HZL_PLATFORM_CBS_PTY_RES = 4U,  ///< Response of the Server with the Session information
+    HZL_PLATFORM_CBS_PTY_REN = 5U,  ///< Session renewal notification by the Server
+    /** Frame too short to have a CBS header. */
+    HZL_PLATFORM_CBS_PTY_NONE = 0xFFU,
+} hzlPlatform_CbsPty_t;
+
+/**
+ * Payload type of a CBS frame, #HZL_PLATFORM_CBS_PTY_NONE if it's too short.
+ */
+static inline hzlPlatform_CbsPty_t
+hzlPlatform_CbsPty(const uint8_t* const data, const uint32_t dataLen)
+{
+    return (dataLen >= HZL_PLATFORM_CBS_HEADER_LEN)
+           ? (hzlPlatform_CbsPty_t) data[HZL_PLATFORM_CBS_HEADER_PTY_IDX]
+           : HZL_PLATFORM_CBS_PTY_NONE;
+}
+
+/**
+ * True for the frames of the handshake and of the Session renewal (REQ, RES, REN), which
+ * the whole Group waits for, false for application data.
+ */
+static inline bool
+hzlPlatform_CbsIsControl(const uint8_t* const data, const uint32_t dataLen)
+{
+    const hzlPlatform_CbsPty_t pty = hzlPlatform_CbsPty(data, dataLen);
+    return pty == HZL_PLATFORM_CBS_PTY_REQ
+           || pty == HZL_PLATFORM_CBS_PTY_RES
+           || pty == HZL_PLATFORM_CBS_PTY_REN;
+}
+
+/**
+ * True for the frames carrying secured application data (SADFD, SADTP), which Hazelnet has to
+ * authenticate and decrypt.
+ */
+static inline bool
+hzlPlatform_CbsIsSecured(const uint8_t* const data, const uint32_t dataLen)
+{
+    const hzlPlatform_CbsPty_t pty = hzlPlatform_CbsPty(data, dataLen);
+    return pty == HZL_PLATFORM_CBS_PTY_SADFD || pty == HZL_PLATFORM_CBS_PTY_SADTP;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_CBSHEADER_H_ */
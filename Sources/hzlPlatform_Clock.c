@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Free-running 64-bit monotonic clock with microsecond resolution, extending the SysTick timer
+ * which FreeRTOS uses for its 1 ms tick.
+ *
+ * The elapsed ticks are counted in 64 bits by the tick hook, so the clock never wraps around,
+ * and the microseconds within the current tick are read from the SysTick down-counter, which
+ * runs at the core clock. No additional timer peripheral is used.
+ */
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_Clock.h"
+
+_Static_assert(configCPU_CLOCK_HZ % 1000000UL == 0UL,
+               "The core clock must be a multiple of 1 MHz for the microsecond conversion.");
+_Static_assert(configTICK_RATE_HZ == 1000UL, "The clock assumes a 1 ms FreeRTOS tick.");
+
+/** @internal SysTick counts per microsecond. */
+#define HZL_PLATFORM_CLOCK_CYCLES_PER_MICRO (configCPU_CLOCK_HZ / 1000000UL)
+
+/**
+ * @internal
+ * Ticks elapsed since the scheduler started. Written only by the tick interrupt.
+ */
+static volatile uint64_t hzlPlatform_ClockTicks = 0U;
+
+void
+hzlPlatform_ClockOnTick(void)
+{
+    hzlPlatform_ClockTicks++;
+}
+
+uint64_t
+hzlPlatform_ClockMicros(void)
+{
+    // The FROM_ISR variant masks the tick interrupt from both tasks and ISRs.
+    const UBaseType_t interruptMask = taskENTER_CRITICAL_FROM_ISR();
+    uint64_t ticks = hzlPlatform_ClockTicks;
+    uint32_t elapsedCycles = S32_SysTick->RVR - S32_SysTick->CVR;
+    if (S32_SCB->ICSR & S32_SCB_ICSR_PENDSTSET_MASK)
+    {
+        // The SysTick reloaded but its interrupt is masked, so the tick is not counted yet.
+        // Read the down-counter again, as the first read may precede the reload.
+        ticks++;
+        elapsedCycles = S32_SysTick->RVR - S32_SysTick->CVR;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(interruptMask);
+    return ticks * 1000U + elapsedCycles / HZL_PLATFORM_CLOCK_CYCLES_PER_MICRO;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Snapshots of the CPU share per task, see hzlPlatform_CpuStats.h.
+ */
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_CpuStats.h"
+#include "hzlPlatform_FatalError.h"
+
+#if configGENERATE_RUN_TIME_STATS != 1 || configUSE_TRACE_FACILITY != 1
+#error "The CPU statistics require configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY."
+#endif
+
+volatile hzlPlatform_CpuStats_t hzlPlatform_CpuStats;
+
+/**
+ * @internal
+ * Run-time counter of each task at the previous snapshot, identified by its task number.
+ */
+typedef struct hzlPlatform_CpuStatsPrevious
+{
+    UBaseType_t taskNumber;
+    uint32_t runTimeCounter;
+} hzlPlatform_CpuStatsPrevious_t;
+
+static hzlPlatform_CpuStatsPrevious_t hzlPlatform_CpuStatsPrevious[HZL_PLATFORM_CPU_STATS_TASKS_MAX];
+static UBaseType_t hzlPlatform_CpuStatsPreviousAmount = 0U;
+static uint32_t hzlPlatform_CpuStatsPreviousTotal = 0U;
+
+/**
+ * @internal
+ * Kept static, as the stack of the timer task is small.
+ */
+static TaskStatus_t hzlPlatform_CpuStatsTaskStatus[HZL_PLATFORM_CPU_STATS_TASKS_MAX];
+
+/**
+ * @internal
+ * Run-time counter of the given task at the previous snapshot, 0 for a new task.
+ */
+static uint32_t
+hzlPlatform_CpuStatsPreviousCounter(const UBaseType_t taskNumber)
+{
+    for (UBaseType_t i = 0U; i < hzlPlatform_CpuStatsPreviousAmount; i++)
+    {
+        if (hzlPlatform_CpuStatsPrevious[i].taskNumber == taskNumber)
+        {
+            return hzlPlatform_CpuStatsPrevious[i].runTimeCounter;
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @internal
+ * Computes the CPU share of each task since the previous snapshot.
+ * The counters are 32-bit, so their differences are correct across wrap-arounds.
+ */
+static void
+hzlPlatform_CpuStatsSnapshot(TimerHandle_t unusedTimer)
+{
+    (void) unusedTimer;
+    uint32_t total = 0U;
+    // Returns 0 if there are more tasks than entries: the snapshot is skipped.
+    const UBaseType_t tasksAmount = uxTaskGetSystemState(
+        hzlPlatform_CpuStatsTaskStatus,
+        HZL_PLATFORM_CPU_STATS_TASKS_MAX,
+        &total);
+    const uint32_t totalDelta = total - hzlPlatform_CpuStatsPreviousTotal;
+    if (tasksAmount == 0U || totalDelta == 0U)
+    {
+        return;
+    }
+    for (UBaseType_t i = 0U; i < tasksAmount; i++)
+    {
+        const TaskStatus_t* const status = &hzlPlatform_CpuStatsTaskStatus[i];
+        const uint32_t delta = (uint32_t) status->ulRunTimeCounter
+                               - hzlPlatform_CpuStatsPreviousCounter(status->xTaskNumber);
+        volatile hzlPlatform_CpuStatsTask_t* const task = &hzlPlatform_CpuStats.tasks[i];
+        for (size_t c = 0U; c < sizeof(task->name); c++)
+        {
+            task->name[c] = status->pcTaskName[c];
+        }
+        task->name[sizeof(task->name) - 1U] = '\0';
+        task->sharePermille = (uint32_t) ((uint64_t) delta * 1000U / totalDelta);
+        task->stackHighWaterMarkWords = (uint32_t) status->usStackHighWaterMark;
+    }
+    for (UBaseType_t i = 0U; i < tasksAmount; i++)
+    {
+        hzlPlatform_CpuStatsPrevious[i].taskNumber = hzlPlatform_CpuStatsTaskStatus[i].xTaskNumber;
+        hzlPlatform_CpuStatsPrevious[i].runTimeCounter =
+            (uint32_t) hzlPlatform_CpuStatsTaskStatus[i].ulRunTimeCounter;
+    }
+    hzlPlatform_CpuStatsPreviousAmount = tasksAmount;
+    hzlPlatform_CpuStatsPreviousTotal = total;
+    hzlPlatform_CpuStats.tasksAmount = (uint32_t) tasksAmount;
+    hzlPlatform_CpuStats.snapshots++;
+}
+
+void
+hzlPlatform_CpuStatsInit(void)
+{
+    const TimerHandle_t timer = xTimerCreate(
+        "hzl_cpustats_timer",
+        HZL_PLATFORM_CPU_STATS_PERIOD_TICKS,
+        true, // Do autoreload, make it a periodic timer
+        NULL,
+        hzlPlatform_CpuStatsSnapshot);
+    if (timer == NULL)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CPUSTATS_CREATE);
+    }
+    if (xTimerStart(timer, 0U) != pdPASS)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CPUSTATS_START);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Periodic snapshot of the CPU share of each FreeRTOS task, from the FreeRTOS run-time
+ * statistics, to see how close a node is to saturation.
+ *
+ * The run-time counter is the microsecond clock (hzlPlatform_Clock.h) divided down to
+ * #HZL_PLATFORM_CPU_STATS_COUNTER_HZ, i.e. 100 times the tick rate, so tasks running for less
+ * than a tick are accounted for.
+ */
+
+#ifndef HZL_PLATFORM_CPUSTATS_H_
+#define HZL_PLATFORM_CPUSTATS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/** Frequency of the FreeRTOS run-time statistics counter. */
+#define HZL_PLATFORM_CPU_STATS_COUNTER_HZ 100000UL
+/** Maximum amount of tasks: if there are more, no snapshot is taken. */
+#ifndef HZL_PLATFORM_CPU_STATS_TASKS_MAX
+#define HZL_PLATFORM_CPU_STATS_TASKS_MAX 16U
+#endif
+/** Interval between two snapshots, over which the CPU share is computed. */
+#define HZL_PLATFORM_CPU_STATS_PERIOD_TICKS 1000U
+
+/** CPU usage of one task in the last snapshot interval. */
+typedef struct hzlPlatform_CpuStatsTask
+{
+    char name[configMAX_TASK_NAME_LEN];
+    /** Share of the CPU time in the interval, in 1/1000. The IDLE task's share is spare time. */
+    uint32_t sharePermille;
+    /** Smallest amount of free stack ever, in words. */
+    uint32_t stackHighWaterMarkWords;
+} hzlPlatform_CpuStatsTask_t;
+
+/** CPU share of all tasks, refreshed every #HZL_PLATFORM_CPU_STATS_PERIOD_TICKS. */
+typedef struct hzlPlatform_CpuStats
+{
+    /** Snapshots taken so far. */
+    uint32_t snapshots;
+    /** Amount of valid entries in hzlPlatform_CpuStats_t.tasks. */
+    uint32_t tasksAmount;
+    hzlPlatform_CpuStatsTask_t tasks[HZL_PLATFORM_CPU_STATS_TASKS_MAX];
+} hzlPlatform_CpuStats_t;
+
+/**
+ * The latest snapshot. Written by the FreeRTOS timer task, readable from the debugger.
+ */
+extern volatile hzlPlatform_CpuStats_t hzlPlatform_CpuStats;
+
+/**
+ * Starts the periodic snapshots in a FreeRTOS software timer.
+ */
+void
+hzlPlatform_CpuStatsInit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_CPUSTATS_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Pool of random bytes generated ahead of time by the CSEc, so the Hazelnet library obtains its
+ * randomness (handshake nonces, session keys) from RAM instead of waiting for the CSEc.
+ *
+ * The low-priority TaskEntropy keeps the pool full, one CSEc block at the time. A request that
+ * the pool cannot satisfy entirely (at startup or after a burst) falls back to the CSEc directly,
+ * so the randomness is never lower quality nor unavailable, only slower.
+ *
+ * The bytes are not expanded with a software DRBG: the CSEc RND command already is a
+ * CTR_DRBG, seeded from its TRNG by CSEC_DRV_InitRNG(), and its output is used as is.
+ */
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_SpscRing.h"
+#include "hzlPlatform_Telemetry.h"
+#include "semphr.h"
+
+#if (HZL_PLATFORM_ENTROPY_POOL_LEN & (HZL_PLATFORM_ENTROPY_POOL_LEN - 1U)) != 0U
+#error "The entropy pool length must be a power of 2."
+#endif
+
+/** @internal Amount of bytes the CSEc generates per RND command. */
+#define HZL_PLATFORM_ENTROPY_BLOCK_LEN 16U
+
+/**
+ * @internal
+ * The random bytes, in the ring of the pool.
+ * Producer: the TaskEntropy. Consumer: the TaskHzl of any bus, one at the time.
+ */
+static hzlPlatform_SpscRing_t hzlPlatform_EntropyPool;
+static uint8_t hzlPlatform_EntropyPoolItems[HZL_PLATFORM_ENTROPY_POOL_LEN];
+
+/**
+ * @internal
+ * Serialises the access to the CSEc, which is not reentrant, between the TaskEntropy and the
+ * direct fallback. A mutex, so the TaskHzl waiting for it raises the TaskEntropy's priority.
+ */
+static SemaphoreHandle_t hzlPlatform_EntropyCsecMutex = NULL;
+
+/**
+ * @internal
+ * Serialises the requests of the TaskHzl of the different buses, as the pool has a single
+ * consumer.
+ */
+static SemaphoreHandle_t hzlPlatform_EntropyConsumerMutex = NULL;
+
+static TaskHandle_t hzlPlatform_EntropyTaskHandle = NULL;
+
+/**
+ * @internal
+ * Generates one block of random bytes with the CSEc, waiting for any other user of it.
+ */
+static bool
+hzlPlatform_EntropyGenerateBlock(uint8_t block[HZL_PLATFORM_ENTROPY_BLOCK_LEN])
+{
+    (void) xSemaphoreTake(hzlPlatform_EntropyCsecMutex, portMAX_DELAY);
+    const status_t status = CSEC_DRV_GenerateRND(block);
+    (void) xSemaphoreGive(hzlPlatform_EntropyCsecMutex);
+    return status == STATUS_SUCCESS;
+}
+
+/**
+ * @internal
+ * Low-priority task refilling the pool. Sleeps while the pool is full, until bytes are taken.
+ */
+static void
+hzlPlatform_TaskEntropy(void* const unusedParam)
+{
+    (void) unusedParam;
+    uint8_t block[HZL_PLATFORM_ENTROPY_BLOCK_LEN];
+    while (true)
+    {
+        while (HZL_PLATFORM_ENTROPY_POOL_LEN - hzlPlatform_SpscRingAmount(&hzlPlatform_EntropyPool)
+               >= HZL_PLATFORM_ENTROPY_BLOCK_LEN)
+        {
+            if (!hzlPlatform_EntropyGenerateBlock(block))
+            {
+                // Try again later, the fallback reports the error if the CSEc keeps failing.
+                vTaskDelay(HZL_PLATFORM_ENTROPY_RETRY_TICKS);
+                continue;
+            }
+            for (size_t i = 0U; i < sizeof(block); i++)
+            {
+                // Cannot fail: there was space for the whole block.
+                (void) hzlPlatform_SpscRingPush(&hzlPlatform_EntropyPool, block[i]);
+            }
+        }
+        memset(block, 0, sizeof(block));
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void
+hzlPlatform_EntropyInit(void)
+{
+    hzlPlatform_SpscRingInit(&hzlPlatform_EntropyPool,
+        hzlPlatform_EntropyPoolItems,
+        HZL_PLATFORM_ENTROPY_POOL_LEN);
+    hzlPlatform_EntropyCsecMutex = xSemaphoreCreateMutex();
+    hzlPlatform_EntropyConsumerMutex = xSemaphoreCreateMutex();
+    if (hzlPlatform_EntropyCsecMutex == NULL || hzlPlatform_EntropyConsumerMutex == NULL)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_OUT_OF_MEMORY);
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlPlatform_TaskEntropy,
+        "TaskEntropy",
+        HZL_PLATFORM_TASK_STACK_WORDS_ENTROPY,
+        NULL,
+        HZL_PLATFORM_TASK_PRIORITY_ENTROPY,
+        &hzlPlatform_EntropyTaskHandle);
+    if (created != pdPASS)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_RTOS_TASK_CREATION);
+    }
+}
+
+/**
+ * @internal
+ * Serves one request of random bytes, see hzlPlatform_EntropyGet(), which makes it the only
+ * consumer of the pool for the time being.
+ */
+static bool
+hzlPlatform_EntropyGetAsOnlyConsumer(uint8_t* bytes, size_t amount)
+{
+    if (hzlPlatform_EntropyTaskHandle != NULL
+        && hzlPlatform_SpscRingAmount(&hzlPlatform_EntropyPool) >= amount)
+    {
+        // Only this request consumes the pool, so the bytes cannot disappear in the meantime.
+        // Wiped from the pool, as the local block below: they may become keys and nonces, and
+        // stay there until the TaskEntropy refills, i.e. forever if the CSEc keeps failing.
+        for (size_t i = 0U; i < amount; i++)
+        {
+            (void) hzlPlatform_SpscRingPopWiping(&hzlPlatform_EntropyPool, &bytes[i]);
+        }
+        hzlPlatform_Telemetry.entropyRequestsFromPool++;
+        xTaskNotifyGive(hzlPlatform_EntropyTaskHandle);
+        return true;
+    }
+    // The pool cannot satisfy the request: generate directly, one block at the time, passing
+    // part of the last block to reach any amount.
+    hzlPlatform_Telemetry.entropyRequestsDirect++;
+    uint8_t block[HZL_PLATFORM_ENTROPY_BLOCK_LEN];
+    bool isSuccess = true;
+    while (amount > 0U && isSuccess)
+    {
+        if (hzlPlatform_EntropyCsecMutex != NULL)
+        {
+            isSuccess = hzlPlatform_EntropyGenerateBlock(block);
+        }
+        else
+        {
+            // Pool not initialised: no other user of the CSEc.
+            isSuccess = CSEC_DRV_GenerateRND(block) == STATUS_SUCCESS;
+        }
+        if (!isSuccess)
+        {
+            break;
+        }
+        const size_t amountFromThisBlock = (amount < sizeof(block)) ? amount : sizeof(block);
+        memcpy(bytes, block, amountFromThisBlock);
+        bytes += amountFromThisBlock;
+        amount -= amountFromThisBlock;
+    }
+    memset(block, 0, sizeof(block));
+    return isSuccess;
+}
+
+bool
+hzlPlatform_EntropyGet(uint8_t* const bytes, const size_t amount)
+{
+    if (hzlPlatform_EntropyConsumerMutex == NULL)
+    {
+        // Pool not initialised: no other consumer of it.
+        return hzlPlatform_EntropyGetAsOnlyConsumer(bytes, amount);
+    }
+    (void) xSemaphoreTake(hzlPlatform_EntropyConsumerMutex, portMAX_DELAY);
+    const bool isSuccess = hzlPlatform_EntropyGetAsOnlyConsumer(bytes, amount);
+    (void) xSemaphoreGive(hzlPlatform_EntropyConsumerMutex);
+    return isSuccess;
+}
@@ -56,6 +56,8 @@ extern "C"
 #define HZL_PLATFORM_CRASH_TXTIMER_CREATE     HZL_PLATFORM_RGB_COLOR_MAGENTA, HZL_PLATFORM_RGB_COLOR_RED
 #define HZL_PLATFORM_CRASH_TXTIMER_START      HZL_PLATFORM_RGB_COLOR_MAGENTA, HZL_PLATFORM_RGB_COLOR_GREEN
 #define HZL_PLATFORM_CRASH_CANFD_DEINIT       HZL_PLATFORM_RGB_COLOR_MAGENTA, HZL_PLATFORM_RGB_COLOR_BLUE
+#define HZL_PLATFORM_CRASH_CPUSTATS_CREATE    HZL_PLATFORM_RGB_COLOR_MAGENTA, HZL_PLATFORM_RGB_COLOR_CYAN
+#define HZL_PLATFORM_CRASH_CPUSTATS_START     HZL_PLATFORM_RGB_COLOR_MAGENTA, HZL_PLATFORM_RGB_COLOR_YELLOW
 
 // IO critical failures operations
 #define HZL_PLATFORM_CRASH_CANFD_TX           HZL_PLATFORM_RGB_COLOR_YELLOW, HZL_PLATFORM_RGB_COLOR_RED
@@ -70,6 +72,9 @@ extern "C"
 #define HZL_PLATFORM_CRASH_HZL_BUILD_UAD      HZL_PLATFORM_RGB_COLOR_BLUE, HZL_PLATFORM_RGB_COLOR_WHITE
 #define HZL_PLATFORM_CRASH_HZL_BUILD_RENEWAL  HZL_PLATFORM_RGB_COLOR_BLUE, HZL_PLATFORM_RGB_COLOR_CYAN
 
+// Programming errors
+#define HZL_PLATFORM_CRASH_LOG_EVENT_INVALID  HZL_PLATFORM_RGB_COLOR_GREEN, HZL_PLATFORM_RGB_COLOR_RED
+
 /**
  * Reports an unrecoverable error with the RGB LED alternating flashes between 2 colors
  * looping forever. The first color stays active longer than the second. This function may
@@ -34,7 +34,13 @@
 
 #include <hzlPlatform_RgbLed.h>
 #include "hzlPlatform.h"
+#include "hzlPlatform_CanFilter.h"
+#include "hzlPlatform_CbsHeader.h"
+#include "hzlPlatform_Clock.h"
 #include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_LatencyHist.h"
+#include "hzlPlatform_SpscRing.h"
+#include "hzlPlatform_Telemetry.h"
 
 /**
  * @internal
@@ -44,6 +50,76 @@
  * 0 means all of them are.
  */
 #define HZL_PLATFORM_CANID_MASK_ALL_ACCEPTED 0U
+/**
+ * @internal
+ * Bitmask where all 29 bits of an extended CAN ID must match.
+ */
+#define HZL_PLATFORM_CANID_MASK_EXACT 0x1FFFFFFFU
+
+/**
+ * @internal
+ * Smallest divider of the FLEXCAN protocol clock leaving at most 40 time quanta per data-phase
+ * bit, the most the CAN FD bit timing segments can hold.
+ */
+#define HZL_PLATFORM_CANFD_DATA_PRESCALER \
+    ((HZL_PLATFORM_CANFD_PROTOCOL_CLOCK_HZ / HZL_PLATFORM_CANFD_DATA_BITRATE + 39UL) / 40UL)
+/**
+ * @internal
+ * Time quanta per data-phase bit.
+ */
+#define HZL_PLATFORM_CANFD_DATA_TQ_PER_BIT \
+    (HZL_PLATFORM_CANFD_PROTOCOL_CLOCK_HZ \
+     / (HZL_PLATFORM_CANFD_DATA_PRESCALER * HZL_PLATFORM_CANFD_DATA_BITRATE))
+/**
+ * @internal
+ * Time quanta of each of the two phase segments of a data-phase bit: 20% of the bit, at least 2,
+ * placing the sample point at about 80%. The synchronisation jump width is as long.
+ */
+#define HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ \
+    ((HZL_PLATFORM_CANFD_DATA_TQ_PER_BIT / 5UL) > 2UL \
+     ? (HZL_PLATFORM_CANFD_DATA_TQ_PER_BIT / 5UL) : 2UL)
+/**
+ * @internal
+ * Time quanta of the propagation segment of a data-phase bit: the rest of the bit after the
+ * synchronisation segment and the phase segments.
+ */
+#define HZL_PLATFORM_CANFD_DATA_PROP_SEG_TQ \
+    (HZL_PLATFORM_CANFD_DATA_TQ_PER_BIT - 1UL - 2UL * HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ)
+/**
+ * @internal
+ * Above 1 Mbit/s the transceiver loop delay exceeds the data-phase sample point, so the FLEXCAN
+ * checks the transmitted bits at a secondary sample point, this many protocol clock cycles after
+ * the measured delay: the position of the sample point within the bit.
+ */
+#define HZL_PLATFORM_CANFD_DATA_TDC_ENABLED (HZL_PLATFORM_CANFD_DATA_BITRATE > 1000000UL)
+#define HZL_PLATFORM_CANFD_DATA_TDC_OFFSET \
+    (HZL_PLATFORM_CANFD_DATA_PRESCALER \
+     * (1UL + HZL_PLATFORM_CANFD_DATA_PROP_SEG_TQ + HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ))
+
+#if HZL_PLATFORM_CANFD_DATA_BITRATE < HZL_PLATFORM_CANFD_NOMINAL_BITRATE \
+    || HZL_PLATFORM_CANFD_PROTOCOL_CLOCK_HZ \
+       % (HZL_PLATFORM_CANFD_DATA_PRESCALER * HZL_PLATFORM_CANFD_DATA_BITRATE) != 0UL \
+    || HZL_PLATFORM_CANFD_DATA_TQ_PER_BIT < 5UL
+#error "The data-phase bitrate must be at least the nominal one and divide the protocol clock."
+#endif
+#if HZL_PLATFORM_CANFD_DATA_TDC_ENABLED && HZL_PLATFORM_CANFD_DATA_TDC_OFFSET > 31UL
+#error "The data-phase sample point is too late for the transceiver delay compensation."
+#endif
+
+/**
+ * @internal
+ * Bit timing of the data phase of the CAN FD frames, as register values: the propagation
+ * segment counts the time quanta as they are, the others one less.
+ */
+static const flexcan_time_segment_t
+HZL_PLATFORM_CANFD_DATA_TIME_SEGMENTS =
+    {
+     .propSeg = HZL_PLATFORM_CANFD_DATA_PROP_SEG_TQ,
+     .phaseSeg1 = HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ - 1UL,
+     .phaseSeg2 = HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ - 1UL,
+     .preDivider = HZL_PLATFORM_CANFD_DATA_PRESCALER - 1UL,
+     .rJumpwidth = HZL_PLATFORM_CANFD_DATA_PHASE_SEG_TQ - 1UL,
+    };
 
 /**
  * @internal
@@ -56,50 +132,365 @@ HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG =
      .data_length = 0,  // To be CUSTOMISED before transmission
      .is_remote = false,  // CAN FD does not support Remote Transmission Requests
      .msg_id_type = FLEXCAN_MSG_ID_EXT,  // 29 bit CAN IDs
-     .enable_brs = false,  // Same bitrate of data and arbitration parts
+     .enable_brs = HZL_PLATFORM_CANFD_BRS,  // Data part at HZL_PLATFORM_CANFD_DATA_BITRATE
      .fd_enable = true,  // Use CAN FD for longer payloads
      .fd_padding = 0xAAU,  // This padding minimises the amount of stuff bits
     };
 
+#if (HZL_PLATFORM_CANFD_RX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT) \
+    > HZL_PLATFORM_CANFD_MAILBOX_AMOUNT_MAX
+#error "Too many RX mailboxes: they do not fit into the FLEXCAN RAM with 64 B payloads."
+#endif
+#if HZL_PLATFORM_CANFD_RX_MAILBOX_FIRST_INDEX \
+    < (HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_TX_MAILBOX_AMOUNT)
+#error "The RX mailboxes must come after the TX mailboxes."
+#endif
+#if (HZL_PLATFORM_CANFD_RX_RING_CAPACITY & (HZL_PLATFORM_CANFD_RX_RING_CAPACITY - 1U)) != 0U \
+    || HZL_PLATFORM_CANFD_RX_RING_CAPACITY < HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT \
+    || HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT > UINT8_MAX
+#error "The RX rings must have a power-of-2 capacity able to hold all the RX slots."
+#endif
+#if HZL_PLATFORM_CANFD_RX_CONTROL_RESERVED_SLOTS >= HZL_PLATFORM_CANFD_RX_QUEUE_LEN
+#error "The RX slots reserved to the control frames leave none for the application data."
+#endif
+
+#if !defined(HZL_PLATFORM_CANFD_RX_SELF)
+/**
+ * @internal
+ * Longest wait for the FLEXCAN to enter or leave the freeze mode, which it does only at the end
+ * of the frame on the bus.
+ */
+#define HZL_PLATFORM_FLEXCAN_FREEZE_TIMEOUT_MICROS 1000U
+#endif
+
+/**
+ * @internal
+ * Bitmask of the CODE field within the Control and Status word of a FLEXCAN mailbox.
+ */
+#define HZL_PLATFORM_FLEXCAN_CS_CODE_MASK 0x0F000000UL
+/**
+ * @internal
+ * Bit position of the CODE field within the Control and Status word of a FLEXCAN mailbox.
+ */
+#define HZL_PLATFORM_FLEXCAN_CS_CODE_SHIFT 24U
+/**
+ * @internal
+ * Value of the CODE field of a reception mailbox which was written again by the hardware
+ * before its previous content was read, overwriting (and losing) a frame.
+ */
+#define HZL_PLATFORM_FLEXCAN_CS_CODE_RX_OVERRUN 0x6UL
+
+#if HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT > HZL_PLATFORM_CANFD_TX_MAILBOX_AMOUNT \
+    || HZL_PLATFORM_CANFD_SMALL_RX_MAILBOX_AMOUNT > HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT \
+    || (HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT \
+        + HZL_PLATFORM_CANFD_SMALL_RX_MAILBOX_AMOUNT) > HZL_PLATFORM_CANFD_SMALL_MAILBOX_AMOUNT_MAX
+#error "Too many mailboxes on FLEXCAN1/2: they do not fit into their RAM with 64 B payloads."
+#endif
+
+/**
+ * @internal
+ * FLEXCAN instance of a bus, as generated by Processor Expert, and its mailbox layout.
+ */
+typedef struct hzlPlatform_FlexcanBusHw
+{
+    uint8_t instance;
+    flexcan_state_t* state;
+    const flexcan_user_config_t* config;
+    /** TX mailboxes, from #HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX. */
+    uint8_t txMailboxAmount;
+    /** RX mailboxes, right after the TX ones. */
+    uint8_t rxMailboxFirstIndex;
+    uint8_t rxMailboxAmount;
+} hzlPlatform_FlexcanBusHw_t;
+
+/**
+ * @internal
+ * The FLEXCAN instance of each bus. FLEXCAN1 and FLEXCAN2 (canCom2 and canCom3) must be added
+ * to the Processor Expert project to use more than one bus.
+ */
+static const hzlPlatform_FlexcanBusHw_t hzlPlatform_FlexcanBusHw[HZL_PLATFORM_BUSES_AMOUNT] =
+{
+    {
+        INST_CANCOM1, &canCom1_State, &canCom1_InitConfig0,
+        HZL_PLATFORM_CANFD_TX_MAILBOX_AMOUNT,
+        HZL_PLATFORM_CANFD_RX_MAILBOX_FIRST_INDEX, HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT,
+    },
+#if HZL_PLATFORM_BUSES_AMOUNT > 1U
+    {
+        INST_CANCOM2, &canCom2_State, &canCom2_InitConfig0,
+        HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT,
+        HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT,
+        HZL_PLATFORM_CANFD_SMALL_RX_MAILBOX_AMOUNT,
+    },
+#endif
+#if HZL_PLATFORM_BUSES_AMOUNT > 2U
+    {
+        INST_CANCOM3, &canCom3_State, &canCom3_InitConfig0,
+        HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT,
+        HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + HZL_PLATFORM_CANFD_SMALL_TX_MAILBOX_AMOUNT,
+        HZL_PLATFORM_CANFD_SMALL_RX_MAILBOX_AMOUNT,
+    },
+#endif
+};
+
+/**
+ * @internal
+ * A CAN FD message waiting in the TX queue.
+ */
+typedef struct hzlPlatform_TxFrame
+{
+    uint8_t dataLen;
+    uint8_t data[64];
+} hzlPlatform_TxFrame_t;
+
+/**
+ * @internal
+ * Reception and transmission state of one bus, sized for the largest mailbox layout.
+ */
+typedef struct hzlPlatform_FlexcanBus
+{
+    /**
+     * Preallocated locations where received CAN FD messages are written by
+     * FLEXCAN_DRV_Receive() prior to calling hzlPlatform_CallbackOnCanEvent(). The TaskHzl
+     * processes them in place, so each message is copied only once, from the mailbox to its slot.
+     */
+    flexcan_msgbuff_t rxSlots[HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT];
+    /** Time each slot was handed over to the TaskHzl, see hzlPlatform_FlexcanRxAcquiredMicros(). */
+    uint64_t rxSlotMicros[HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT];
+    /** Index of the slot each RX mailbox is currently receiving into. */
+    uint8_t rxSlotOfMailbox[HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT];
+    /**
+     * Indices of the slots holding received application data messages, oldest first.
+     * Producer: the FLEXCAN ISR. Consumer: the TaskHzl of the bus.
+     */
+    hzlPlatform_SpscRing_t rxReadySlots;
+    uint8_t rxReadySlotsItems[HZL_PLATFORM_CANFD_RX_RING_CAPACITY];
+    /**
+     * Indices of the slots holding received REQ, RES and REN messages, oldest first, consumed
+     * before rxReadySlots. Producer: the FLEXCAN ISR. Consumer: the TaskHzl of the bus.
+     */
+    hzlPlatform_SpscRing_t rxReadyControlSlots;
+    uint8_t rxReadyControlSlotsItems[HZL_PLATFORM_CANFD_RX_RING_CAPACITY];
+    /**
+     * Indices of the slots available for reception.
+     * Producer: the TaskHzl of the bus, releasing processed slots. Consumer: the FLEXCAN ISR.
+     */
+    hzlPlatform_SpscRing_t rxFreeSlots;
+    uint8_t rxFreeSlotsItems[HZL_PLATFORM_CANFD_RX_RING_CAPACITY];
+    /** Slot handed to the TaskHzl by hzlPlatform_FlexcanRxAcquire(), not yet released. */
+    uint8_t rxAcquiredSlot;
+    /**
+     * Task notified with #HZL_PLATFORM_TASK_EVENT_CANFD_RX of every message in rxReadySlots and
+     * rxReadyControlSlots, so it can sleep until one arrives.
+     */
+    TaskHandle_t taskToNotifyOnRx;
+    /**
+     * Messages waiting for a free TX mailbox, oldest first, as circular buffer.
+     * Accessed only within a critical section or from the FLEXCAN ISR.
+     */
+    hzlPlatform_TxFrame_t txQueue[HZL_PLATFORM_CANFD_TX_QUEUE_LEN];
+    uint32_t txQueueOldest;
+    uint32_t txQueueAmount;
+    /**
+     * Amount of TX mailboxes loaded since the pool was last completely idle. The next message
+     * is loaded into the mailbox with this offset from #HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX.
+     */
+    uint32_t txMailboxesLoaded;
+    /** Amount of TX mailboxes with a transmission in progress. */
+    uint32_t txMailboxesBusy;
+    /**
+     * Tick of the last transmission completion or of the start of a transmission by an idle
+     * mailbox pool, whichever is the latest. Used to detect a stalled bus.
+     */
+    TickType_t txLastProgressTick;
+} hzlPlatform_FlexcanBus_t;
+
+/**
+ * @internal
+ * State of each bus, written only by its own TaskHzl and FLEXCAN ISR, apart from the TX queue,
+ * which any task may fill.
+ */
+static hzlPlatform_FlexcanBus_t hzlPlatform_FlexcanBuses[HZL_PLATFORM_BUSES_AMOUNT];
+
 /**
  * @internal
- * Location where a just-received CAN FD message is written by FLEXCAN_DRV_Receive() prior to
- * calling hzlPlatform_CallbackOnCanEvent().
+ * Moves messages from the TX queue into the free TX mailboxes, as long as the transmission
+ * order is preserved.
+ *
+ * All messages of this node have the same CAN ID and among mailboxes with the same CAN ID the
+ * FLEXCAN arbitration transmits the lowest-index one first, regardless of when it was loaded.
+ * Thus a message is only loaded in a mailbox above all the busy ones, and the pool restarts from
+ * its first mailbox only once it's completely idle.
+ *
+ * Must be called within a critical section or from the FLEXCAN ISR.
  */
-static flexcan_msgbuff_t hzlPlatform_TempRxCanMsg;
+static void
+hzlPlatform_TxLoadMailboxes(const uint8_t bus)
+{
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    const hzlPlatform_FlexcanBusHw_t* const hw = &hzlPlatform_FlexcanBusHw[bus];
+    flexcan_data_info_t msgMetadata = HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG;
+    while (state->txQueueAmount > 0U && state->txMailboxesLoaded < hw->txMailboxAmount)
+    {
+        const hzlPlatform_TxFrame_t* const frame = &state->txQueue[state->txQueueOldest];
+        msgMetadata.data_length = frame->dataLen;
+        // The driver copies the payload into the mailbox RAM, so the queue entry can be reused.
+        const status_t status = FLEXCAN_DRV_Send(hw->instance,
+            (uint8_t) (HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + state->txMailboxesLoaded),
+            &msgMetadata,
+            HZL_PLATFORM_CANID_FROM_ME,
+            frame->data);
+        if (status != STATUS_SUCCESS)
+        {
+            // The mailbox was known to be idle, so this should never fail.
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_TX);
+        }
+        state->txMailboxesLoaded++;
+        state->txMailboxesBusy++;
+        state->txQueueOldest = (state->txQueueOldest + 1U) % HZL_PLATFORM_CANFD_TX_QUEUE_LEN;
+        state->txQueueAmount--;
+    }
+}
 
 /**
  * @internal
- * Places the just-received CAN frame into a queue (producer pattern) and starts a new reception.
+ * Frees the TX mailbox that just completed its transmission and refills the pool from the
+ * TX queue.
+ *
+ * Called from the FLEXCAN ISR: no critical section needed, as the tasks access the TX state
+ * only with the FLEXCAN interrupt masked.
  */
 inline static void
-hzlPlatform_EnqueueReceivedCanFrame(QueueHandle_t rxCanMsgsQueue)
+hzlPlatform_TxMailboxCompleted(const uint8_t bus)
 {
-    BaseType_t isThereATaskWaitingForQueue = pdFALSE;
-    // The FLEXCAN_DRV_Receive(), called by hzlPlatform_InitFlexcan() or by this
-    // callback, has placed the received message into hzlPlatform_TempRxCanMsg,
-    // and then this callback was called.
-    // Enqueue the temp message for the main application to dequeue when it has some time.
-    xQueueSendToBackFromISR(rxCanMsgsQueue,
-        &hzlPlatform_TempRxCanMsg,
-        &isThereATaskWaitingForQueue);
-    // Note: the error returned from  the queue is not handled. If the queue is full,
-    // simply the to-be-enqueued message is discarded.
-    // Start a new non-blocking reception, which will call hzlPlatform_CallbackOnCanEvent()
-    // again when something new is received.
-    const status_t status = FLEXCAN_DRV_Receive(INST_CANCOM1,
-    HZL_PLATFORM_CANFD_RX_MAILBOX_INDEX,
-        &hzlPlatform_TempRxCanMsg);
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    state->txMailboxesBusy--;
+    if (state->txMailboxesBusy == 0U)
+    {
+        state->txMailboxesLoaded = 0U;
+    }
+    hzlPlatform_Telemetry.buses[bus].txFramesSent++;
+    state->txLastProgressTick = xTaskGetTickCountFromISR();
+    hzlPlatform_TxLoadMailboxes(bus);
+}
+
+/**
+ * @internal
+ * Starts a new non-blocking reception on the given RX mailbox into the given slot, which will
+ * call hzlPlatform_CallbackOnCanEvent() again when something new is received.
+ */
+inline static void
+hzlPlatform_ArmRxMailbox(const uint8_t bus, const uint8_t mailboxIdx, const uint8_t slotIdx)
+{
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    const hzlPlatform_FlexcanBusHw_t* const hw = &hzlPlatform_FlexcanBusHw[bus];
+    state->rxSlotOfMailbox[mailboxIdx - hw->rxMailboxFirstIndex] = slotIdx;
+    const status_t status = FLEXCAN_DRV_Receive(hw->instance,
+        mailboxIdx,
+        &state->rxSlots[slotIdx]);
     if (status != STATUS_SUCCESS)
     {
         // This should never fail, hopefully.
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_RX);
     }
-    // xQueue tells us if there is a task waiting for something to be popped from
-    // a queue. With this information we can hint the scheduler with the yield operation
-    // to schedule the task waiting for the queue immediately after this callback
-    // instead of scheduling the task that was just interrupted.
-    portYIELD_FROM_ISR(isThereATaskWaitingForQueue);
+}
+
+/**
+ * @internal
+ * Lane of the received frame in the given slot: the ring of the control frames (REQ, RES, REN)
+ * or the one of the application data.
+ *
+ * @param [out] reservedSlots amount of free slots the frame may not take
+ */
+inline static hzlPlatform_SpscRing_t*
+hzlPlatform_RxLaneOfSlot(hzlPlatform_FlexcanBus_t* const state,
+                         const uint8_t slotIdx,
+                         uint32_t* const reservedSlots)
+{
+#if !defined(HZL_PLATFORM_CANFD_RX_SINGLE_LANE)
+    const flexcan_msgbuff_t* const frame = &state->rxSlots[slotIdx];
+    if (hzlPlatform_CbsIsControl(frame->data, frame->dataLen))
+    {
+        *reservedSlots = 0U;
+        return &state->rxReadyControlSlots;
+    }
+    *reservedSlots = HZL_PLATFORM_CANFD_RX_CONTROL_RESERVED_SLOTS;
+#else
+    (void) slotIdx;
+    *reservedSlots = 0U;
+#endif
+    return &state->rxReadySlots;
+}
+
+/**
+ * @internal
+ * Hands the CAN frame just received in the given mailbox over to the TaskHzl (producer pattern)
+ * into its lane and starts a new reception on the same mailbox into a free slot.
+ *
+ * The other RX mailboxes of the pool stay armed in the meantime, so frames arriving back-to-back
+ * land in one of them instead of being lost while this ISR runs.
+ */
+inline static void
+hzlPlatform_EnqueueReceivedCanFrame(const uint8_t bus, const uint8_t mailboxIdx)
+{
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    BaseType_t isThereATaskWaitingForFrames = pdFALSE;
+    const uint8_t rxSlotIdx =
+        state->rxSlotOfMailbox[mailboxIdx - hzlPlatform_FlexcanBusHw[bus].rxMailboxFirstIndex];
+    // The hardware marks the mailbox as overrun when a second frame was written into it
+    // before the first one was read out: one frame got lost.
+    if (((state->rxSlots[rxSlotIdx].cs & HZL_PLATFORM_FLEXCAN_CS_CODE_MASK)
+         >> HZL_PLATFORM_FLEXCAN_CS_CODE_SHIFT) == HZL_PLATFORM_FLEXCAN_CS_CODE_RX_OVERRUN)
+    {
+        telemetry->rxFramesLostInHw++;
+    }
+    // The FLEXCAN_DRV_Receive(), called by hzlPlatform_InitFlexcan() or by this
+    // callback, has placed the received message into the slot, and then this callback was called.
+    uint32_t reservedSlots;
+    hzlPlatform_SpscRing_t* const lane = hzlPlatform_RxLaneOfSlot(state, rxSlotIdx, &reservedSlots);
+    const bool isControl = (lane == &state->rxReadyControlSlots);
+    uint8_t nextSlotIdx;
+    if (hzlPlatform_SpscRingAmount(&state->rxFreeSlots) > reservedSlots
+        && hzlPlatform_SpscRingPop(&state->rxFreeSlots, &nextSlotIdx))
+    {
+        // Publish the slot for the main application to process when it has some time.
+        state->rxSlotMicros[rxSlotIdx] = hzlPlatform_ClockMicros();
+        // Cannot fail: the ring can hold all the slots.
+        (void) hzlPlatform_SpscRingPush(lane, rxSlotIdx);
+        telemetry->rxFramesEnqueued++;
+        if (isControl)
+        {
+            telemetry->rxControlFramesEnqueued++;
+        }
+        const uint32_t waitingFrames = hzlPlatform_SpscRingAmount(&state->rxReadySlots)
+                                       + hzlPlatform_SpscRingAmount(&state->rxReadyControlSlots);
+        if (waitingFrames > telemetry->rxQueueHighWaterMark)
+        {
+            telemetry->rxQueueHighWaterMark = waitingFrames;
+        }
+        hzlPlatform_TelemetryEventRaised(bus, HZL_PLATFORM_TASK_EVENT_CANFD_RX);
+        xTaskNotifyFromISR(state->taskToNotifyOnRx,
+            HZL_PLATFORM_TASK_EVENT_CANFD_RX,
+            eSetBits,  // The task's notification value is bitwise ORed with ulValue.
+            &isThereATaskWaitingForFrames);
+    }
+    else
+    {
+        // All slots (the data frames: all but the reserved ones) are waiting for the TaskHzl:
+        // the just-received message is discarded by receiving the next one into the same slot.
+        telemetry->rxFramesDroppedQueueFull++;
+        if (isControl)
+        {
+            telemetry->rxControlFramesDropped++;
+        }
+        nextSlotIdx = rxSlotIdx;
+    }
+    hzlPlatform_ArmRxMailbox(bus, mailboxIdx, nextSlotIdx);
+    // The notification tells us if there is a task waiting for it. With this information we can hint
+    // the scheduler with the yield operation to schedule the task waiting for the frames
+    // immediately after this callback instead of scheduling the task that was just interrupted.
+    portYIELD_FROM_ISR(isThereATaskWaitingForFrames);
 }
 
 /**
@@ -107,13 +498,14 @@ hzlPlatform_EnqueueReceivedCanFrame(QueueHandle_t rxCanMsgsQueue)
  * Function called by the FLEXCAN driver upon successful transmission, reception or
  * other events of the CAN driver.
  *
- * Upon reception it copies the received CAN FD message into the RX queue passed to it.
+ * Upon reception it hands the received CAN FD message over to the TaskHzl.
+ * Upon transmission completion it loads the next queued message, if any.
  * Upon any other event it simply does nothing.
  *
  * @param [in] instance unused
  * @param [in] eventType shows what triggered the call of this function
- * @param [in] buffIdx unused
- * @param [in] flexcanState used to obtain the queue handle from its callbackParam field.
+ * @param [in] buffIdx index of the mailbox that triggered the event
+ * @param [in] flexcanState holds the index of the bus as callback parameter
  */
 static void
 hzlPlatform_CallbackOnCanEvent(const uint8_t instance,
@@ -122,15 +514,26 @@ hzlPlatform_CallbackOnCanEvent(const uint8_t instance,
                                     flexcan_state_t* const flexcanState)
 {
     (void) instance;
-    (void) buffIdx;
-    // Obtain the queue where this callback will put the messages from the callback-installation
-    // FLEXCAN_DRV_InstallEventCallback() call.
-    QueueHandle_t rxCanMsgsQueue = flexcanState->callbackParam;
+    const uint8_t bus = (uint8_t) (uintptr_t) flexcanState->callbackParam;
+    const hzlPlatform_FlexcanBusHw_t* const hw = &hzlPlatform_FlexcanBusHw[bus];
     switch (eventType)
     {
         case FLEXCAN_EVENT_RX_COMPLETE:
             {
-            hzlPlatform_EnqueueReceivedCanFrame(rxCanMsgsQueue);
+            if (buffIdx >= hw->rxMailboxFirstIndex
+                && buffIdx < (uint32_t) hw->rxMailboxFirstIndex + hw->rxMailboxAmount)
+            {
+                hzlPlatform_EnqueueReceivedCanFrame(bus, (uint8_t) buffIdx);
+            }
+            break;
+        }
+        case FLEXCAN_EVENT_TX_COMPLETE:
+            {
+            // Unsigned wrap-around: also false for indices below the first TX mailbox.
+            if ((buffIdx - HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX) < hw->txMailboxAmount)
+            {
+                hzlPlatform_TxMailboxCompleted(bus);
+            }
             break;
         }
         default:
@@ -143,90 +546,370 @@ hzlPlatform_CallbackOnCanEvent(const uint8_t instance,
 
 /**
  * @internal
- * Configures the CAN FD I/O with 2 mailboxes (one for TX, one for RX) and sets the RX queue for
- * CAN frames.
+ * CAN ID the node with the given SID transmits with, see #hzlPlatform_CanId_t.
+ */
+static uint32_t
+hzlPlatform_CanIdOfSid(const uint8_t sid)
+{
+    return (sid == HZL_PLATFORM_CANFILTER_SID_SERVER)
+           ? (uint32_t) HZL_PLATFORM_CANID_FROM_SERVER
+           : (uint32_t) HZL_PLATFORM_CANID_FROM_ALICE - 1U + sid;
+}
+
+/**
+ * @internal
+ * Acceptance filter matching the CAN IDs of all the given SIDs: the CAN ID of any of them,
+ * masked to the bits they all have in common.
+ *
+ * @returns the bits their CAN IDs do NOT all have in common.
+ */
+static uint32_t
+hzlPlatform_CanFilterOfPeers(const uint64_t peers, uint32_t* const canId, uint32_t* const mask)
+{
+    bool isFirst = true;
+    uint32_t firstCanId = 0U;
+    uint32_t differentBits = 0U;
+    for (uint8_t peer = 0U; peer < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT; peer++)
+    {
+        if ((peers & (1ULL << peer)) == 0U)
+        {
+            continue;
+        }
+        if (isFirst)
+        {
+            firstCanId = hzlPlatform_CanIdOfSid(peer);
+            isFirst = false;
+        }
+        differentBits |= hzlPlatform_CanIdOfSid(peer) ^ firstCanId;
+    }
+    *mask = HZL_PLATFORM_CANID_MASK_EXACT & ~differentBits;
+    *canId = firstCanId & *mask;
+    return differentBits;
+}
+
+/**
+ * @internal
+ * Whether the acceptance filter of the given SIDs lets the frames of the node with the given
+ * SID through as well.
+ */
+static bool
+hzlPlatform_CanFilterMatchesSid(const uint64_t peers, const uint8_t sid)
+{
+    uint32_t canId;
+    uint32_t mask;
+    (void) hzlPlatform_CanFilterOfPeers(peers, &canId, &mask);
+    return (hzlPlatform_CanIdOfSid(sid) & mask) == canId;
+}
+
+/**
+ * @internal
+ * Splits off the SIDs whose CAN ID has the highest bit set that the CAN IDs of the given SIDs
+ * do not all have in common, so the filters of both parts mask fewer bits.
+ * There must be at least 2 SIDs.
+ *
+ * @returns the SIDs split off, the others remain.
+ */
+static uint64_t
+hzlPlatform_CanFilterSplit(const uint64_t peers)
+{
+    uint32_t canId;
+    uint32_t mask;
+    uint32_t highestBit = hzlPlatform_CanFilterOfPeers(peers, &canId, &mask);
+    while ((highestBit & (highestBit - 1U)) != 0U)
+    {
+        highestBit &= highestBit - 1U;
+    }
+    uint64_t splitOff = 0U;
+    for (uint8_t peer = 0U; peer < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT; peer++)
+    {
+        if ((peers & (1ULL << peer)) != 0U && (hzlPlatform_CanIdOfSid(peer) & highestBit) != 0U)
+        {
+            splitOff |= 1ULL << peer;
+        }
+    }
+    return splitOff;
+}
+
+/**
+ * @internal
+ * Groups the peers of the node with the given SID by RX mailbox filter, at most one group per
+ * RX mailbox: each group is the bitmap of the SIDs sharing the filter of
+ * hzlPlatform_CanFilterOfPeers(). A FLEXCAN mailbox has a single identifier/individual mask
+ * pair and with CAN FD frames there is no RX FIFO with its filter table.
+ *
+ * With no more peers than RX mailboxes, each peer is a group of its own, so each filter is
+ * exact. Otherwise all peers start in one group, whose filter masks the bits their CAN IDs do
+ * not have in common and so may match the CAN ID of the node itself (e.g. the mask of the
+ * Server over the CAN IDs 0x70A-0x729 of 32 Clients matches its own 0x700): such a group is
+ * split on the highest of those bits until no filter matches the own CAN ID, as long as RX
+ * mailboxes are left for the parts. Any left matching it is harmless, as the self reception
+ * is disabled, see hzlPlatform_FlexcanDisableSelfReception().
+ *
+ * @returns the amount of groups, 0 to accept all CAN IDs: for unknown SIDs and with
+ * #HZL_PLATFORM_CANFD_RX_ACCEPT_ALL.
+ */
+static uint8_t
+hzlPlatform_CanFilterGroupsOfSid(const uint8_t sid,
+                                 const uint8_t rxMailboxAmount,
+                                 uint64_t groups[])
+{
+#if !defined(HZL_PLATFORM_CANFD_RX_ACCEPT_ALL)
+    const uint64_t peers = hzlPlatform_CanFilterPeers(sid)
+                           & ~((sid < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT) ? 1ULL << sid : 0U);
+#else
+    const uint64_t peers = 0U;
+#endif
+    uint8_t groupsAmount = 0U;
+    for (uint8_t peer = 0U; peer < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT; peer++)
+    {
+        if ((peers & (1ULL << peer)) == 0U)
+        {
+            continue;
+        }
+        if (groupsAmount == rxMailboxAmount)
+        {
+            groupsAmount = 0U;  // Too many peers for a mailbox each.
+            break;
+        }
+        groups[groupsAmount++] = 1ULL << peer;
+    }
+    if (groupsAmount == 0U && peers != 0U)
+    {
+        groups[groupsAmount++] = peers;
+        uint8_t groupIdx = 0U;
+        while (groupIdx < groupsAmount && groupsAmount < rxMailboxAmount)
+        {
+            if (hzlPlatform_CanFilterMatchesSid(groups[groupIdx], sid))
+            {
+                // Only 2 SIDs or more can match the own CAN ID, so neither part is empty.
+                const uint64_t splitOff = hzlPlatform_CanFilterSplit(groups[groupIdx]);
+                groups[groupIdx] &= ~splitOff;
+                groups[groupsAmount++] = splitOff;
+            }
+            else
+            {
+                groupIdx++;
+            }
+        }
+    }
+    return groupsAmount;
+}
+
+#if !defined(HZL_PLATFORM_CANFD_RX_SELF)
+/**
+ * @internal
+ * Waits for the FLEXCAN to acknowledge entering (MCR[FRZACK] set) or leaving the freeze mode.
+ */
+static void
+hzlPlatform_FlexcanAwaitFreezeAck(const CAN_Type* const base, const bool isFrozen)
+{
+    const uint64_t deadlineMicros = hzlPlatform_ClockMicros()
+                                    + HZL_PLATFORM_FLEXCAN_FREEZE_TIMEOUT_MICROS;
+    while (((base->MCR & CAN_MCR_FRZACK_MASK) != 0U) != isFrozen)
+    {
+        if (hzlPlatform_ClockMicros() > deadlineMicros)
+        {
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        }
+    }
+}
+
+/**
+ * @internal
+ * Disables the self reception of the FLEXCAN instance (MCR[SRXDIS]), which is enabled after
+ * every FLEXCAN_DRV_Init(): otherwise each frame the node transmits is received back by it
+ * whenever an RX mailbox filter matches its CAN ID, costing an RX interrupt, an RX slot and a
+ * prefilter pass. The S32 SDK driver has no call for it, so the register is written directly,
+ * in freeze mode as the FLEXCAN requires.
+ */
+static void
+hzlPlatform_FlexcanDisableSelfReception(const uint8_t instance)
+{
+    static CAN_Type* const bases[] = CAN_BASE_PTRS;
+    CAN_Type* const base = bases[instance];
+    base->MCR |= CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK;
+    hzlPlatform_FlexcanAwaitFreezeAck(base, true);
+    base->MCR |= CAN_MCR_SRXDIS_MASK;
+    base->MCR &= ~(CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK);
+    hzlPlatform_FlexcanAwaitFreezeAck(base, false);
+}
+#endif
+
+/**
+ * @internal
+ * Configures the CAN FD I/O of a bus with a pool of TX mailboxes and a pool of RX mailboxes and
+ * prepares the slots the frames are received into.
  * Must be called WITHIN a task as it uses some FreeRTOS functionalities to operate the FLEXCAN
  * driver.
  */
-QueueHandle_t hzlPlatform_FlexcanInit(void)  // TODO rename to FlexcanInit or CanInit
+void
+hzlPlatform_FlexcanInit(const uint8_t bus, const uint8_t ownSid, TaskHandle_t taskToNotify)
 {
-    // Initialise and prepare 2 mailboxes: 1 for transmission, 1 for reception
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    const hzlPlatform_FlexcanBusHw_t* const hw = &hzlPlatform_FlexcanBusHw[bus];
+    state->taskToNotifyOnRx = taskToNotify;
+    // Initialise and prepare the mailboxes: a pool for transmission, a pool for reception
     status_t status;
-    status = FLEXCAN_DRV_Init(INST_CANCOM1, &canCom1_State, &canCom1_InitConfig0);
+    status = FLEXCAN_DRV_Init(hw->instance, hw->state, hw->config);
     if (status != STATUS_SUCCESS)
     {
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
     }
+    // Data-phase bitrate of the frames transmitted with BRS, replacing the Processor Expert one.
+    FLEXCAN_DRV_SetBitrateCbt(hw->instance, &HZL_PLATFORM_CANFD_DATA_TIME_SEGMENTS);
+    FLEXCAN_DRV_SetTDCOffset(hw->instance,
+        HZL_PLATFORM_CANFD_DATA_TDC_ENABLED,
+        (uint8_t) HZL_PLATFORM_CANFD_DATA_TDC_OFFSET);
     // Apply CAN ID masking (filtering) rules. Individual == setting per-mailbox rather than global.
-    FLEXCAN_DRV_SetRxMaskType(INST_CANCOM1, FLEXCAN_RX_MASK_INDIVIDUAL);
-    // TX mailbox
+    FLEXCAN_DRV_SetRxMaskType(hw->instance, FLEXCAN_RX_MASK_INDIVIDUAL);
+#if !defined(HZL_PLATFORM_CANFD_RX_SELF)
+    hzlPlatform_FlexcanDisableSelfReception(hw->instance);
+#endif
+    // TX mailboxes
     const uint8_t defaultCanId = 0;
-    status = FLEXCAN_DRV_ConfigTxMb(INST_CANCOM1,
-    HZL_PLATFORM_CANFD_TX_MAILBOX_INDEX,
-        &HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG,
-        defaultCanId);
-    if (status != STATUS_SUCCESS)
+    for (uint8_t mailboxIdx = HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX;
+         mailboxIdx < HZL_PLATFORM_CANFD_TX_MAILBOX_FIRST_INDEX + hw->txMailboxAmount;
+         mailboxIdx++)
     {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        status = FLEXCAN_DRV_ConfigTxMb(hw->instance,
+            mailboxIdx,
+            &HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG,
+            defaultCanId);
+        if (status != STATUS_SUCCESS)
+        {
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        }
+        status = FLEXCAN_DRV_SetRxIndividualMask(hw->instance,
+            FLEXCAN_MSG_ID_EXT,
+            mailboxIdx,
+            HZL_PLATFORM_CANID_MASK_ALL_ACCEPTED);
+        if (status != STATUS_SUCCESS)
+        {
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        }
     }
-    status = FLEXCAN_DRV_SetRxIndividualMask(INST_CANCOM1,
-        FLEXCAN_MSG_ID_EXT,
-        HZL_PLATFORM_CANFD_TX_MAILBOX_INDEX,
-        HZL_PLATFORM_CANID_MASK_ALL_ACCEPTED);
-    if (status != STATUS_SUCCESS)
+    state->txQueueOldest = 0U;
+    state->txQueueAmount = 0U;
+    state->txMailboxesLoaded = 0U;
+    state->txMailboxesBusy = 0U;
+    // RX mailboxes, accepting the CAN IDs of the peers of this node, in groups with a mailbox
+    // filter each, see hzlPlatform_CanFilterGroupsOfSid(). The mailboxes are dealt out to the
+    // groups in turn. On a match the FLEXCAN hardware picks the lowest-index free one, so the
+    // frames of a group are spread over the mailboxes of the group.
+    uint64_t rxGroups[HZL_PLATFORM_CANFD_RX_MAILBOX_AMOUNT];
+    const uint8_t rxGroupsAmount = hzlPlatform_CanFilterGroupsOfSid(ownSid,
+        hw->rxMailboxAmount,
+        rxGroups);
+    for (uint8_t poolIdx = 0U; poolIdx < hw->rxMailboxAmount; poolIdx++)
     {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        const uint8_t mailboxIdx = (uint8_t) (hw->rxMailboxFirstIndex + poolIdx);
+        uint32_t rxCanId = 0U;
+        uint32_t rxMask = HZL_PLATFORM_CANID_MASK_ALL_ACCEPTED;
+        if (rxGroupsAmount != 0U)
+        {
+            (void) hzlPlatform_CanFilterOfPeers(rxGroups[poolIdx % rxGroupsAmount],
+                &rxCanId,
+                &rxMask);
+        }
+        status = FLEXCAN_DRV_ConfigRxMb(
+            hw->instance,
+            mailboxIdx,
+            &HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG,
+            rxCanId);
+        if (status != STATUS_SUCCESS)
+        {
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        }
+        status = FLEXCAN_DRV_SetRxIndividualMask(hw->instance,
+            FLEXCAN_MSG_ID_EXT,
+            mailboxIdx,
+            rxMask);
+        if (status != STATUS_SUCCESS)
+        {
+            hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        }
     }
-    // RX mailbox
-    status = FLEXCAN_DRV_ConfigRxMb(
-    INST_CANCOM1,
-    HZL_PLATFORM_CANFD_RX_MAILBOX_INDEX,
-        &HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG,
-        defaultCanId);
-    if (status != STATUS_SUCCESS)
+    // Prepare the RX slots where the received, but unprocessed messages, accumulate
+    // waiting for another task to process them. Initially all are free.
+    hzlPlatform_SpscRingInit(&state->rxReadySlots,
+        state->rxReadySlotsItems,
+        HZL_PLATFORM_CANFD_RX_RING_CAPACITY);
+    hzlPlatform_SpscRingInit(&state->rxReadyControlSlots,
+        state->rxReadyControlSlotsItems,
+        HZL_PLATFORM_CANFD_RX_RING_CAPACITY);
+    hzlPlatform_SpscRingInit(&state->rxFreeSlots,
+        state->rxFreeSlotsItems,
+        HZL_PLATFORM_CANFD_RX_RING_CAPACITY);
+    for (uint8_t slotIdx = hw->rxMailboxAmount;
+         slotIdx < HZL_PLATFORM_CANFD_RX_QUEUE_LEN + hw->rxMailboxAmount;
+         slotIdx++)
     {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        (void) hzlPlatform_SpscRingPush(&state->rxFreeSlots, slotIdx);
     }
-    status = FLEXCAN_DRV_SetRxIndividualMask(INST_CANCOM1,
-        FLEXCAN_MSG_ID_EXT,
-        HZL_PLATFORM_CANFD_RX_MAILBOX_INDEX,
-        HZL_PLATFORM_CANID_MASK_ALL_ACCEPTED);
+    // The callback finds the state of the bus from its parameter.
+    FLEXCAN_DRV_InstallEventCallback(hw->instance,
+        hzlPlatform_CallbackOnCanEvent,
+        (void*) (uintptr_t) bus);
     if (status != STATUS_SUCCESS)
     {
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
     }
-    // Prepare the RX queue where the received, but unprocessed messages, accumulate
-    // waiting for another task to pop and process them.
-    const QueueHandle_t rxCanMsgsQueue = xQueueCreate(
-        HZL_PLATFORM_CANFD_RX_QUEUE_LEN,
-        sizeof(flexcan_msgbuff_t));
-    if (rxCanMsgsQueue == NULL)
-    {
-        // malloc fails to a hook internally within xQueueCreate, so this branch should never occur.
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_OUT_OF_MEMORY);
-    }
-    FLEXCAN_DRV_InstallEventCallback(INST_CANCOM1,
-        hzlPlatform_CallbackOnCanEvent,
-        rxCanMsgsQueue);
-    if (status != STATUS_SUCCESS)
+    // Start the non-blocking receptions, which will call the callback when something is received.
+    // The first slots go to the mailboxes directly.
+    hzlPlatform_Telemetry.buses[bus] = (hzlPlatform_TelemetryBus_t) {0};
+    for (uint8_t slotIdx = 0U; slotIdx < hw->rxMailboxAmount; slotIdx++)
     {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_INIT);
+        hzlPlatform_ArmRxMailbox(bus, (uint8_t) (hw->rxMailboxFirstIndex + slotIdx), slotIdx);
     }
-    // Start the non-blocking reception, which will call the callback when something is received.
-    status = FLEXCAN_DRV_Receive(INST_CANCOM1,
-    HZL_PLATFORM_CANFD_RX_MAILBOX_INDEX,
-        &hzlPlatform_TempRxCanMsg);
-    if (status != STATUS_SUCCESS)
+}
+
+const flexcan_msgbuff_t*
+hzlPlatform_FlexcanRxAcquire(const uint8_t bus)
+{
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    // Control frames first: a RES must not wait behind a burst of data.
+    if (!hzlPlatform_SpscRingPop(&state->rxReadyControlSlots, &state->rxAcquiredSlot)
+        && !hzlPlatform_SpscRingPop(&state->rxReadySlots, &state->rxAcquiredSlot))
     {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_RX);
+        return NULL;
     }
-    return rxCanMsgsQueue;
+    return &state->rxSlots[state->rxAcquiredSlot];
+}
+
+void
+hzlPlatform_FlexcanRxRelease(const uint8_t bus)
+{
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    // Cannot fail: the ring can hold all the slots.
+    (void) hzlPlatform_SpscRingPush(&state->rxFreeSlots, state->rxAcquiredSlot);
+}
+
+uint64_t
+hzlPlatform_FlexcanRxAcquiredMicros(const uint8_t bus)
+{
+    const hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    return state->rxSlotMicros[state->rxAcquiredSlot];
+}
+
+uint32_t
+hzlPlatform_FlexcanRxLostFramesInHw(const uint8_t bus)
+{
+    return hzlPlatform_Telemetry.buses[bus].rxFramesLostInHw;
 }
 
 void
-hzlPlatform_FlexcanDeinit(void)
+hzlPlatform_FlexcanDeinit(const uint8_t bus)
 {
-    const status_t status = FLEXCAN_DRV_Deinit(INST_CANCOM1);
+    const hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    // Let the queued frames (e.g. the last log messages) reach the bus, unless it's stalled.
+    for (TickType_t waited = 0U;
+         (state->txQueueAmount > 0U || state->txMailboxesBusy > 0U)
+         && waited < HZL_PLATFORM_CANFD_TX_STALL_TIMEOUT_TICKS;
+         waited++)
+    {
+        vTaskDelay(1U);
+    }
+    const status_t status = FLEXCAN_DRV_Deinit(hzlPlatform_FlexcanBusHw[bus].instance);
     if (status != STATUS_SUCCESS)
     {
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_DEINIT);
@@ -234,47 +917,49 @@ hzlPlatform_FlexcanDeinit(void)
 }
 
 void
-hzlPlatform_FlexcanTransmit(const uint8_t* payload, const size_t payloadLen)
+hzlPlatform_FlexcanTransmit(const uint8_t bus, const uint8_t* const payload,
+                            const size_t payloadLen)
 {
-    // Copy the entier config struct by VALUE in order to change just the payload length field.
-    flexcan_data_info_t msgMetadata = HZL_PLATFORM_CANFD_MAILBOX_DEFAULT_CONFIG;
-    msgMetadata.data_length = payloadLen;
-    status_t txStatus;
-    uint32_t tries = 0;
-    while (tries < HZL_PLATFORM_CANFD_TX_TRIES)
-    {
-        txStatus = FLEXCAN_DRV_SendBlocking(
-        INST_CANCOM1,
-        HZL_PLATFORM_CANFD_TX_MAILBOX_INDEX,
-            &msgMetadata,
-            HZL_PLATFORM_CANID_FROM_ME,
-            payload,
-            HZL_PLATFORM_CANFD_TX_TIMEOUT_TICKS
-            );
-        tries++;
-        if (txStatus == STATUS_SUCCESS)
-        {
-            return;
-        }
-        else if (txStatus == STATUS_BUSY)
-        {
-            // Wait just a tick (1 ms) and try transmitting again. Maybe the peripheral is not
-            // busy anymore in the meantime.
-            // NOTE: this is definitely NOT a nice solution, but for this demo platform it works
-            // fine, as here the goal is communication, not performance.
-            vTaskDelay(1);
-            continue;
-        }
-        else if (txStatus == STATUS_TIMEOUT)
-        {
-            continue;  // Try again
-        }
-        else
+    HZL_PLATFORM_LATENCY_HIST_START(startCycles);
+    hzlPlatform_FlexcanBus_t* const state = &hzlPlatform_FlexcanBuses[bus];
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    if (payloadLen > sizeof(state->txQueue[0].data))
+    {
+        // Programming error: the Hazelnet library never builds longer messages.
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_TX);
+    }
+    taskENTER_CRITICAL();
+    const TickType_t now = xTaskGetTickCount();
+    if (state->txQueueAmount >= HZL_PLATFORM_CANFD_TX_QUEUE_LEN)
+    {
+        // No space for the message: it's discarded.
+        telemetry->txFramesDroppedQueueFull++;
+        const bool isStalled =
+            (now - state->txLastProgressTick) > HZL_PLATFORM_CANFD_TX_STALL_TIMEOUT_TICKS;
+        taskEXIT_CRITICAL();
+        if (isStalled)
         {
-            // An error that "should not happen" occurred.
+            // Nothing could be transmitted for a while: enter the unrecoverable error state.
             hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_TX);
         }
+        return;
+    }
+    hzlPlatform_TxFrame_t* const frame = &state->txQueue[
+        (state->txQueueOldest + state->txQueueAmount) % HZL_PLATFORM_CANFD_TX_QUEUE_LEN];
+    memcpy(frame->data, payload, payloadLen);
+    frame->dataLen = (uint8_t) payloadLen;
+    state->txQueueAmount++;
+    telemetry->txFramesEnqueued++;
+    if (state->txQueueAmount > telemetry->txQueueHighWaterMark)
+    {
+        telemetry->txQueueHighWaterMark = state->txQueueAmount;
+    }
+    if (state->txMailboxesBusy == 0U)
+    {
+        // Idle mailboxes: the stall timeout starts from this transmission.
+        state->txLastProgressTick = now;
     }
-    // Tried a few times, still cannot transmit. Enter the unrecoverable error state.
-    hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CANFD_TX);
+    hzlPlatform_TxLoadMailboxes(bus);
+    taskEXIT_CRITICAL();
+    HZL_PLATFORM_LATENCY_HIST_STOP(HZL_PLATFORM_LATENCY_HIST_OP_FLEXCAN_TRANSMIT, startCycles);
 }
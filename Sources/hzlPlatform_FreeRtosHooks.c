@@ -36,6 +36,8 @@
  */
 
 #include "hzlPlatform.h"
+#include "hzlPlatform_Clock.h"
+#include "hzlPlatform_CpuStats.h"
 #include "hzlPlatform_FatalError.h"
 
 /**
@@ -121,10 +123,8 @@ vApplicationIdleHook(void)
 
 /**
  * @internal
- * The FreeRTOSConfig.h is a shared configuration across many example project,
- * some of them (but not this one) have a run time stats gathering function.
- * To keep the linker happy, this is a dummy stats function, just like
- * ulMainGetRunTimeCounterValue();
+ * Configures the counter of the FreeRTOS run-time statistics: nothing to do, as it's derived
+ * from the microsecond clock, which runs on the SysTick started by the scheduler.
  */
 void
 vMainConfigureTimerForRunTimeStats(void)
@@ -133,21 +133,21 @@ vMainConfigureTimerForRunTimeStats(void)
 
 /**
  * @internal
- * The FreeRTOSConfig.h is a shared configuration across many example project,
- * some of them (but not this one) have a run time stats gathering function.
- * To keep the linker happy, this is a dummy stats function, just like
- * vMainConfigureTimerForRunTimeStats().
+ * Counter of the FreeRTOS run-time statistics, at #HZL_PLATFORM_CPU_STATS_COUNTER_HZ.
  */
 unsigned long
 ulMainGetRunTimeCounterValue(void)
 {
-    return 0;
+    return (unsigned long) (hzlPlatform_ClockMicros()
+                            / (1000000UL / HZL_PLATFORM_CPU_STATS_COUNTER_HZ));
 }
 
 /**
  * @internal
+ * Called by the tick interrupt: advances the microsecond clock.
  */
 void
 vApplicationTickHook(void)
 {
+    hzlPlatform_ClockOnTick();
 }
@@ -187,7 +187,9 @@ hzlPlatform_InitFreeRtosInterrupts(void)
 static void
 hzlPlatform_InitFreeRtosTasks(void)
 {
-    const configSTACK_DEPTH_TYPE stackSize = 500U; // In WORDS, not bytes
+    // In WORDS, not bytes. Only the TaskHzl of the main bus is created here, it creates the
+    // ones of the other buses with the same stack size.
+    const configSTACK_DEPTH_TYPE stackSize = HZL_PLATFORM_TASK_STACK_WORDS_HZL;
     BaseType_t created;
     // Not using the handle here, but it may be passed to other tasks so they can reference each
     // other and send signals to each other.
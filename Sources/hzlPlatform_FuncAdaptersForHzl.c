@@ -35,47 +35,33 @@
  */
 
 #include "hzlPlatform.h"
+#include "hzlPlatform_Clock.h"
 #include "hzl.h"
 
-#define MIN(a, b) (((a) < (b)) ? (a) : (b))
-
 /**
  * @internal
- * The RNG generates 16 bytes (128 bits) at the time, but HZL requires an arbitrary amount, so we
- * pass one block at the time to the output buffer and part of the last block to reach any amount.
+ * The random bytes come from the pool of hzlPlatform_Entropy.c, refilled in the background by
+ * the CSEc, or from the CSEc directly if the pool is short of bytes.
  */
 hzl_Err_t
-hzlPlatform_HzlAdapterTrng(uint8_t* bytes, size_t amount)
+hzlPlatform_HzlAdapterTrng(uint8_t* const bytes, const size_t amount)
 {
-    size_t remainingAmountInThisBlock;
-    uint8_t block[16];
-    while (amount)
+    if (!hzlPlatform_EntropyGet(bytes, amount))
     {
-        status_t status = CSEC_DRV_GenerateRND(block);
-        if (status != STATUS_SUCCESS)
-        {
-            return HZL_ERR_CANNOT_GENERATE_RANDOM;
-        }
-        remainingAmountInThisBlock = MIN(amount, sizeof(block));
-        memcpy(bytes, block, remainingAmountInThisBlock);
-        bytes += remainingAmountInThisBlock;
-        amount -= remainingAmountInThisBlock;
+        return HZL_ERR_CANNOT_GENERATE_RANDOM;
     }
     return HZL_OK;
 }
 
 /**
  * @internal
- * As FreeRTOS's tick has the resolution of 1 ms and it's a rolling counter, that is just
- * enough for the Hazelnet library. We are simply using said counter directly.
- *
- * MUST be used from WITHIN a task.
+ * The Hazelnet library expects a rolling counter of milliseconds, which is derived from the
+ * microsecond clock: unlike the FreeRTOS tick count, each millisecond starts exactly on time,
+ * whatever the interrupt latency, and it can be read from any context.
  */
 hzl_Err_t
 hzlPlatform_HzlAdapterCurrentTime(hzl_Timestamp_t* const timestamp)
 {
-    _Static_assert(sizeof(TickType_t) == sizeof(hzl_Timestamp_t),
-        "FreeRTOS should use proper tick sizes for the timestamps of this demo.");
-    *timestamp = xTaskGetTickCount();
+    *timestamp = (hzl_Timestamp_t) (hzlPlatform_ClockMicros() / 1000U);
     return HZL_OK;
 }
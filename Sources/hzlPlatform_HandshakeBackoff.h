@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Scheduling of the Requests (REQ) of a Client with exponential backoff and random jitter, so
+ * many Clients starting or losing their Session at the same time do not hammer the Server in
+ * lock-step.
+ *
+ * The first Request after startup is delayed by a random amount up to
+ * #HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS. Every further Request waits at most for the
+ * timeout of the previous one (timeoutReqToResMillis of the Client configuration), minus a random
+ * amount up to half of a backoff window: #HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS doubled for
+ * each Request left unanswered, capped by the timeout. Clients retrying together thus spread
+ * wider at each attempt, without any of them waiting longer than the timeout. A completed
+ * handshake lets the next Request, e.g. after a Session renewal was missed, go out immediately.
+ * A Request asked for earlier is deferred.
+ *
+ * Used by the TaskHzl of the Clients unless #HZL_PLATFORM_HANDSHAKE_NO_BACKOFF is defined.
+ */
+
+#ifndef HZL_PLATFORM_HANDSHAKEBACKOFF_H_
+#define HZL_PLATFORM_HANDSHAKEBACKOFF_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS
+/** Longest delay of the first Request after startup. */
+#define HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS 200000U
+#endif
+#ifndef HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS
+/** Backoff window after the first unanswered Request, doubled for each following one. */
+#define HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS 100000U
+#endif
+
+#if HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS < 1U
+#error "The handshake backoff must be at least 1 us."
+#endif
+
+/**
+ * Request schedule of the Client on one bus. Initialise with hzlPlatform_HandshakeBackoffInit()
+ * before use.
+ */
+typedef struct hzlPlatform_HandshakeBackoff
+{
+    /** Earliest time of the next Request. */
+    uint64_t notBeforeMicros;
+    /** Longest wait between Requests: the timeoutReqToResMillis of the Client, in microseconds. */
+    uint32_t capMicros;
+    /** Requests transmitted since the last completed handshake. */
+    uint8_t attempts;
+    /** A Request was asked for before hzlPlatform_HandshakeBackoff_t.notBeforeMicros. */
+    bool isDeferred;
+} hzlPlatform_HandshakeBackoff_t;
+
+/**
+ * Schedules the first Request at a random time within the startup jitter.
+ *
+ * @param random any 32 random bits
+ */
+static inline void
+hzlPlatform_HandshakeBackoffInit(hzlPlatform_HandshakeBackoff_t* const backoff,
+                                 const uint32_t capMicros,
+                                 const uint64_t nowMicros,
+                                 const uint32_t random)
+{
+    backoff->notBeforeMicros =
+        nowMicros + random % (HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS + 1U);
+    backoff->capMicros = capMicros;
+    backoff->attempts = 0U;
+    backoff->isDeferred = false;
+}
+
+/**
+ * Whether a Request may be transmitted now.
+ */
+static inline bool
+hzlPlatform_HandshakeBackoffIsDue(const hzlPlatform_HandshakeBackoff_t* const backoff,
+                                  const uint64_t nowMicros)
+{
+    return nowMicros >= backoff->notBeforeMicros;
+}
+
+/**
+ * Schedules the next Request after the one transmitted now: after the timeout of this one, minus
+ * a jitter within the backoff window.
+ *
+ * @param random any 32 random bits
+ */
+static inline void
+hzlPlatform_HandshakeBackoffSent(hzlPlatform_HandshakeBackoff_t* const backoff,
+                                 const uint64_t nowMicros,
+                                 const uint32_t random)
+{
+    uint64_t windowMicros = HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS;
+    for (uint8_t i = 0U; i < backoff->attempts && windowMicros < backoff->capMicros; i++)
+    {
+        windowMicros <<= 1U;
+    }
+    if (windowMicros > backoff->capMicros)
+    {
+        windowMicros = backoff->capMicros;
+    }
+    backoff->notBeforeMicros = nowMicros + backoff->capMicros
+                               - random % (windowMicros / 2U + 1U);
+    if (backoff->attempts < UINT8_MAX)
+    {
+        backoff->attempts++;
+    }
+}
+
+/**
+ * Lets the next Request go out immediately and drops the deferred one, which the completed
+ * handshake made pointless.
+ */
+static inline void
+hzlPlatform_HandshakeBackoffCompleted(hzlPlatform_HandshakeBackoff_t* const backoff)
+{
+    backoff->notBeforeMicros = 0U;
+    backoff->attempts = 0U;
+    backoff->isDeferred = false;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_HANDSHAKEBACKOFF_H_ */
@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Latency histograms in CPU cycles, see hzlPlatform_LatencyHist.h.
+ */
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_LatencyHist.h"
+
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+
+#if defined(__arm__)
+// Cortex-M4 debug registers, not part of the S32K144 device header.
+#define HZL_PLATFORM_LATENCY_HIST_DEMCR (*(volatile uint32_t*) 0xE000EDFCUL)
+#define HZL_PLATFORM_LATENCY_HIST_DEMCR_TRCENA (1UL << 24U)
+#define HZL_PLATFORM_LATENCY_HIST_DWT_CTRL (*(volatile uint32_t*) 0xE0001000UL)
+#define HZL_PLATFORM_LATENCY_HIST_DWT_CTRL_CYCCNTENA (1UL << 0U)
+#define HZL_PLATFORM_LATENCY_HIST_DWT_CYCCNT (*(volatile uint32_t*) 0xE0001004UL)
+#endif
+
+/** Largest bucket counter a log event can carry. */
+#define HZL_PLATFORM_LATENCY_HIST_LOG_COUNT_MAX UINT16_MAX
+
+_Static_assert(2U + 2U * HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG == 34U,
+               "Must match the arguments of the LATENCY_HIST event in hzlPlatform_LogEvents.h.");
+
+volatile hzlPlatform_LatencyHist_t hzlPlatform_LatencyHists[HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT];
+
+void
+hzlPlatform_LatencyHistInit(void)
+{
+#if defined(__arm__)
+    // The DWT unit is powered only with the trace enabled. Nothing to do on the host, where the
+    // time-stamp counter always runs.
+    HZL_PLATFORM_LATENCY_HIST_DEMCR |= HZL_PLATFORM_LATENCY_HIST_DEMCR_TRCENA;
+    HZL_PLATFORM_LATENCY_HIST_DWT_CYCCNT = 0U;
+    HZL_PLATFORM_LATENCY_HIST_DWT_CTRL |= HZL_PLATFORM_LATENCY_HIST_DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+void
+hzlPlatform_LatencyHistRecord(const hzlPlatform_LatencyHistOp_t op, const uint32_t cycles)
+{
+    // Index of the highest set bit, i.e. floor(log2(cycles)).
+    const uint32_t bucket = (cycles == 0U) ? 0U : (uint32_t) (31 - __builtin_clz(cycles));
+    // The TX operation is called by more than one task.
+    taskENTER_CRITICAL();
+    volatile hzlPlatform_LatencyHist_t* const hist = &hzlPlatform_LatencyHists[op];
+    hist->samples++;
+    hist->buckets[bucket]++;
+    if (cycles > hist->maxCycles)
+    {
+        hist->maxCycles = cycles;
+    }
+    taskEXIT_CRITICAL();
+}
+
+void
+hzlPlatform_LatencyHistDump(void)
+{
+    // Operation, first bucket, bucket counters.
+    uint8_t args[2U + 2U * HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG];
+    for (uint32_t op = 0U; op < HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT; op++)
+    {
+        for (uint32_t first = 0U;
+             first < HZL_PLATFORM_LATENCY_HIST_BUCKETS;
+             first += HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG)
+        {
+            bool isEmpty = true;
+            args[0] = (uint8_t) op;
+            args[1] = (uint8_t) first;
+            for (uint32_t i = 0U; i < HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG; i++)
+            {
+                uint32_t count = hzlPlatform_LatencyHists[op].buckets[first + i];
+                if (count > HZL_PLATFORM_LATENCY_HIST_LOG_COUNT_MAX)
+                {
+                    count = HZL_PLATFORM_LATENCY_HIST_LOG_COUNT_MAX;
+                }
+                isEmpty = isEmpty && (count == 0U);
+                args[2U + 2U * i] = (uint8_t) count;
+                args[3U + 2U * i] = (uint8_t) (count >> 8U);
+            }
+            if (!isEmpty)
+            {
+                hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_LATENCY_HIST, args);
+            }
+        }
+    }
+}
+
+#endif  /* HZL_PLATFORM_LATENCY_HIST */
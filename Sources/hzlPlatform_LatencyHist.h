@@ -0,0 +1,155 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Latency histograms of the Hazelnet calls and of the CAN FD transmission, in CPU cycles.
+ *
+ * Compiled in only when #HZL_PLATFORM_LATENCY_HIST is defined (e.g. with
+ * `-DHZL_PLATFORM_LATENCY_HIST` among the preprocessor symbols of the build configuration),
+ * otherwise all the macros below expand to nothing and no code nor RAM is spent on them.
+ *
+ * Each operation has a histogram of 32 log2 buckets: bucket `k` counts the calls that took
+ * `[2^k, 2^(k+1))` cycles, bucket 0 also the ones that took 0 cycles. The cycles are read from
+ * the DWT cycle counter on the S32K144 (48 MHz, wraps around every 89 s, which is fine for
+ * durations) and from the time-stamp counter on x86 hosts.
+ *
+ * The histograms are readable from the debugger in #hzlPlatform_LatencyHists and are written to
+ * the bus as #HZL_PLATFORM_LOG_EVENT_LATENCY_HIST log events upon a long press of Button 2.
+ *
+ * The list of operations has no dependencies, so it can be included by host tools too.
+ */
+
+#ifndef HZL_PLATFORM_LATENCYHIST_H_
+#define HZL_PLATFORM_LATENCYHIST_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * List of the measured operations as X-macro entries: `X(name, printable name)`.
+ * Operations can only be appended to the list, to keep the IDs stable for the log decoder.
+ */
+#define HZL_PLATFORM_LATENCY_HIST_OPS(X) \
+    X(PROCESS_RECEIVED, "ProcessReceived") \
+    X(BUILD_SECURED_FD, "BuildSecuredFd") \
+    X(CLIENT_BUILD_REQUEST, "ClientBuildRequest") \
+    X(FLEXCAN_TRANSMIT, "FlexcanTransmit")
+
+#define HZL_PLATFORM_LATENCY_HIST_OP_ENUM_ENTRY(name, printable) HZL_PLATFORM_LATENCY_HIST_OP_##name,
+
+/** Measured operations, the index of their histogram. */
+typedef enum
+{
+    HZL_PLATFORM_LATENCY_HIST_OPS(HZL_PLATFORM_LATENCY_HIST_OP_ENUM_ENTRY)
+    HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT,
+} hzlPlatform_LatencyHistOp_t;
+
+/** Buckets per histogram, one per bit of the cycles counter. */
+#define HZL_PLATFORM_LATENCY_HIST_BUCKETS 32U
+
+/**
+ * Buckets per #HZL_PLATFORM_LOG_EVENT_LATENCY_HIST log event, whose arguments are the operation,
+ * the first bucket index and this many bucket counters (uint16_t, little endian, saturated).
+ */
+#define HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG 16U
+
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+
+#include <stdint.h>
+
+/** Histogram of one operation. */
+typedef struct hzlPlatform_LatencyHist
+{
+    uint32_t samples;  ///< Amount of measured calls.
+    uint32_t maxCycles;  ///< Longest measured call.
+    uint32_t buckets[HZL_PLATFORM_LATENCY_HIST_BUCKETS];  ///< Calls per log2 of their cycles.
+} hzlPlatform_LatencyHist_t;
+
+/** Histograms of all operations, indexed by #hzlPlatform_LatencyHistOp_t. */
+extern volatile hzlPlatform_LatencyHist_t hzlPlatform_LatencyHists[HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT];
+
+/**
+ * @internal
+ * Current value of the free-running cycle counter. Inlined, as it brackets the measured code.
+ */
+static inline uint32_t
+hzlPlatform_LatencyHistCycles(void)
+{
+#if defined(__arm__)
+    return *(const volatile uint32_t*) 0xE0001004UL;  // DWT_CYCCNT
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t) __builtin_ia32_rdtsc();
+#else
+#error "No cycle counter known for this architecture."
+#endif
+}
+
+/**
+ * Starts the cycle counter. To be called once, before any measurement.
+ */
+void
+hzlPlatform_LatencyHistInit(void);
+
+/**
+ * Adds one measurement to the histogram of the operation. Safe to call from any task.
+ */
+void
+hzlPlatform_LatencyHistRecord(hzlPlatform_LatencyHistOp_t op, uint32_t cycles);
+
+/**
+ * Writes the non-empty parts of all histograms to the bus as binary log events.
+ */
+void
+hzlPlatform_LatencyHistDump(void);
+
+/** Declares the variable @p start holding the cycle counter at the start of a measurement. */
+#define HZL_PLATFORM_LATENCY_HIST_START(start) \
+    const uint32_t start = hzlPlatform_LatencyHistCycles()
+/** Records the cycles elapsed since #HZL_PLATFORM_LATENCY_HIST_START into the operation. */
+#define HZL_PLATFORM_LATENCY_HIST_STOP(op, start) \
+    hzlPlatform_LatencyHistRecord((op), hzlPlatform_LatencyHistCycles() - (start))
+#define HZL_PLATFORM_LATENCY_HIST_INIT() hzlPlatform_LatencyHistInit()
+#define HZL_PLATFORM_LATENCY_HIST_DUMP() hzlPlatform_LatencyHistDump()
+
+#else
+
+#define HZL_PLATFORM_LATENCY_HIST_START(start) do {} while (0)
+#define HZL_PLATFORM_LATENCY_HIST_STOP(op, start) do {} while (0)
+#define HZL_PLATFORM_LATENCY_HIST_INIT() do {} while (0)
+#define HZL_PLATFORM_LATENCY_HIST_DUMP() do {} while (0)
+
+#endif  /* HZL_PLATFORM_LATENCY_HIST */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_LATENCYHIST_H_ */
@@ -0,0 +1,391 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Deferred logging onto the bus: log messages (binary events or ASCII strings) are queued by the
+ * application without blocking and transmitted as unsecured CBS UAD messages by a low-priority
+ * task.
+ *
+ * The TaskLog coalesces repetitions of the same message (transmitting a single "<message> xN" per
+ * #HZL_PLATFORM_LOG_COALESCE_TICKS instead of every copy) and limits the transmission rate with a
+ * token bucket, so a flood of warnings cannot saturate the bus nor slow down the secured traffic.
+ */
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_LogEvents.h"
+#include "hzlPlatform_SpscRing.h"
+#include "hzlPlatform_Telemetry.h"
+#include "hzl.h"
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+#include "hzl_Server.h"
+#include "hzl_HardcodedConfigServer.h"
+#else
+#include "hzl_Client.h"
+#include "hzl_HardcodedConfigClient.h"
+#endif
+
+#if (HZL_PLATFORM_LOG_QUEUE_LEN & (HZL_PLATFORM_LOG_QUEUE_LEN - 1U)) != 0U \
+    || HZL_PLATFORM_LOG_QUEUE_LEN > UINT8_MAX
+#error "The log queue length must be a power of 2 up to 128."
+#endif
+
+_Static_assert(HZL_PLATFORM_LOG_EVENT_AMOUNT <= HZL_PLATFORM_LOG_EVENT_ID_MAX + 1U,
+               "Log event IDs must not overlap with printable ASCII characters.");
+
+#define HZL_PLATFORM_LOG_EVENT_ARGS_AMOUNT_ENTRY(name, argsAmount, format) argsAmount,
+
+/**
+ * @internal
+ * Amount of argument bytes following each event ID.
+ */
+static const uint8_t hzlPlatform_LogEventArgsAmount[HZL_PLATFORM_LOG_EVENT_AMOUNT] =
+{
+    0U,  // HZL_PLATFORM_LOG_EVENT_INVALID
+    HZL_PLATFORM_LOG_EVENTS(HZL_PLATFORM_LOG_EVENT_ARGS_AMOUNT_ENTRY)
+};
+
+/**
+ * @internal
+ * Length of the header of a #HZL_PLATFORM_LOG_EVENT_REPEATED message: event ID and uint16_t
+ * amount of repetitions.
+ */
+#define HZL_PLATFORM_LOG_REPEATED_HEADER_LEN 3U
+
+/**
+ * @internal
+ * A queued log message: a binary event or an ASCII string, without null terminator.
+ */
+typedef struct hzlPlatform_LogEntry
+{
+    uint8_t len;
+    uint8_t data[HZL_PLATFORM_LOG_MSG_MAX_LEN];
+} hzlPlatform_LogEntry_t;
+
+/**
+ * @internal
+ * Preallocated log messages, handed between the application and the TaskLog by index.
+ */
+static hzlPlatform_LogEntry_t hzlPlatform_LogEntries[HZL_PLATFORM_LOG_QUEUE_LEN];
+
+/**
+ * @internal
+ * Indices of the entries holding queued messages, oldest first.
+ * Producers: any task, serialised by a critical section. Consumer: the TaskLog.
+ */
+static hzlPlatform_SpscRing_t hzlPlatform_LogReady;
+static uint8_t hzlPlatform_LogReadyItems[HZL_PLATFORM_LOG_QUEUE_LEN];
+
+/**
+ * @internal
+ * Indices of the entries available for new messages.
+ * Producer: the TaskLog. Consumers: any task, serialised by a critical section.
+ */
+static hzlPlatform_SpscRing_t hzlPlatform_LogFree;
+static uint8_t hzlPlatform_LogFreeItems[HZL_PLATFORM_LOG_QUEUE_LEN];
+
+static TaskHandle_t hzlPlatform_LogTaskHandle = NULL;
+
+/**
+ * @internal
+ * True while the TaskLog is handling messages, so hzlPlatform_LogDeinit() knows it's not done.
+ */
+static volatile bool hzlPlatform_LogIsBusy = false;
+
+/**
+ * @internal
+ * Token bucket of the rate limiter: amount of messages that can be transmitted right now and
+ * tick of the last token refill. Accessed only by the TaskLog.
+ */
+static uint32_t hzlPlatform_LogTokens;
+static TickType_t hzlPlatform_LogLastRefillTick;
+
+/**
+ * @internal
+ * Waits for the rate limiter to allow one more transmission and consumes the token.
+ * Only the TaskLog waits, the application never does.
+ */
+static void
+hzlPlatform_LogTakeToken(void)
+{
+    while (true)
+    {
+        const TickType_t now = xTaskGetTickCount();
+        const TickType_t newTokens = (now - hzlPlatform_LogLastRefillTick)
+                                     / HZL_PLATFORM_LOG_TICKS_PER_MSG;
+        if (newTokens > 0U)
+        {
+            hzlPlatform_LogTokens += newTokens;
+            if (hzlPlatform_LogTokens > HZL_PLATFORM_LOG_BURST)
+            {
+                hzlPlatform_LogTokens = HZL_PLATFORM_LOG_BURST;
+            }
+            hzlPlatform_LogLastRefillTick += newTokens * HZL_PLATFORM_LOG_TICKS_PER_MSG;
+        }
+        if (hzlPlatform_LogTokens > 0U)
+        {
+            hzlPlatform_LogTokens--;
+            return;
+        }
+        vTaskDelay(HZL_PLATFORM_LOG_TICKS_PER_MSG
+                   - (now - hzlPlatform_LogLastRefillTick));
+    }
+}
+
+/**
+ * @internal
+ * Transmits a log message on the bus in the form of a CBS UAD message, which all other parties
+ * are configured to ignore, respecting the rate limit.
+ *
+ * Building an unsecured message only reads the configuration of the Hazelnet context, so it
+ * does not interfere with the TaskHzl using the same context. The messages go on the main bus,
+ * with its context hzlCtx0.
+ */
+static void
+hzlPlatform_LogTransmit(const uint8_t* const data, const size_t len)
+{
+    hzlPlatform_LogTakeToken();
+    hzl_CbsPduMsg_t uad;
+    const hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_BUILD_UNSECURED(&uad, &hzlCtx0,
+        data, len,
+        HZL_BROADCAST_GID);
+    if (hzlErrCode != HZL_OK)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_HZL_BUILD_UAD);
+    }
+    hzlPlatform_FlexcanTransmit(HZL_PLATFORM_BUS_MAIN, uad.data, uad.dataLen);
+    hzlPlatform_Telemetry.logMessagesSent++;
+}
+
+/**
+ * @internal
+ * Transmits the summary of the coalesced repetitions of a log message.
+ *
+ * A binary event is wrapped into a #HZL_PLATFORM_LOG_EVENT_REPEATED event, an ASCII string
+ * gets the " xN" suffix, truncating the string if needed to fit it.
+ */
+static void
+hzlPlatform_LogTransmitRepetitions(const hzlPlatform_LogEntry_t* const entry,
+                                   const uint32_t repetitions)
+{
+    uint8_t summary[HZL_PLATFORM_LOG_MSG_MAX_LEN + HZL_PLATFORM_LOG_REPEATED_HEADER_LEN];
+    size_t summaryLen;
+    if (entry->data[0] <= HZL_PLATFORM_LOG_EVENT_ID_MAX)
+    {
+        const uint16_t saturated = (repetitions > UINT16_MAX)
+                                   ? UINT16_MAX
+                                   : (uint16_t) repetitions;
+        summary[0] = HZL_PLATFORM_LOG_EVENT_REPEATED;
+        summary[1] = (uint8_t) saturated;
+        summary[2] = (uint8_t) (saturated >> 8U);
+        memcpy(&summary[HZL_PLATFORM_LOG_REPEATED_HEADER_LEN], entry->data, entry->len);
+        summaryLen = HZL_PLATFORM_LOG_REPEATED_HEADER_LEN + entry->len;
+    }
+    else
+    {
+        char suffix[16U];
+        const int suffixLen = snprintf(suffix, sizeof(suffix), " x%" PRIu32, repetitions);
+        size_t textLen = entry->len;
+        if (textLen + (size_t) suffixLen > HZL_PLATFORM_LOG_MSG_MAX_LEN)
+        {
+            textLen = HZL_PLATFORM_LOG_MSG_MAX_LEN - (size_t) suffixLen;
+        }
+        memcpy(summary, entry->data, textLen);
+        memcpy(&summary[textLen], suffix, (size_t) suffixLen);
+        summaryLen = textLen + (size_t) suffixLen;
+    }
+    hzlPlatform_LogTransmit(summary, summaryLen);
+}
+
+/**
+ * @internal
+ * Low-priority task transmitting the queued log messages.
+ *
+ * A message equal to the last transmitted one within #HZL_PLATFORM_LOG_COALESCE_TICKS is only
+ * counted. The count is transmitted when a different message arrives or when the coalescing
+ * period ends, whichever happens first.
+ */
+static void
+hzlPlatform_TaskLog(void* const unusedParam)
+{
+    (void) unusedParam;
+    static hzlPlatform_LogEntry_t last = {0};
+    uint32_t lastRepetitions = 0U;
+    TickType_t lastTransmissionTick = xTaskGetTickCount();
+    while (true)
+    {
+        // Sleep until a new message is queued or the pending repetitions must be reported.
+        TickType_t timeout = portMAX_DELAY;
+        if (lastRepetitions > 0U)
+        {
+            const TickType_t elapsed = xTaskGetTickCount() - lastTransmissionTick;
+            timeout = (elapsed < HZL_PLATFORM_LOG_COALESCE_TICKS)
+                      ? HZL_PLATFORM_LOG_COALESCE_TICKS - elapsed
+                      : 0U;
+        }
+        (void) ulTaskNotifyTake(pdTRUE, timeout);
+        hzlPlatform_LogIsBusy = true;
+        uint8_t entryIdx;
+        while (hzlPlatform_SpscRingPop(&hzlPlatform_LogReady, &entryIdx))
+        {
+            const hzlPlatform_LogEntry_t* const entry = &hzlPlatform_LogEntries[entryIdx];
+            if (entry->len == last.len
+                && memcmp(entry->data, last.data, entry->len) == 0
+                && (xTaskGetTickCount() - lastTransmissionTick) < HZL_PLATFORM_LOG_COALESCE_TICKS)
+            {
+                lastRepetitions++;
+                hzlPlatform_Telemetry.logMessagesCoalesced++;
+            }
+            else
+            {
+                if (lastRepetitions > 0U)
+                {
+                    hzlPlatform_LogTransmitRepetitions(&last, lastRepetitions);
+                    lastRepetitions = 0U;
+                }
+                hzlPlatform_LogTransmit(entry->data, entry->len);
+                last = *entry;
+                lastTransmissionTick = xTaskGetTickCount();
+            }
+            // Cannot fail: the ring can hold all the entries.
+            (void) hzlPlatform_SpscRingPush(&hzlPlatform_LogFree, entryIdx);
+        }
+        if (lastRepetitions > 0U
+            && (xTaskGetTickCount() - lastTransmissionTick) >= HZL_PLATFORM_LOG_COALESCE_TICKS)
+        {
+            hzlPlatform_LogTransmitRepetitions(&last, lastRepetitions);
+            lastRepetitions = 0U;
+            lastTransmissionTick = xTaskGetTickCount();
+        }
+        hzlPlatform_LogIsBusy = false;
+    }
+}
+
+/**
+ * @internal
+ * Copies a log message into a free entry and wakes up the TaskLog, without blocking.
+ *
+ * If no entry is free, the message is discarded.
+ */
+static void
+hzlPlatform_LogEnqueue(const uint8_t* const head, const size_t headLen,
+                       const uint8_t* const tail, const size_t tailLen)
+{
+    uint8_t entryIdx;
+    taskENTER_CRITICAL();
+    if (hzlPlatform_LogTaskHandle == NULL
+        || !hzlPlatform_SpscRingPop(&hzlPlatform_LogFree, &entryIdx))
+    {
+        // The TaskLog cannot keep up (or is stopped): better lose the message than slow down
+        // the caller.
+        hzlPlatform_Telemetry.logMessagesDropped++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    hzlPlatform_LogEntry_t* const entry = &hzlPlatform_LogEntries[entryIdx];
+    memcpy(entry->data, head, headLen);
+    if (tailLen > 0U)
+    {
+        memcpy(&entry->data[headLen], tail, tailLen);
+    }
+    entry->len = (uint8_t) (headLen + tailLen);
+    // Cannot fail: the ring can hold all the entries.
+    (void) hzlPlatform_SpscRingPush(&hzlPlatform_LogReady, entryIdx);
+    const TaskHandle_t task = hzlPlatform_LogTaskHandle;
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(task);
+}
+
+void
+hzlPlatform_LogInit(void)
+{
+    hzlPlatform_SpscRingInit(&hzlPlatform_LogReady,
+        hzlPlatform_LogReadyItems,
+        HZL_PLATFORM_LOG_QUEUE_LEN);
+    hzlPlatform_SpscRingInit(&hzlPlatform_LogFree,
+        hzlPlatform_LogFreeItems,
+        HZL_PLATFORM_LOG_QUEUE_LEN);
+    for (uint8_t entryIdx = 0U; entryIdx < HZL_PLATFORM_LOG_QUEUE_LEN; entryIdx++)
+    {
+        (void) hzlPlatform_SpscRingPush(&hzlPlatform_LogFree, entryIdx);
+    }
+    hzlPlatform_LogTokens = HZL_PLATFORM_LOG_BURST;
+    hzlPlatform_LogLastRefillTick = xTaskGetTickCount();
+    const BaseType_t created = xTaskCreate(
+        hzlPlatform_TaskLog,
+        "TaskLog",
+        HZL_PLATFORM_TASK_STACK_WORDS_LOG,
+        NULL,
+        HZL_PLATFORM_TASK_PRIORITY_LOG,
+        &hzlPlatform_LogTaskHandle);
+    if (created != pdPASS)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_RTOS_TASK_CREATION);
+    }
+}
+
+void
+hzlPlatform_Log(const char* const string)
+{
+    size_t len = strlen(string);
+    if (len > HZL_PLATFORM_LOG_MSG_MAX_LEN)
+    {
+        len = HZL_PLATFORM_LOG_MSG_MAX_LEN;
+    }
+    hzlPlatform_LogEnqueue((const uint8_t*) string, len, NULL, 0U);
+}
+
+void
+hzlPlatform_LogEvent(const hzlPlatform_LogEvent_t event, const uint8_t* const args)
+{
+    if (event == HZL_PLATFORM_LOG_EVENT_INVALID
+        || event == HZL_PLATFORM_LOG_EVENT_REPEATED
+        || event >= HZL_PLATFORM_LOG_EVENT_AMOUNT)
+    {
+        // Programming error: not an event the application can log.
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_LOG_EVENT_INVALID);
+    }
+    const uint8_t eventId = (uint8_t) event;
+    hzlPlatform_LogEnqueue(&eventId, 1U, args, hzlPlatform_LogEventArgsAmount[event]);
+}
+
+void
+hzlPlatform_LogDeinit(const TickType_t maxWaitTicks)
+{
+    for (TickType_t waited = 0U;
+         (hzlPlatform_SpscRingAmount(&hzlPlatform_LogReady) > 0U || hzlPlatform_LogIsBusy)
+         && waited < maxWaitTicks;
+         waited++)
+    {
+        vTaskDelay(1U);  // Lets the lower-priority TaskLog run.
+    }
+    const TaskHandle_t task = hzlPlatform_LogTaskHandle;
+    hzlPlatform_LogTaskHandle = NULL;  // Any later message is discarded.
+    vTaskDelete(task);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Catalogue of the binary log events the platform writes to the bus.
+ *
+ * Instead of a formatted ASCII string, a binary log message consists of the 1-byte event ID
+ * followed by the fixed amount of 1-byte arguments of the event. The decoding format strings are
+ * not transmitted, they are only used by the host decoder (toolsupport/logdecoder), which prints
+ * each argument as an `unsigned int`. The event IDs are all below 0x20, so binary messages are
+ * distinguishable from the plain ASCII ones.
+ *
+ * This header has no dependencies, so it can be included by host tools too.
+ * Events can only be appended to the list, to keep the IDs stable for the decoder.
+ */
+
+#ifndef HZL_PLATFORM_LOGEVENTS_H_
+#define HZL_PLATFORM_LOGEVENTS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * List of the log events as X-macro entries: `X(name, amount of arguments, decoding format)`.
+ */
+#define HZL_PLATFORM_LOG_EVENTS(X) \
+    X(REPEATED, 2U, "%s x%u") \
+    X(RX_SECRET_COUNTER, 3U, "RX GID=%02X,SID=%02X,Secret counter=%02X") \
+    X(SECWARN_INVALID_TAG, 0U, "WARN: invalid tag") \
+    X(SECWARN_MESSAGE_FROM_MYSELF, 0U, "WARN: message from myself") \
+    X(SECWARN_NOT_EXPECTING_A_RESPONSE, 0U, "WARN: not expecting RES") \
+    X(SECWARN_SERVER_ONLY_MESSAGE, 0U, "WARN: server-only message") \
+    X(SECWARN_RESPONSE_TIMEOUT, 0U, "WARN: RES too late (timeout REQ-to-RES)") \
+    X(SECWARN_OLD_MESSAGE, 0U, "WARN: old counter nonce") \
+    X(SECWARN_DENIAL_OF_SERVICE, 0U, "WARN: denial of service") \
+    X(SECWARN_NOT_IN_GROUP, 0U, "WARN: Client not in REQ Group") \
+    X(SECWARN_RECEIVED_OVERFLOWN_NONCE, 0U, "WARN: RX overflown counter nonce") \
+    X(SECWARN_RECEIVED_ZERO_KEY, 0U, "WARN: RX all-zero key") \
+    X(TOO_MANY_SECWARNINGS, 0U, "INFO: too many secwarnings") \
+    X(SESSION_NOT_ESTABLISHED, 0U, "INFO: Session not established, cannot RX yet") \
+    X(PROCESS_RX_ERROR, 1U, "ERROR: unexpected problem with process RX, err=%u") \
+    X(WAITING_FOR_RES, 0U, "INFO: Not requesting yet, still waiting for RES") \
+    X(NO_CLIENTS_FOR_REN, 0U, "INFO: No Clients to send REN to") \
+    X(CANNOT_TX_NO_REQ, 0U, "INFO: Cannot TX yet, no REQ so far") \
+    X(CANNOT_TX_NO_RES, 0U, "INFO: Cannot TX yet, no RES yet") \
+    X(BUILD_SADFD_ERROR, 1U, "ERROR: problem with building SADFD, err=%u") \
+    X(POWERING_DOWN, 0U, "INFO: powering down") \
+    X(SERVER_CANNOT_POWER_DOWN, 0U, "INFO: the Server cannot be powered down") \
+    X(LATENCY_HIST, 34U, "LATENCY %s cycles:%s")
+
+#define HZL_PLATFORM_LOG_EVENT_ENUM_ENTRY(name, argsAmount, format) HZL_PLATFORM_LOG_EVENT_##name,
+
+/**
+ * Log event IDs, the first byte of a binary log message.
+ *
+ * #HZL_PLATFORM_LOG_EVENT_REPEATED is generated by the TaskLog only: its arguments are the
+ * amount of repetitions (uint16_t, little endian) and it's followed by the repeated event.
+ * #HZL_PLATFORM_LOG_EVENT_LATENCY_HIST carries a part of a latency histogram, see
+ * hzlPlatform_LatencyHist.h.
+ */
+typedef enum
+{
+    HZL_PLATFORM_LOG_EVENT_INVALID = 0x00U,
+    HZL_PLATFORM_LOG_EVENTS(HZL_PLATFORM_LOG_EVENT_ENUM_ENTRY)
+    HZL_PLATFORM_LOG_EVENT_AMOUNT,
+} hzlPlatform_LogEvent_t;
+
+/** Highest possible event ID: plain ASCII log messages start with a printable character. */
+#define HZL_PLATFORM_LOG_EVENT_ID_MAX 0x1FU
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_LOGEVENTS_H_ */
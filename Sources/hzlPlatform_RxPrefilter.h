@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Checks of a received frame that need no cryptography, before the Hazelnet library parses,
+ * authenticates and decrypts it.
+ *
+ * Every node transmits with the CAN ID of its SID (see #hzlPlatform_CanId_t) and only exchanges
+ * messages with its peers (see hzlPlatform_CanFilter.h) in the Groups of its configuration, so a
+ * few comparisons and table lookups on the CAN ID, the length and the CBS header discard
+ * frames from this node itself, from unknown senders, with a SID not matching their CAN ID,
+ * malformed or for foreign Groups. The RX acceptance filters already discard most foreign CAN
+ * IDs, but not all of them: they have a single mask for all peers. All roles.
+ *
+ * Used by the TaskHzl unless #HZL_PLATFORM_RX_NO_PREFILTER is defined.
+ */
+
+#ifndef HZL_PLATFORM_RXPREFILTER_H_
+#define HZL_PLATFORM_RXPREFILTER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "hzlPlatform.h"
+#include "hzlPlatform_CanFilter.h"
+#include "hzlPlatform_CbsHeader.h"
+#include "hzlPlatform_Telemetry.h"
+
+/** SID of the CAN IDs no node transmits with. */
+#define HZL_PLATFORM_RX_PREFILTER_SID_NONE 0xFFU
+/** Words of the bitmap of the accepted GIDs: any 8-bit GID. */
+#define HZL_PLATFORM_RX_PREFILTER_GID_WORDS (256U / 32U)
+
+/**
+ * What a bus accepts. Initialise with hzlPlatform_RxPrefilterInit() before use.
+ */
+typedef struct hzlPlatform_RxPrefilter
+{
+    /** GIDs of the Groups of this node, as a bitmap: bit g%32 of word g/32 for GID g. */
+    uint32_t gids[HZL_PLATFORM_RX_PREFILTER_GID_WORDS];
+    /** SIDs this node receives frames from, see hzlPlatform_CanFilterPeers(). */
+    uint64_t peers;
+    uint8_t ownSid;
+} hzlPlatform_RxPrefilter_t;
+
+/**
+ * SID of the node transmitting with the CAN ID, #HZL_PLATFORM_RX_PREFILTER_SID_NONE if none.
+ */
+static inline uint8_t
+hzlPlatform_RxPrefilterSidOfCanId(const uint32_t canId)
+{
+    if (canId == (uint32_t) HZL_PLATFORM_CANID_FROM_SERVER)
+    {
+        return HZL_PLATFORM_CANFILTER_SID_SERVER;
+    }
+    const uint32_t clientIdx = canId - (uint32_t) HZL_PLATFORM_CANID_FROM_ALICE;
+    return (clientIdx < HZL_PLATFORM_CANFILTER_SIDS_AMOUNT - 1U)
+           ? (uint8_t) (clientIdx + 1U)
+           : HZL_PLATFORM_RX_PREFILTER_SID_NONE;
+}
+
+/**
+ * Accepts the peers of the node with the given SID and no Group yet. A SID without peers in
+ * the CAN ID filter table accepts any sender, like the RX acceptance filters do.
+ */
+static inline void
+hzlPlatform_RxPrefilterInit(hzlPlatform_RxPrefilter_t* const prefilter, const uint8_t ownSid)
+{
+    memset(prefilter, 0, sizeof(*prefilter));
+    prefilter->ownSid = ownSid;
+    prefilter->peers = hzlPlatform_CanFilterPeers(ownSid);
+}
+
+/**
+ * Accepts the frames for the Group.
+ */
+static inline void
+hzlPlatform_RxPrefilterAcceptGid(hzlPlatform_RxPrefilter_t* const prefilter, const uint8_t gid)
+{
+    prefilter->gids[gid / 32U] |= 1U << (gid % 32U);
+}
+
+/**
+ * Whether the frame is worth processing with the Hazelnet library. Anything accepted can still
+ * fail there: these checks are necessary, not sufficient.
+ *
+ * @param reason why the frame is discarded, written only when returning false
+ */
+static inline bool
+hzlPlatform_RxPrefilterAccepts(const hzlPlatform_RxPrefilter_t* const prefilter,
+                               const uint32_t canId,
+                               const uint8_t* const data,
+                               const uint32_t dataLen,
+                               hzlPlatform_TelemetryPrefilter_t* const reason)
+{
+    const uint8_t sid = hzlPlatform_RxPrefilterSidOfCanId(canId);
+    const hzlPlatform_CbsPty_t pty = hzlPlatform_CbsPty(data, dataLen);
+    if (sid == prefilter->ownSid
+        || (pty != HZL_PLATFORM_CBS_PTY_NONE
+            && data[HZL_PLATFORM_CBS_HEADER_SID_IDX] == prefilter->ownSid))
+    {
+        *reason = HZL_PLATFORM_TELEMETRY_PREFILTER_FROM_MYSELF;
+    }
+    else if (prefilter->peers != 0U
+             && (sid == HZL_PLATFORM_RX_PREFILTER_SID_NONE
+                 || (prefilter->peers & (1ULL << sid)) == 0U))
+    {
+        *reason = HZL_PLATFORM_TELEMETRY_PREFILTER_UNKNOWN_SENDER;
+    }
+    else if (pty > HZL_PLATFORM_CBS_PTY_REN
+             || (pty == HZL_PLATFORM_CBS_PTY_SADFD && dataLen < HZL_PLATFORM_CBS_SADFD_OVERHEAD))
+    {
+        // Includes HZL_PLATFORM_CBS_PTY_NONE, too short for a header.
+        *reason = HZL_PLATFORM_TELEMETRY_PREFILTER_MALFORMED;
+    }
+    else if (sid != HZL_PLATFORM_RX_PREFILTER_SID_NONE
+             && data[HZL_PLATFORM_CBS_HEADER_SID_IDX] != sid)
+    {
+        *reason = HZL_PLATFORM_TELEMETRY_PREFILTER_SID_MISMATCH;
+    }
+    else if ((prefilter->gids[data[HZL_PLATFORM_CBS_HEADER_GID_IDX] / 32U]
+              & (1U << (data[HZL_PLATFORM_CBS_HEADER_GID_IDX] % 32U))) == 0U)
+    {
+        *reason = HZL_PLATFORM_TELEMETRY_PREFILTER_FOREIGN_GROUP;
+    }
+    else
+    {
+        return true;
+    }
+    return false;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_RXPREFILTER_H_ */
@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Accounting of the security warnings per sender, to tell a desynchronised Session from junk
+ * frames injected on the bus.
+ *
+ * Only the warnings hinting at a desynchronisation (see hzlPlatform_TaskHzl.c) are accounted,
+ * per CAN ID: a sender is desynchronised when more than #HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE of
+ * its frames in a row caused one, with no authenticated frame in between, as an authenticated
+ * frame proves the Session still works. There is no time window, so a peer transmitting once
+ * every few seconds is judged like a fast one.
+ * The resulting resynchronisation of the bus (a new handshake on a Client, a Session renewal on
+ * the Server) happens at most once per #HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS, so a flood
+ * of forged frames costs the network a bounded amount of handshake traffic.
+ */
+
+#ifndef HZL_PLATFORM_SECWARNLIMITER_H_
+#define HZL_PLATFORM_SECWARNLIMITER_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE
+/** Consecutive warnings of a sender tolerated, one more means it is desynchronised. */
+#define HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE 5U
+#endif
+#ifndef HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS
+/**
+ * Shortest time between two resynchronisations of a bus, longer than the
+ * timeoutReqToResMillis of the Clients so a handshake can complete first.
+ */
+#define HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS 10000000U
+#endif
+#ifndef HZL_PLATFORM_SECWARN_SENDERS
+/** CAN IDs accounted per bus. One more replaces the one that warned least recently. */
+#define HZL_PLATFORM_SECWARN_SENDERS 8U
+#endif
+
+#if HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE < 1U
+#error "At least one consecutive security warning must be tolerated."
+#endif
+#if HZL_PLATFORM_SECWARN_SENDERS < 1U
+#error "At least one sender must be accounted for the security warnings."
+#endif
+
+/**
+ * Outcome of a security warning.
+ */
+typedef enum hzlPlatform_SecWarnVerdict
+{
+    /** Within the tolerance of the sender. */
+    HZL_PLATFORM_SECWARN_VERDICT_TOLERATED = 0U,
+    /** The sender is desynchronised: resynchronise the bus now. */
+    HZL_PLATFORM_SECWARN_VERDICT_RESYNC,
+    /** The sender is desynchronised, but the bus was resynchronised too recently. */
+    HZL_PLATFORM_SECWARN_VERDICT_HELD_OFF,
+} hzlPlatform_SecWarnVerdict_t;
+
+/**
+ * Consecutive warnings of one CAN ID.
+ */
+typedef struct hzlPlatform_SecWarnSender
+{
+    /** Time of the last warning, to pick the entry to replace. */
+    uint64_t lastWarnMicros;
+    uint32_t canId;
+    /** Warnings since the last authenticated frame, 0 when the entry is free. */
+    uint32_t warnings;
+} hzlPlatform_SecWarnSender_t;
+
+/**
+ * Accounting of one bus. All zeros, as in static storage, is a bus without warnings.
+ */
+typedef struct hzlPlatform_SecWarnLimiter
+{
+    hzlPlatform_SecWarnSender_t senders[HZL_PLATFORM_SECWARN_SENDERS];
+    /** Last resynchronisation, valid only if hzlPlatform_SecWarnLimiter_t.hasResynced. */
+    uint64_t lastResyncMicros;
+    bool hasResynced;
+} hzlPlatform_SecWarnLimiter_t;
+
+/**
+ * @internal
+ * The entry of the CAN ID, else a free one, else the one that warned least recently, reset.
+ */
+static inline hzlPlatform_SecWarnSender_t*
+hzlPlatform_SecWarnSenderOf(hzlPlatform_SecWarnLimiter_t* const limiter, const uint32_t canId)
+{
+    hzlPlatform_SecWarnSender_t* freeSender = NULL;
+    hzlPlatform_SecWarnSender_t* stalest = &limiter->senders[0];
+    for (size_t i = 0U; i < HZL_PLATFORM_SECWARN_SENDERS; i++)
+    {
+        hzlPlatform_SecWarnSender_t* const sender = &limiter->senders[i];
+        if (sender->warnings == 0U)
+        {
+            freeSender = (freeSender == NULL) ? sender : freeSender;
+        }
+        else if (sender->canId == canId)
+        {
+            return sender;
+        }
+        else if (sender->lastWarnMicros < stalest->lastWarnMicros)
+        {
+            stalest = sender;
+        }
+    }
+    hzlPlatform_SecWarnSender_t* const sender = (freeSender != NULL) ? freeSender : stalest;
+    sender->canId = canId;
+    sender->warnings = 0U;
+    return sender;
+}
+
+/**
+ * Accounts a security warning hinting at a desynchronisation, caused by a frame with the given
+ * CAN ID, and tells whether to resynchronise the bus.
+ */
+static inline hzlPlatform_SecWarnVerdict_t
+hzlPlatform_SecWarnLimiterWarned(hzlPlatform_SecWarnLimiter_t* const limiter,
+                                 const uint32_t canId,
+                                 const uint64_t nowMicros)
+{
+    hzlPlatform_SecWarnSender_t* const sender = hzlPlatform_SecWarnSenderOf(limiter, canId);
+    sender->lastWarnMicros = nowMicros;
+    sender->warnings++;
+    if (sender->warnings <= HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE)
+    {
+        return HZL_PLATFORM_SECWARN_VERDICT_TOLERATED;
+    }
+    // Judged: the next verdict on this sender needs as many warnings again.
+    sender->warnings = 0U;
+    if (limiter->hasResynced
+        && nowMicros - limiter->lastResyncMicros < HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS)
+    {
+        return HZL_PLATFORM_SECWARN_VERDICT_HELD_OFF;
+    }
+    limiter->hasResynced = true;
+    limiter->lastResyncMicros = nowMicros;
+    return HZL_PLATFORM_SECWARN_VERDICT_RESYNC;
+}
+
+/**
+ * Forgets the warnings of the CAN ID, whose frame was just authenticated.
+ */
+static inline void
+hzlPlatform_SecWarnLimiterValidated(hzlPlatform_SecWarnLimiter_t* const limiter,
+                                    const uint32_t canId)
+{
+    for (size_t i = 0U; i < HZL_PLATFORM_SECWARN_SENDERS; i++)
+    {
+        if (limiter->senders[i].warnings != 0U && limiter->senders[i].canId == canId)
+        {
+            limiter->senders[i].warnings = 0U;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_SECWARNLIMITER_H_ */
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Lock-free single-producer/single-consumer ring of small indices.
+ *
+ * Used to hand over items between an interrupt and a task (or between two tasks) without
+ * critical sections: the producer only writes the head, the consumer only writes the tail, and
+ * the acquire/release ordering makes the stored item visible before the index that publishes it.
+ *
+ * The items are indices (e.g. of preallocated frame slots), not the data itself, so the data
+ * is never copied through the ring.
+ */
+
+#ifndef HZL_PLATFORM_SPSCRING_H_
+#define HZL_PLATFORM_SPSCRING_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/**
+ * SPSC ring state. Initialise with hzlPlatform_SpscRingInit() before use.
+ *
+ * The head and tail are free-running counters: their difference is the amount of stored items,
+ * the position in the buffer is obtained by masking them.
+ */
+typedef struct hzlPlatform_SpscRing
+{
+    /** Amount of pushed items since init. Written only by the producer. */
+    atomic_uint_fast32_t head;
+    /** Amount of popped items since init. Written only by the consumer. */
+    atomic_uint_fast32_t tail;
+    /** Storage of the items, of hzlPlatform_SpscRing_t.capacity elements. */
+    uint8_t* items;
+    /** Amount of items the ring can hold, must be a power of 2. */
+    uint32_t capacity;
+} hzlPlatform_SpscRing_t;
+
+/**
+ * Resets the ring to empty and sets its storage.
+ * Must not run concurrently with any other operation on the same ring.
+ *
+ * @param [out] ring to initialise
+ * @param [in] items buffer of \p capacity elements
+ * @param [in] capacity power of 2
+ */
+static inline void
+hzlPlatform_SpscRingInit(hzlPlatform_SpscRing_t* const ring,
+                         uint8_t* const items,
+                         const uint32_t capacity)
+{
+    atomic_init(&ring->head, 0U);
+    atomic_init(&ring->tail, 0U);
+    ring->items = items;
+    ring->capacity = capacity;
+}
+
+/**
+ * Producer side: appends an item to the ring.
+ *
+ * @return false if the ring is full and the item was not stored
+ */
+static inline bool
+hzlPlatform_SpscRingPush(hzlPlatform_SpscRing_t* const ring, const uint8_t item)
+{
+    const uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= ring->capacity)
+    {
+        return false;
+    }
+    ring->items[head & (ring->capacity - 1U)] = item;
+    // Publishes the item to the consumer.
+    atomic_store_explicit(&ring->head, head + 1U, memory_order_release);
+    return true;
+}
+
+/**
+ * Consumer side: removes the oldest item from the ring.
+ *
+ * @param [out] item where to write the popped item
+ * @return false if the ring is empty and nothing was popped
+ */
+static inline bool
+hzlPlatform_SpscRingPop(hzlPlatform_SpscRing_t* const ring, uint8_t* const item)
+{
+    const uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail)
+    {
+        return false;
+    }
+    *item = ring->items[tail & (ring->capacity - 1U)];
+    // Gives the position back to the producer only after the item was read.
+    atomic_store_explicit(&ring->tail, tail + 1U, memory_order_release);
+    return true;
+}
+
+/**
+ * Consumer side: like hzlPlatform_SpscRingPop(), but also overwrites the position of the popped
+ * item with 0 before giving it back to the producer, for items that must not linger in memory
+ * (e.g. random bytes becoming keys).
+ *
+ * @param [out] item where to write the popped item
+ * @return false if the ring is empty and nothing was popped
+ */
+static inline bool
+hzlPlatform_SpscRingPopWiping(hzlPlatform_SpscRing_t* const ring, uint8_t* const item)
+{
+    const uint_fast32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint_fast32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (head == tail)
+    {
+        return false;
+    }
+    volatile uint8_t* const position = &ring->items[tail & (ring->capacity - 1U)];
+    *item = *position;
+    *position = 0U;
+    // Gives the position back to the producer only after the item was read and wiped.
+    atomic_store_explicit(&ring->tail, tail + 1U, memory_order_release);
+    return true;
+}
+
+/**
+ * Amount of items currently in the ring. Exact only when called from the producer or
+ * consumer side, an estimate otherwise.
+ */
+static inline uint32_t
+hzlPlatform_SpscRingAmount(hzlPlatform_SpscRing_t* const ring)
+{
+    return (uint32_t) (atomic_load_explicit(&ring->head, memory_order_acquire)
+                       - atomic_load_explicit(&ring->tail, memory_order_acquire));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_SPSCRING_H_ */
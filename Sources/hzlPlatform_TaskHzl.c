@@ -33,7 +33,19 @@
  */
 
 #include "hzlPlatform.h"
+#include "hzlPlatform_Aggregation.h"
+#include "hzlPlatform_CanFilter.h"
+#include "hzlPlatform_CbsHeader.h"
+#include "hzlPlatform_Clock.h"
+#include "hzlPlatform_CpuStats.h"
 #include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_HandshakeBackoff.h"
+#include "hzlPlatform_LatencyHist.h"
+#include "hzlPlatform_RxPrefilter.h"
+#include "hzlPlatform_SecWarnLimiter.h"
+#include "hzlPlatform_Telemetry.h"
+#include "hzlPlatform_TrafficGen.h"
+#include "semphr.h"
 #include "hzl.h"
 #if defined(HZL_PLATFORM_ROLE_SERVER)
 #include "hzl_Server.h"
@@ -44,101 +56,338 @@
 #endif
 
 static void
-hzlPlatform_AppServerOnlyForceSessionRenewal(void);
+hzlPlatform_AppServerOnlyForceSessionRenewal(uint8_t bus);
 static void
-hzlPlatform_AppClientOnlyNewHandshake(void);
+hzlPlatform_AppClientOnlyNewHandshake(uint8_t bus);
 static void
-hzlPlatform_AppProcessReceivedValid(const hzl_CbsPduMsg_t* reactionPdu,
-                                         const hzl_RxSduMsg_t* receivedUserData);
+hzlPlatform_AppProcessReceivedValid(uint8_t bus,
+                                         const hzl_CbsPduMsg_t* reactionPdu,
+                                         const hzl_RxSduMsg_t* receivedUserData,
+                                         uint64_t rxMicros);
 
-static size_t gSuccessiveSecurityWarningsCounter = 0U;
+#if HZL_PLATFORM_BUSES_AMOUNT > 1U
+// Contexts of the other buses, provided by a configuration per bus, like hzlCtx0.
+extern HZL_PLATFORM_HZL_CTX_T hzlCtx1;
+#endif
+#if HZL_PLATFORM_BUSES_AMOUNT > 2U
+extern HZL_PLATFORM_HZL_CTX_T hzlCtx2;
+#endif
+
+/**
+ * @internal
+ * Hazelnet context of each bus: every bus is a separate CBS network with its own Server.
+ */
+static HZL_PLATFORM_HZL_CTX_T* const hzlPlatform_HzlCtxOfBus[HZL_PLATFORM_BUSES_AMOUNT] =
+{
+    &hzlCtx0,
+#if HZL_PLATFORM_BUSES_AMOUNT > 1U
+    &hzlCtx1,
+#endif
+#if HZL_PLATFORM_BUSES_AMOUNT > 2U
+    &hzlCtx2,
+#endif
+};
+
+/**
+ * @internal
+ * Name of the TaskHzl of each bus, as shown by the debugger and the CPU statistics.
+ */
+static const char* const hzlPlatform_TaskHzlNames[HZL_PLATFORM_TELEMETRY_BUSES_MAX] =
+{
+    "TaskHzl", "TaskHzl1", "TaskHzl2",
+};
+
+/**
+ * @internal
+ * TaskHzl of each bus, to forward the Button 1 power-down to the ones of the other buses.
+ */
+static TaskHandle_t hzlPlatform_TaskHzlHandles[HZL_PLATFORM_BUSES_AMOUNT];
+
+/**
+ * @internal
+ * Security warnings of each sender of each bus, see hzlPlatform_SecWarnLimiter.h.
+ */
+static hzlPlatform_SecWarnLimiter_t gSecWarnLimiters[HZL_PLATFORM_BUSES_AMOUNT];
+
+#if !defined(HZL_PLATFORM_RX_NO_PREFILTER)
+/**
+ * @internal
+ * What the frames of each bus must match to reach the Hazelnet library, see
+ * hzlPlatform_RxPrefilter.h.
+ */
+static hzlPlatform_RxPrefilter_t gRxPrefilters[HZL_PLATFORM_BUSES_AMOUNT];
+#endif
+
+#if !defined(HZL_PLATFORM_ROLE_SERVER)
+/**
+ * @internal
+ * When the pending Request of each bus was handed to the FLEXCAN driver, 0 if none is pending.
+ */
+static uint64_t gHandshakeStartMicros[HZL_PLATFORM_BUSES_AMOUNT];
+
+#if !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+/**
+ * @internal
+ * When each bus may transmit its next Request, see hzlPlatform_HandshakeBackoff.h.
+ */
+static hzlPlatform_HandshakeBackoff_t gHandshakeBackoffs[HZL_PLATFORM_BUSES_AMOUNT];
+#endif
+#endif
+
+#if !defined(HZL_PLATFORM_TASKHZL_SINGLE)
+/**
+ * @internal
+ * Decrypted application data handed over from the TaskHzl to the TaskHzlApp of the bus.
+ */
+typedef struct hzlPlatform_PipelineAppMsg
+{
+    /** Reception by the FLEXCAN interrupt, see hzlPlatform_FlexcanRxAcquiredMicros(). */
+    uint64_t rxMicros;
+    uint8_t gid;
+    uint8_t sid;
+    uint8_t dataLen;
+    uint8_t data[HZL_MAX_CAN_FD_DATA_LEN];
+} hzlPlatform_PipelineAppMsg_t;
+
+/**
+ * @internal
+ * Plaintext handed over from the TaskHzlApp to the TaskHzlTx of the bus, to secure and transmit.
+ */
+typedef struct hzlPlatform_PipelineTxMsg
+{
+    hzl_Gid_t gid;
+    uint8_t dataLen;
+    uint8_t data[HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN];
+} hzlPlatform_PipelineTxMsg_t;
 
 /**
  * @internal
- * Writes a short (<= 61 B) ASCII string to the bus in the form of a CBS UAD message, which
- * all other parties are configured to ignore.
- * @param string a human readable message.
+ * Stages of the pipeline of a bus besides its TaskHzl, and what connects them.
+ */
+typedef struct hzlPlatform_Pipeline
+{
+    /**
+     * Held by the TaskHzl and the TaskHzlTx around each use of the Hazelnet context of the bus,
+     * including the handshake and security-warning state of this file.
+     */
+    SemaphoreHandle_t hzlCtxMutex;
+    /** Decrypted data waiting for the TaskHzlApp. */
+    QueueHandle_t appQueue;
+    /** Plaintext waiting for the TaskHzlTx. */
+    QueueHandle_t txQueue;
+    TaskHandle_t taskApp;
+    TaskHandle_t taskTx;
+#if defined(HZL_PLATFORM_AGGREGATION)
+    /** Plaintext waiting in the TaskHzlTx for more messages to share its frame with. */
+    hzlPlatform_Aggregator_t aggregator;
+#endif
+} hzlPlatform_Pipeline_t;
+
+static hzlPlatform_Pipeline_t hzlPlatform_Pipelines[HZL_PLATFORM_BUSES_AMOUNT];
+
+/** @internal Name of the TaskHzlApp of each bus, like the TaskHzl ones. */
+static const char* const hzlPlatform_TaskHzlAppNames[HZL_PLATFORM_TELEMETRY_BUSES_MAX] =
+{
+    "HzlApp", "HzlApp1", "HzlApp2",
+};
+
+/** @internal Name of the TaskHzlTx of each bus, like the TaskHzl ones. */
+static const char* const hzlPlatform_TaskHzlTxNames[HZL_PLATFORM_TELEMETRY_BUSES_MAX] =
+{
+    "HzlTx", "HzlTx1", "HzlTx2",
+};
+#endif  /* !defined(HZL_PLATFORM_TASKHZL_SINGLE) */
+
+/**
+ * @internal
+ * Obtains the exclusive use of the Hazelnet context of the bus, shared by the TaskHzl and the
+ * TaskHzlTx. Does nothing with #HZL_PLATFORM_TASKHZL_SINGLE, where the TaskHzl is alone.
  */
 static void
-hzlPlatform_AppLog(const char* string)
+hzlPlatform_HzlCtxLock(const uint8_t bus)
 {
-    hzl_CbsPduMsg_t uad;
-    hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_BUILD_UNSECURED(&uad, &hzlCtx0,
-        (const uint8_t*) string, strlen(string),
-        HZL_BROADCAST_GID);
-    if (hzlErrCode != HZL_OK)
-    {
-        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_HZL_BUILD_UAD);
-    }
-    hzlPlatform_FlexcanTransmit(uad.data, uad.dataLen);
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    (void) bus;
+#else
+    (void) xSemaphoreTake(hzlPlatform_Pipelines[bus].hzlCtxMutex, portMAX_DELAY);
+#endif
 }
 
 /**
  * @internal
- * Handles the case of a valid HZL-processed (validated, decrypted) message. This includes the
- * transmission of any automatic reaction message and the handling of data that was received
- * in either secured or unsecured format.
+ * Gives the Hazelnet context obtained with hzlPlatform_HzlCtxLock() back.
+ */
+static void
+hzlPlatform_HzlCtxUnlock(const uint8_t bus)
+{
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    (void) bus;
+#else
+    (void) xSemaphoreGive(hzlPlatform_Pipelines[bus].hzlCtxMutex);
+#endif
+}
+
+/**
+ * @internal
+ * Consumes the decrypted data of a secured message, which arrived on the bus at rxMicros.
  *
  * Any real-world application should probably replace this function with the behaviour that
  * is expected of it.
  */
+static void
+hzlPlatform_AppConsume(const uint8_t bus,
+                       const uint8_t gid,
+                       const uint8_t sid,
+                       const uint8_t* const data,
+                       const uint64_t rxMicros)
+{
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_DECRYPTED);
+    // In the case of this demo, the message contains simply an encrypted uint8_t counter padded to
+    // 16 bytes to provide more noise to any attacker. For the sake of demonstration, the counter is
+    // now transmitted again in plaintext on the bus for the human operator to see, as a binary log
+    // event (4 bytes) the host decoder formats into text. This essentially proves that the
+    // receiving party has successfully received and decrypted the secured message.
+    const uint8_t args[3U] =
+    {
+        gid,
+        sid,
+        data[0],  // The decrypted counter
+    };
+    hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_RX_SECRET_COUNTER, args);
+    const uint32_t latencyMicros = (uint32_t) (hzlPlatform_ClockMicros() - rxMicros);
+    telemetry->appMessagesConsumed++;
+    telemetry->appLatencySumMicros += latencyMicros;
+    if (latencyMicros > telemetry->appLatencyMaxMicros)
+    {
+        telemetry->appLatencyMaxMicros = latencyMicros;
+    }
+}
+
 /**
  * @internal
  * Handles the case of a security problem in the received message.
  *
- * Simply converts the error code into a small ASCII string and logs it onto the bus.
+ * Converts the error code into a log event and logs it onto the bus. The warnings hinting at a
+ * desynchronised Session (invalid tag, old or overflown counter nonce) are accounted per CAN ID:
+ * too many of them from the same sender resynchronise the bus, at most once per
+ * #HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS. The other ones are misbehaving or misdirected
+ * frames, which a new Session would not fix.
  */
 static void
-hzlPlatform_AppProcessReceivedSecWarn(const hzl_Err_t hzlErrCode)
+hzlPlatform_AppProcessReceivedSecWarn(const uint8_t bus,
+                                      const hzl_Err_t hzlErrCode,
+                                      const uint32_t canId)
 {
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
     hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_RX_SECURITY_WARNING);
-    gSuccessiveSecurityWarningsCounter++;
-    const char* msg = "";
+    hzlPlatform_TelemetrySecWarn_t warnClass;
+    hzlPlatform_LogEvent_t event;
+    bool isDesync = false;
     switch (hzlErrCode)
     {
         case HZL_ERR_SECWARN_INVALID_TAG:
-            msg = "WARN: invalid tag";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_INVALID_TAG;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_INVALID_TAG;
+            isDesync = true;
             break;
         case HZL_ERR_SECWARN_MESSAGE_FROM_MYSELF:
-            msg = "WARN: message from myself";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_MESSAGE_FROM_MYSELF;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_MESSAGE_FROM_MYSELF;
             break;
         case HZL_ERR_SECWARN_NOT_EXPECTING_A_RESPONSE:
-            msg = "WARN: not expecting RES";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_NOT_EXPECTING_A_RESPONSE;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_NOT_EXPECTING_A_RESPONSE;
             break;
         case HZL_ERR_SECWARN_SERVER_ONLY_MESSAGE:
-            msg = "WARN: server-only message";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_SERVER_ONLY_MESSAGE;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_SERVER_ONLY_MESSAGE;
             break;
         case HZL_ERR_SECWARN_RESPONSE_TIMEOUT:
-            msg = "WARN: RES too late (timeout REQ-to-RES)";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_RESPONSE_TIMEOUT;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_RESPONSE_TIMEOUT;
             break;
         case HZL_ERR_SECWARN_OLD_MESSAGE:
-            msg = "WARN: old counter nonce";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_OLD_MESSAGE;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_OLD_MESSAGE;
+            isDesync = true;
             break;
         case HZL_ERR_SECWARN_DENIAL_OF_SERVICE:
-            msg = "WARN: denial of service";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_DENIAL_OF_SERVICE;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_DENIAL_OF_SERVICE;
             break;
         case HZL_ERR_SECWARN_NOT_IN_GROUP:
-            msg = "WARN: Client not in REQ Group";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_NOT_IN_GROUP;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_NOT_IN_GROUP;
             break;
         case HZL_ERR_SECWARN_RECEIVED_OVERFLOWN_NONCE:
-            msg = "WARN: RX overflown counter nonce";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_RECEIVED_OVERFLOWN_NONCE;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_RECEIVED_OVERFLOWN_NONCE;
+            isDesync = true;
             break;
         case HZL_ERR_SECWARN_RECEIVED_ZERO_KEY:
-            msg = "WARN: RX all-zero key";
+            warnClass = HZL_PLATFORM_TELEMETRY_SECWARN_RECEIVED_ZERO_KEY;
+            event = HZL_PLATFORM_LOG_EVENT_SECWARN_RECEIVED_ZERO_KEY;
             break;
         default:
-            // Not a security warning error code.
+            // Security warning unknown to this version of the platform.
+            telemetry->rxSecWarnings[HZL_PLATFORM_TELEMETRY_SECWARN_OTHER]++;
             return;
     }
-    hzlPlatform_AppLog(msg);
-    if (gSuccessiveSecurityWarningsCounter
-        > HZL_PLATFORM_HZL_MAX_SECURITY_WARNINGS_BEFORE_REQ)
+    telemetry->rxSecWarnings[warnClass]++;
+    hzlPlatform_LogEvent(event, NULL);
+    if (!isDesync)
+    {
+        return;
+    }
+    const hzlPlatform_SecWarnVerdict_t verdict = hzlPlatform_SecWarnLimiterWarned(
+        &gSecWarnLimiters[bus], canId, hzlPlatform_ClockMicros());
+    if (verdict == HZL_PLATFORM_SECWARN_VERDICT_RESYNC)
+    {
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_TOO_MANY_SECWARNINGS, NULL);
+        telemetry->secWarnResyncs++;
+        hzlPlatform_AppClientOnlyNewHandshake(bus);
+        hzlPlatform_AppServerOnlyForceSessionRenewal(bus);
+    }
+    else if (verdict == HZL_PLATFORM_SECWARN_VERDICT_HELD_OFF)
+    {
+        telemetry->secWarnResyncsHeldOff++;
+    }
+}
+
+/**
+ * @internal
+ * Accounts the duration of the pending handshake, if the successfully processed message is the
+ * Response to it.
+ */
+static void
+hzlPlatform_AppClientOnlyHandshakeCompleted(const uint8_t bus,
+                                            const flexcan_msgbuff_t* const processedCanFdMsg)
+{
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+    (void) bus;
+    (void) processedCanFdMsg;
+#else
+    if (gHandshakeStartMicros[bus] == 0U
+        || hzlPlatform_CbsPty(processedCanFdMsg->data, processedCanFdMsg->dataLen)
+           != HZL_PLATFORM_CBS_PTY_RES)
+    {
+        return;
+    }
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    const uint32_t durationMicros =
+        (uint32_t) (hzlPlatform_ClockMicros() - gHandshakeStartMicros[bus]);
+    gHandshakeStartMicros[bus] = 0U;
+#if !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+    hzlPlatform_HandshakeBackoffCompleted(&gHandshakeBackoffs[bus]);
+#endif
+    telemetry->handshakesCompleted++;
+    telemetry->handshakeSumMicros += durationMicros;
+    if (durationMicros > telemetry->handshakeMaxMicros)
     {
-        hzlPlatform_AppLog("INFO: too many secwarnings");
-        gSuccessiveSecurityWarningsCounter = 0U;
-        hzlPlatform_AppClientOnlyNewHandshake();
-        hzlPlatform_AppServerOnlyForceSessionRenewal();
+        telemetry->handshakeMaxMicros = durationMicros;
     }
+#endif  /* defined(HZL_PLATFORM_ROLE_SERVER) */
 }
 
 /**
@@ -150,26 +399,62 @@ hzlPlatform_AppProcessReceivedSecWarn(const hzl_Err_t hzlErrCode)
  * unencrypted messages from the bus are ignored.
  */
 static void
-hzlPlatform_AppProcessReceived(const flexcan_msgbuff_t* const poppedCanFdMsg)
+hzlPlatform_AppProcessReceived(const uint8_t bus, const flexcan_msgbuff_t* const poppedCanFdMsg)
 {
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+#if !defined(HZL_PLATFORM_RX_NO_PREFILTER)
+    hzlPlatform_TelemetryPrefilter_t reason;
+    if (!hzlPlatform_RxPrefilterAccepts(&gRxPrefilters[bus], poppedCanFdMsg->msgId,
+                                        poppedCanFdMsg->data, poppedCanFdMsg->dataLen, &reason))
+    {
+        telemetry->rxFramesPrefiltered[reason]++;
+        if (hzlPlatform_CbsIsSecured(poppedCanFdMsg->data, poppedCanFdMsg->dataLen))
+        {
+            telemetry->rxAeadVerificationsSaved++;
+        }
+        return;
+    }
+#endif
     hzl_CbsPduMsg_t reactionPdu;
     hzl_RxSduMsg_t receivedUserData;
+    HZL_PLATFORM_LATENCY_HIST_START(startCycles);
     hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_PROCESS_RECEIVED(
         &reactionPdu,
         &receivedUserData,
-        &hzlCtx0,
+        hzlPlatform_HzlCtxOfBus[bus],
         poppedCanFdMsg->data,
         poppedCanFdMsg->dataLen,
         poppedCanFdMsg->msgId);
+    HZL_PLATFORM_LATENCY_HIST_STOP(HZL_PLATFORM_LATENCY_HIST_OP_PROCESS_RECEIVED, startCycles);
+    telemetry->rxFramesProcessed++;
+    if (hzlPlatform_CbsIsSecured(poppedCanFdMsg->data, poppedCanFdMsg->dataLen))
+    {
+        telemetry->rxSecuredFramesProcessed++;
+        if (hzlErrCode == HZL_OK && receivedUserData.wasSecured)
+        {
+            telemetry->rxSecuredFramesDecrypted++;
+            telemetry->rxSecuredPlaintextBytes += (uint32_t) receivedUserData.dataLen;
+        }
+    }
     if (hzlErrCode == HZL_OK)
     {
         // Successful validation and potential decrpytion of the message.
-        hzlPlatform_AppProcessReceivedValid(&reactionPdu, &receivedUserData);
+        if (receivedUserData.wasSecured
+            || hzlPlatform_CbsIsControl(poppedCanFdMsg->data, poppedCanFdMsg->dataLen))
+        {
+            // Only an authenticated frame proves the Session of the sender works: anyone can
+            // transmit an unsecured one with its CAN ID.
+            hzlPlatform_SecWarnLimiterValidated(&gSecWarnLimiters[bus], poppedCanFdMsg->msgId);
+        }
+        hzlPlatform_AppClientOnlyHandshakeCompleted(bus, poppedCanFdMsg);
+        hzlPlatform_AppProcessReceivedValid(bus, &reactionPdu, &receivedUserData,
+            hzlPlatform_FlexcanRxAcquiredMicros(bus));
     }
     else if (hzlErrCode == HZL_ERR_MSG_IGNORED)
     {
         // The message was successfully processed, only it is not addressed to this party
         // or not of interest in the current state.
+        telemetry->rxFramesIgnored++;
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_IGNORED);
     }
     else if (hzlErrCode == HZL_ERR_SESSION_NOT_ESTABLISHED)
@@ -179,22 +464,60 @@ hzlPlatform_AppProcessReceived(const flexcan_msgbuff_t* const poppedCanFdMsg)
         // (Re)send a Request message to obtain the session information instead.
         // Discard the received message.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_RES);
-        hzlPlatform_AppLog("INFO: Session not established, cannot RX yet");
-        hzlPlatform_AppClientOnlyNewHandshake();
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_SESSION_NOT_ESTABLISHED, NULL);
+        hzlPlatform_AppClientOnlyNewHandshake(bus);
     }
     else if (HZL_IS_SECURITY_WARNING(hzlErrCode))
     {
         // The message was not successfully processed, as a security problem was detected with it.
-        hzlPlatform_AppProcessReceivedSecWarn(hzlErrCode);
+        hzlPlatform_AppProcessReceivedSecWarn(bus, hzlErrCode, poppedCanFdMsg->msgId);
     }
     else
     {
         // All other problems, which should all be issues in at program-time (e.g. using too small
         // buffers) but not at run-time.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_PROCESS_RX_OTHER);
-        hzlPlatform_AppLog("ERROR: unexpected problem with process RX");
+        const uint8_t errCode = (uint8_t) hzlErrCode;
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_PROCESS_RX_ERROR, &errCode);
+    }
+}
+
+#if !defined(HZL_PLATFORM_ROLE_SERVER) && !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+/**
+ * @internal
+ * 32 random bits for the jitter of the Requests, 0 (no jitter) if the CSEc fails.
+ */
+static uint32_t
+hzlPlatform_AppClientOnlyRandom(void)
+{
+    uint8_t bytes[sizeof(uint32_t)];
+    if (!hzlPlatform_EntropyGet(bytes, sizeof(bytes)))
+    {
+        return 0U;
+    }
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8U) | ((uint32_t) bytes[2] << 16U)
+           | ((uint32_t) bytes[3] << 24U);
+}
+
+/**
+ * @internal
+ * Leaves the Request of the bus to the TaskHzl, which transmits it once due, see
+ * hzlPlatform_AppClientOnlyHandshakeWaitTicks.
+ */
+static void
+hzlPlatform_AppClientOnlyHandshakeDefer(const uint8_t bus)
+{
+    if (!gHandshakeBackoffs[bus].isDeferred)
+    {
+        gHandshakeBackoffs[bus].isDeferred = true;
+        hzlPlatform_Telemetry.buses[bus].handshakeRequestsDeferred++;
+        // Maybe called by another task of the pipeline: let the TaskHzl know when to wake up.
+        hzlPlatform_TelemetryEventRaised(bus, HZL_PLATFORM_TASK_EVENT_HANDSHAKE_DEFERRED);
+        xTaskNotify(hzlPlatform_TaskHzlHandles[bus], HZL_PLATFORM_TASK_EVENT_HANDSHAKE_DEFERRED,
+            eSetBits);
     }
 }
+#endif
 
 /**
  * @internal
@@ -204,23 +527,54 @@ hzlPlatform_AppProcessReceived(const flexcan_msgbuff_t* const poppedCanFdMsg)
  * again.
  */
 static void
-hzlPlatform_AppClientOnlyNewHandshake(void)
+hzlPlatform_AppClientOnlyNewHandshake(const uint8_t bus)
 {
-#if !defined(HZL_PLATFORM_ROLE_SERVER)
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+    (void) bus;
+#else
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
     hzl_CbsPduMsg_t pdu;
     hzl_Err_t hzlErrCode;
+#if !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+    hzlPlatform_HandshakeBackoff_t* const backoff = &gHandshakeBackoffs[bus];
+    if (!hzlPlatform_HandshakeBackoffIsDue(backoff, hzlPlatform_ClockMicros()))
+    {
+        hzlPlatform_AppClientOnlyHandshakeDefer(bus);
+        return;
+    }
+    backoff->isDeferred = false;
+#endif
     // On the Client
-    hzlErrCode = hzl_ClientBuildRequest(&pdu, &hzlCtx0, HZL_BROADCAST_GID);
+    HZL_PLATFORM_LATENCY_HIST_START(startCycles);
+    hzlErrCode = hzl_ClientBuildRequest(&pdu, hzlPlatform_HzlCtxOfBus[bus], HZL_BROADCAST_GID);
+    HZL_PLATFORM_LATENCY_HIST_STOP(HZL_PLATFORM_LATENCY_HIST_OP_CLIENT_BUILD_REQUEST, startCycles);
     if (hzlErrCode == HZL_OK)
     {
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_RES);
-        hzlPlatform_FlexcanTransmit(pdu.data, pdu.dataLen);
+        hzlPlatform_FlexcanTransmit(bus, pdu.data, pdu.dataLen);
+        gHandshakeStartMicros[bus] = hzlPlatform_ClockMicros();
+        telemetry->handshakeRequestsSent++;
+#if !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+        hzlPlatform_HandshakeBackoffSent(backoff, gHandshakeStartMicros[bus],
+            hzlPlatform_AppClientOnlyRandom());
+#endif
     }
     else if (hzlErrCode == HZL_ERR_HANDSHAKE_ONGOING)
     {
         // The previously transmitted Request did not timeout yet. Not transmitting anything.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_RES);
-        hzlPlatform_AppLog("INFO: Not requesting yet, still waiting for RES");
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_WAITING_FOR_RES, NULL);
+#if !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+        // Jittered to before the timeout: retried once it elapsed instead of being lost. Hazelnet
+        // counts it in milliseconds, so it may take one more.
+        const uint64_t nowMicros = hzlPlatform_ClockMicros();
+        backoff->notBeforeMicros = gHandshakeStartMicros[bus] + backoff->capMicros;
+        if (backoff->notBeforeMicros <= nowMicros)
+        {
+            backoff->notBeforeMicros = nowMicros + 1000U;
+        }
+        hzlPlatform_AppClientOnlyHandshakeDefer(bus);
+#endif
     }
     else
     {
@@ -229,29 +583,96 @@ hzlPlatform_AppClientOnlyNewHandshake(void)
 #endif  /* defined(HZL_PLATFORM_ROLE_SERVER) */
 }
 
+/**
+ * @internal
+ * Ticks the TaskHzl may sleep before the deferred Request of the bus is due, rounded up: forever
+ * if none is deferred.
+ */
+static TickType_t
+hzlPlatform_AppClientOnlyHandshakeWaitTicks(const uint8_t bus)
+{
+#if defined(HZL_PLATFORM_ROLE_SERVER) || defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+    (void) bus;
+    return portMAX_DELAY;
+#else
+    // Called at every wake-up: nearly never deferred, so checked without the lock first. A single
+    // byte, read atomically; a deferral raced with is notified with
+    // HZL_PLATFORM_TASK_EVENT_HANDSHAKE_DEFERRED anyway.
+    if (!gHandshakeBackoffs[bus].isDeferred)
+    {
+        return portMAX_DELAY;
+    }
+    // Written by the TaskHzlTx too and 64 bits wide: read under the lock.
+    hzlPlatform_HzlCtxLock(bus);
+    const bool isDeferred = gHandshakeBackoffs[bus].isDeferred;
+    const uint64_t deadlineMicros = gHandshakeBackoffs[bus].notBeforeMicros;
+    hzlPlatform_HzlCtxUnlock(bus);
+    const uint64_t nowMicros = hzlPlatform_ClockMicros();
+    if (!isDeferred)
+    {
+        return portMAX_DELAY;
+    }
+    if (deadlineMicros <= nowMicros)
+    {
+        return 0U;
+    }
+    const uint64_t tickMicros = 1000000U / configTICK_RATE_HZ;
+    return (TickType_t) ((deadlineMicros - nowMicros + tickMicros - 1U) / tickMicros);
+#endif
+}
+
+/**
+ * @internal
+ * Transmits the deferred Request of the bus, if any and due.
+ */
+static void
+hzlPlatform_AppClientOnlyHandshakeDeferredTransmit(const uint8_t bus)
+{
+#if defined(HZL_PLATFORM_ROLE_SERVER) || defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+    (void) bus;
+#else
+    // Same lock-free check as in hzlPlatform_AppClientOnlyHandshakeWaitTicks.
+    if (!gHandshakeBackoffs[bus].isDeferred)
+    {
+        return;
+    }
+    hzlPlatform_HzlCtxLock(bus);
+    if (gHandshakeBackoffs[bus].isDeferred
+        && hzlPlatform_HandshakeBackoffIsDue(&gHandshakeBackoffs[bus], hzlPlatform_ClockMicros()))
+    {
+        hzlPlatform_AppClientOnlyNewHandshake(bus);
+    }
+    hzlPlatform_HzlCtxUnlock(bus);
+#endif
+}
+
 /**
  * @internal
  * Starts a new Session on the Server and transmits the Renewal notification.
  */
 static void
-hzlPlatform_AppServerOnlyForceSessionRenewal(void)
+hzlPlatform_AppServerOnlyForceSessionRenewal(const uint8_t bus)
 {
-#if defined(HZL_PLATFORM_ROLE_SERVER)
+#if !defined(HZL_PLATFORM_ROLE_SERVER)
+    (void) bus;
+#else
     hzl_CbsPduMsg_t pdu;
     hzl_Err_t hzlErrCode;
     // On the Server
-    hzlErrCode = hzl_ServerForceSessionRenewal(&pdu, &hzlCtx0, HZL_BROADCAST_GID);
+    hzlErrCode = hzl_ServerForceSessionRenewal(&pdu,
+        hzlPlatform_HzlCtxOfBus[bus],
+        HZL_BROADCAST_GID);
     if (hzlErrCode == HZL_OK)
     {
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_REQ);
-        hzlPlatform_FlexcanTransmit(pdu.data, pdu.dataLen);
+        hzlPlatform_FlexcanTransmit(bus, pdu.data, pdu.dataLen);
     }
     else if (hzlErrCode == HZL_ERR_NO_POTENTIAL_RECEIVER)
     {
         // REN message construction called to early: no Clients can be notified yet of the renewal
         // as no Client has the previous Session information. Nothing to transmit
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_NO_CLIENTS_YET);
-        hzlPlatform_AppLog("INFO: No Clients to send REN to");
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_NO_CLIENTS_FOR_REN, NULL);
     }
     else
     {
@@ -263,27 +684,27 @@ hzlPlatform_AppServerOnlyForceSessionRenewal(void)
 
 /**
  * @internal
- * Transmission in secured format of a dummy uint8_t rolling counter, padded to 128 bits.
- *
- * The padding is done to make brute-forcing through all ciphertexts harder.
+ * Transmission of the given plaintext in secured format to the given Group.
  */
 static void
-hzlPlatform_AppTransmitDummyMsg(uint8_t dummyTxMsgContent)
+hzlPlatform_AppTransmitSecured(const uint8_t bus,
+                               const uint8_t* const data,
+                               const size_t dataLen,
+                               const hzl_Gid_t gid)
 {
     hzl_CbsPduMsg_t pdu;
-    uint8_t txDataBuffer[16];
-    memset(txDataBuffer, 0x55U, sizeof(txDataBuffer));  // Dummy padding value: 0b01010101
-    txDataBuffer[0] = dummyTxMsgContent;  // Our actual plaintext is just 1 byte
+    HZL_PLATFORM_LATENCY_HIST_START(startCycles);
     hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_BUILD_SECURED_FD(
         &pdu,
-        &hzlCtx0,
-        txDataBuffer,
-        sizeof(txDataBuffer),
-        HZL_BROADCAST_GID);
+        hzlPlatform_HzlCtxOfBus[bus],
+        data,
+        dataLen,
+        gid);
+    HZL_PLATFORM_LATENCY_HIST_STOP(HZL_PLATFORM_LATENCY_HIST_OP_BUILD_SECURED_FD, startCycles);
     if (hzlErrCode == HZL_OK)
     {
         // Successful securing: just transmit the message.
-        hzlPlatform_FlexcanTransmit(pdu.data, pdu.dataLen);
+        hzlPlatform_FlexcanTransmit(bus, pdu.data, pdu.dataLen);
     }
     else if (hzlErrCode == HZL_ERR_NO_POTENTIAL_RECEIVER)
     {
@@ -291,13 +712,13 @@ hzlPlatform_AppTransmitDummyMsg(uint8_t dummyTxMsgContent)
         // message. Otherwise it does not make any sense for the Server to transmit secured messages
         // as nobody else could decrypt them.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_NO_CLIENTS_YET);
-        hzlPlatform_AppLog("INFO: Cannot TX yet, no REQ so far");
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_CANNOT_TX_NO_REQ, NULL);
     }
     else if (hzlErrCode == HZL_ERR_SESSION_NOT_ESTABLISHED)
     {
         // Client-side error only: the transmission cannot happen, as there is no session
         // information that could be used to transmit the data securely.
-        hzlPlatform_AppClientOnlyNewHandshake();
+        hzlPlatform_AppClientOnlyNewHandshake(bus);
     }
     else if (hzlErrCode == HZL_ERR_HANDSHAKE_ONGOING)
     {
@@ -305,27 +726,346 @@ hzlPlatform_AppTransmitDummyMsg(uint8_t dummyTxMsgContent)
         // for our Request (REQ). The transmission cannot happen, as there is no session
         // information that could be used to transmit the data securely.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_RES);
-        hzlPlatform_AppLog("INFO: Cannot TX yet, no RES yet");
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_CANNOT_TX_NO_RES, NULL);
     }
     else
     {
         // All other problems, which should all be issues in at program-time (e.g. using too small
         // buffers) but not at run-time.
         hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_BUILD_OTHER);
-        hzlPlatform_AppLog("ERRO: problem with building SADFD");
+        const uint8_t errCode = (uint8_t) hzlErrCode;
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_BUILD_SADFD_ERROR, &errCode);
     }
 }
 
+#if !defined(HZL_PLATFORM_TASKHZL_SINGLE)
 /**
  * @internal
- * Main application task initialisation phase.
- * Enable the hardware components, OS components and libraries required for the application to run.
- * Returns the reception queue of incoming CAN FD messages.
+ * Hands the plaintext over to the TaskHzlTx of the bus, discarding it if its queue is full.
+ *
+ * @param dataLen at most #HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN
  */
-static QueueHandle_t
-hzlPlatform_TaskHzlInit(void)
+static void
+hzlPlatform_PipelineToTx(const uint8_t bus,
+                         const uint8_t* const data,
+                         const size_t dataLen,
+                         const hzl_Gid_t gid)
 {
-    QueueHandle_t rxCanMsgsQueue = hzlPlatform_FlexcanInit();
+    hzlPlatform_PipelineTxMsg_t msg;
+    msg.gid = gid;
+    msg.dataLen = (uint8_t) dataLen;
+    memcpy(msg.data, data, dataLen);
+    if (xQueueSendToBack(hzlPlatform_Pipelines[bus].txQueue, &msg, 0U) != pdPASS)
+    {
+        hzlPlatform_Telemetry.buses[bus].pipelineTxQueueFull++;
+    }
+}
+
+/**
+ * @internal
+ * Copies the decrypted data out of the RX slot, which is released right after, into the queue
+ * of the TaskHzlApp of the bus and notifies it. Discards the data if the queue is full, so the
+ * verification of the next frames never waits for the application.
+ */
+static void
+hzlPlatform_PipelineToApp(const uint8_t bus,
+                          const uint8_t gid,
+                          const uint8_t sid,
+                          const uint8_t* const data,
+                          const size_t dataLen,
+                          const uint64_t rxMicros)
+{
+    hzlPlatform_Pipeline_t* const pipeline = &hzlPlatform_Pipelines[bus];
+    hzlPlatform_PipelineAppMsg_t msg;
+    msg.rxMicros = rxMicros;
+    msg.gid = gid;
+    msg.sid = sid;
+    // The plaintext is shorter than the CAN FD frame it came in.
+    msg.dataLen = (uint8_t) dataLen;
+    memcpy(msg.data, data, msg.dataLen);
+    if (xQueueSendToBack(pipeline->appQueue, &msg, 0U) != pdPASS)
+    {
+        hzlPlatform_Telemetry.buses[bus].pipelineAppQueueFull++;
+        return;
+    }
+    xTaskNotify(pipeline->taskApp, HZL_PLATFORM_TASK_EVENT_APP_RX, eSetBits);
+}
+#endif  /* !defined(HZL_PLATFORM_TASKHZL_SINGLE) */
+
+/**
+ * @internal
+ * Hands one decrypted message over to the application: to the TaskHzlApp of the bus or, with
+ * #HZL_PLATFORM_TASKHZL_SINGLE, consumes it right away.
+ */
+static void
+hzlPlatform_AppDeliver(const uint8_t bus,
+                       const uint8_t gid,
+                       const uint8_t sid,
+                       const uint8_t* const data,
+                       const size_t dataLen,
+                       const uint64_t rxMicros)
+{
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    (void) dataLen;
+    hzlPlatform_AppConsume(bus, gid, sid, data, rxMicros);
+#else
+    hzlPlatform_PipelineToApp(bus, gid, sid, data, dataLen, rxMicros);
+#endif
+}
+
+/**
+ * @internal
+ * Transmission in secured format of the burst of dummy messages of this TX timer expiration:
+ * a uint8_t rolling counter, by default padded to 128 bits, see hzlPlatform_TrafficGen.h.
+ *
+ * The padding is done to make brute-forcing through all ciphertexts harder.
+ */
+static void
+hzlPlatform_AppTransmitTraffic(const uint8_t bus, hzlPlatform_TrafficGen_t* const gen)
+{
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    uint8_t txDataBuffer[HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN];
+    hzl_Gid_t gid;
+    const uint32_t burstLen = hzlPlatform_TrafficGenBurstLen(gen);
+    for (uint32_t i = 0U; i < burstLen; i++)
+    {
+        const size_t dataLen = hzlPlatform_TrafficGenNext(gen, txDataBuffer, &gid);
+        telemetry->trafficMessagesGenerated++;
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+        hzlPlatform_AppTransmitSecured(bus, txDataBuffer, dataLen, gid);
+#else
+        hzlPlatform_PipelineToTx(bus, txDataBuffer, dataLen, gid);
+#endif
+    }
+}
+
+/**
+ * @internal
+ * Resets the traffic generator of the bus, each node and bus with its own length sequence.
+ */
+static void
+hzlPlatform_AppTrafficInit(const uint8_t bus, hzlPlatform_TrafficGen_t* const gen)
+{
+    hzlPlatform_TrafficGenInit(gen, HZL_PLATFORM_COUNTER_START,
+        ((uint32_t) HZL_PLATFORM_CANID_FROM_ME << 8U) | bus);
+}
+
+#if !defined(HZL_PLATFORM_TASKHZL_SINGLE)
+#if defined(HZL_PLATFORM_AGGREGATION)
+/**
+ * @internal
+ * Secures and transmits the records of the batch as one frame and frees it.
+ * Called with the Hazelnet context held.
+ */
+static void
+hzlPlatform_AggregateTransmit(const uint8_t bus, hzlPlatform_AggBatch_t* const batch)
+{
+    volatile hzlPlatform_TelemetryBus_t* const telemetry = &hzlPlatform_Telemetry.buses[bus];
+    hzlPlatform_AppTransmitSecured(bus, batch->data, batch->len, batch->gid);
+    telemetry->txMessagesAggregated += batch->messages;
+    telemetry->txAggregatesSecured++;
+    batch->messages = 0U;
+}
+
+/**
+ * @internal
+ * Appends the plaintext to the batch of its Group, transmitting first the batch it does not fit
+ * into and right after the batch it fills up. Called with the Hazelnet context held.
+ */
+static void
+hzlPlatform_AggregateAppend(const uint8_t bus, const hzlPlatform_PipelineTxMsg_t* const msg)
+{
+    hzlPlatform_Aggregator_t* const agg = &hzlPlatform_Pipelines[bus].aggregator;
+    hzlPlatform_AggBatch_t* batch = hzlPlatform_AggregatorBatchOf(agg, msg->gid);
+    if (!hzlPlatform_AggBatchFits(batch, msg->gid, msg->dataLen))
+    {
+        hzlPlatform_AggregateTransmit(bus, batch);
+    }
+    hzlPlatform_AggBatchAppend(batch, msg->gid, msg->data, msg->dataLen,
+        hzlPlatform_ClockMicros() + HZL_PLATFORM_AGGREGATION_BUDGET_MICROS);
+    if (hzlPlatform_AggBatchIsFull(batch))
+    {
+        hzlPlatform_AggregateTransmit(bus, batch);
+    }
+}
+
+/**
+ * @internal
+ * Transmits the batches whose oldest message used up its latency budget.
+ * Called with the Hazelnet context held.
+ */
+static void
+hzlPlatform_AggregateTransmitDue(const uint8_t bus)
+{
+    hzlPlatform_Aggregator_t* const agg = &hzlPlatform_Pipelines[bus].aggregator;
+    const uint64_t nowMicros = hzlPlatform_ClockMicros();
+    for (size_t i = 0U; i < HZL_PLATFORM_AGGREGATION_BATCHES; i++)
+    {
+        hzlPlatform_AggBatch_t* const batch = &agg->batches[i];
+        if (batch->messages > 0U && batch->deadlineMicros <= nowMicros)
+        {
+            hzlPlatform_AggregateTransmit(bus, batch);
+        }
+    }
+}
+
+/**
+ * @internal
+ * Ticks the TaskHzlTx may wait for a new plaintext before the first batch is due, rounded up:
+ * forever if no batch is open.
+ */
+static TickType_t
+hzlPlatform_AggregateWaitTicks(const uint8_t bus)
+{
+    const uint64_t deadlineMicros =
+        hzlPlatform_AggregatorNextDeadline(&hzlPlatform_Pipelines[bus].aggregator);
+    const uint64_t nowMicros = hzlPlatform_ClockMicros();
+    if (deadlineMicros == UINT64_MAX)
+    {
+        return portMAX_DELAY;
+    }
+    if (deadlineMicros <= nowMicros)
+    {
+        return 0U;
+    }
+    const uint64_t tickMicros = 1000000U / configTICK_RATE_HZ;
+    return (TickType_t) ((deadlineMicros - nowMicros + tickMicros - 1U) / tickMicros);
+}
+#endif  /* defined(HZL_PLATFORM_AGGREGATION) */
+
+/**
+ * @internal
+ * TX-securing stage of the pipeline of a bus: secures the plaintext handed over by the
+ * TaskHzlApp and hands it to the FLEXCAN driver. Holds the Hazelnet context for one message at a
+ * time, so the TaskHzl can verify the received frames in between.
+ *
+ * With #HZL_PLATFORM_AGGREGATION the plaintexts are batched per Group instead, and each batch is
+ * secured once full or at the end of its latency budget.
+ */
+static void
+hzlPlatform_TaskHzlTx(void* const busIdx)
+{
+    const uint8_t bus = (uint8_t) (uintptr_t) busIdx;
+    hzlPlatform_PipelineTxMsg_t msg;
+    while (true)
+    {
+#if defined(HZL_PLATFORM_AGGREGATION)
+        const bool isReceived = xQueueReceive(hzlPlatform_Pipelines[bus].txQueue, &msg,
+            hzlPlatform_AggregateWaitTicks(bus)) == pdPASS;
+        hzlPlatform_HzlCtxLock(bus);
+        if (isReceived)
+        {
+            hzlPlatform_AggregateAppend(bus, &msg);
+        }
+        hzlPlatform_AggregateTransmitDue(bus);
+        hzlPlatform_HzlCtxUnlock(bus);
+#else
+        (void) xQueueReceive(hzlPlatform_Pipelines[bus].txQueue, &msg, portMAX_DELAY);
+        hzlPlatform_HzlCtxLock(bus);
+        hzlPlatform_AppTransmitSecured(bus, msg.data, msg.dataLen, msg.gid);
+        hzlPlatform_HzlCtxUnlock(bus);
+#endif
+    }
+}
+
+/**
+ * @internal
+ * Application stage of the pipeline of a bus: consumes the decrypted data handed over by the
+ * TaskHzl and produces the dummy plaintext for the TaskHzlTx upon every TX timer expiration.
+ * Never uses the Hazelnet context.
+ */
+static void
+hzlPlatform_TaskHzlApp(void* const busIdx)
+{
+    const uint8_t bus = (uint8_t) (uintptr_t) busIdx;
+    hzlPlatform_TrafficGen_t trafficGen;
+    hzlPlatform_AppTrafficInit(bus, &trafficGen);
+    hzlPlatform_PipelineAppMsg_t msg;
+    while (true)
+    {
+        uint32_t notificationEventBitmap = HZL_PLATFORM_TASK_EVENT_NONE;
+        xTaskNotifyWait(
+            0U,  // Do not clear any bits on entry.
+            UINT32_MAX,  // Clear notification event bitmap value on exit.
+            &notificationEventBitmap,
+            portMAX_DELAY);
+        hzlPlatform_TelemetryEventHandled(bus, notificationEventBitmap);
+        if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_APP_RX)
+        {
+            // Each message notifies this task after being queued, so draining the queue may
+            // leave a notification for an already consumed message: harmless.
+            while (xQueueReceive(hzlPlatform_Pipelines[bus].appQueue, &msg, 0U) == pdPASS)
+            {
+                hzlPlatform_AppConsume(bus, msg.gid, msg.sid, msg.data, msg.rxMicros);
+            }
+        }
+        if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED)
+        {
+            hzlPlatform_AppTransmitTraffic(bus, &trafficGen);
+        }
+    }
+}
+#endif  /* !defined(HZL_PLATFORM_TASKHZL_SINGLE) */
+
+/**
+ * @internal
+ * Creates the mutex, queues and the other tasks of the pipeline of the bus, once its Hazelnet
+ * context is initialised.
+ *
+ * @return the task producing the dummy messages, to notify of the TX timer expirations: the
+ *         TaskHzlApp or, with #HZL_PLATFORM_TASKHZL_SINGLE, the calling TaskHzl.
+ */
+static TaskHandle_t
+hzlPlatform_PipelineInit(const uint8_t bus)
+{
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    (void) bus;
+    return xTaskGetCurrentTaskHandle();
+#else
+    hzlPlatform_Pipeline_t* const pipeline = &hzlPlatform_Pipelines[bus];
+    pipeline->hzlCtxMutex = xSemaphoreCreateMutex();
+    pipeline->appQueue = xQueueCreate(HZL_PLATFORM_PIPELINE_APP_QUEUE_LEN,
+        sizeof(hzlPlatform_PipelineAppMsg_t));
+    pipeline->txQueue = xQueueCreate(HZL_PLATFORM_PIPELINE_TX_QUEUE_LEN,
+        sizeof(hzlPlatform_PipelineTxMsg_t));
+    if (pipeline->hzlCtxMutex == NULL || pipeline->appQueue == NULL || pipeline->txQueue == NULL)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_OUT_OF_MEMORY);
+    }
+#if defined(HZL_PLATFORM_AGGREGATION)
+    hzlPlatform_AggregatorInit(&pipeline->aggregator);
+#endif
+    const BaseType_t appCreated = xTaskCreate(
+        hzlPlatform_TaskHzlApp,
+        hzlPlatform_TaskHzlAppNames[bus],
+        HZL_PLATFORM_TASK_STACK_WORDS_HZL_APP,
+        (void*) (uintptr_t) bus,
+        HZL_PLATFORM_TASK_PRIORITY_HZL_APP,
+        &pipeline->taskApp);
+    const BaseType_t txCreated = xTaskCreate(
+        hzlPlatform_TaskHzlTx,
+        hzlPlatform_TaskHzlTxNames[bus],
+        HZL_PLATFORM_TASK_STACK_WORDS_HZL_TX,
+        (void*) (uintptr_t) bus,
+        HZL_PLATFORM_TASK_PRIORITY_HZL_TX,
+        &pipeline->taskTx);
+    if (appCreated != pdPASS || txCreated != pdPASS)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_RTOS_TASK_CREATION);
+    }
+    return pipeline->taskApp;
+#endif  /* defined(HZL_PLATFORM_TASKHZL_SINGLE) */
+}
+
+/**
+ * @internal
+ * Initialisation of the services shared by the TaskHzl of all buses, done by the one of the
+ * main bus before any other TaskHzl exists.
+ */
+static void
+hzlPlatform_TaskHzlInitShared(void)
+{
+    HZL_PLATFORM_LATENCY_HIST_INIT();
     CSEC_DRV_Init(&csec1_State);
     const status_t status = CSEC_DRV_InitRNG();
     if (status != STATUS_SUCCESS)
@@ -343,40 +1083,128 @@ hzlPlatform_TaskHzlInit(void)
         // 5. If you change the content of the flash, you will need to perform steps 1-3 again.
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_CSEC_RNG_INIT);
     }
-    hzlPlatform_PeriodicTxTimerInit(xTaskGetCurrentTaskHandle());
+    hzlPlatform_EntropyInit();
+    hzlPlatform_CpuStatsInit();
     hzlPlatform_Button1And2Init(xTaskGetCurrentTaskHandle());
-    hzlCtx0.io.trng = hzlPlatform_HzlAdapterTrng;
-    hzlCtx0.io.currentTime = hzlPlatform_HzlAdapterCurrentTime;
-    const hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_INIT(&hzlCtx0);
+}
+
+#if !defined(HZL_PLATFORM_RX_NO_PREFILTER)
+/**
+ * @internal
+ * Accepts the frames of the peers of the node in the Groups of its configuration on the bus.
+ */
+static void
+hzlPlatform_RxPrefilterOfBusInit(const uint8_t bus, const uint8_t ownSid)
+{
+    const HZL_PLATFORM_HZL_CTX_T* const ctx = hzlPlatform_HzlCtxOfBus[bus];
+    hzlPlatform_RxPrefilterInit(&gRxPrefilters[bus], ownSid);
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+    const size_t groups = ctx->serverConfig->amountOfGroups;
+#else
+    const size_t groups = ctx->clientConfig->amountOfGroups;
+#endif
+    for (size_t i = 0U; i < groups; i++)
+    {
+        hzlPlatform_RxPrefilterAcceptGid(&gRxPrefilters[bus], ctx->groupConfigs[i].gid);
+    }
+}
+#endif
+
+/**
+ * @internal
+ * Main application task initialisation phase.
+ * Enable the hardware components, OS components and libraries required for the application to
+ * run on the given bus. The TaskHzl of the main bus also starts the shared services, the log and
+ * the TaskHzl of the other buses.
+ */
+static void
+hzlPlatform_TaskHzlInit(const uint8_t bus)
+{
+    hzlPlatform_TaskHzlHandles[bus] = xTaskGetCurrentTaskHandle();
+    if (bus == HZL_PLATFORM_BUS_MAIN)
+    {
+        hzlPlatform_TaskHzlInitShared();
+    }
+    HZL_PLATFORM_HZL_CTX_T* const ctx = hzlPlatform_HzlCtxOfBus[bus];
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+    const uint8_t ownSid = HZL_PLATFORM_CANFILTER_SID_SERVER;
+#else
+    const uint8_t ownSid = ctx->clientConfig->sid;
+#endif
+#if !defined(HZL_PLATFORM_RX_NO_PREFILTER)
+    hzlPlatform_RxPrefilterOfBusInit(bus, ownSid);
+#endif
+    hzlPlatform_FlexcanInit(bus, ownSid, xTaskGetCurrentTaskHandle());
+    ctx->io.trng = hzlPlatform_HzlAdapterTrng;
+    ctx->io.currentTime = hzlPlatform_HzlAdapterCurrentTime;
+    const hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_INIT(ctx);
     if (hzlErrCode != HZL_OK)
     {
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_HZL_INIT);
     }
-    hzlPlatform_AppLog(
-        "INFO: Hazelnet Demo Platform:" HZL_PLATFORM_VERSION
-        " Lib:" HZL_VERSION
-        " CBS:" HZL_CBS_PROTOCOL_VERSION_SUPPORTED);
+    hzlPlatform_PeriodicTxTimerInit(bus, hzlPlatform_PipelineInit(bus));
+    if (bus == HZL_PLATFORM_BUS_MAIN)
+    {
+        hzlPlatform_LogInit();
+        hzlPlatform_Log(
+            "INFO: Hazelnet Demo Platform:" HZL_PLATFORM_VERSION
+            " Lib:" HZL_VERSION
+            " CBS:" HZL_CBS_PROTOCOL_VERSION_SUPPORTED);
+        for (uint8_t otherBus = 0U; otherBus < HZL_PLATFORM_BUSES_AMOUNT; otherBus++)
+        {
+            if (otherBus == HZL_PLATFORM_BUS_MAIN)
+            {
+                continue;
+            }
+            const BaseType_t created = xTaskCreate(
+                hzlPlatform_TaskHzl,
+                hzlPlatform_TaskHzlNames[otherBus],
+                HZL_PLATFORM_TASK_STACK_WORDS_HZL,
+                (void*) (uintptr_t) otherBus,
+                HZL_PLATFORM_TASK_PRIORITY_HZL,
+                NULL);
+            if (created != pdPASS)
+            {
+                hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_RTOS_TASK_CREATION);
+            }
+        }
+    }
 #if defined(HZL_PLATFORM_ROLE_SERVER)
     hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_WAITING_FOR_REQ);
 #endif
-    hzlPlatform_AppClientOnlyNewHandshake();
-    return rxCanMsgsQueue;
+#if !defined(HZL_PLATFORM_ROLE_SERVER) && !defined(HZL_PLATFORM_HANDSHAKE_NO_BACKOFF)
+    // The Requests never go out before the previous one timed out, but all Clients starting
+    // together would still transmit in lock-step: jitter the first one.
+    hzlPlatform_HandshakeBackoffInit(&gHandshakeBackoffs[bus],
+        (uint32_t) ctx->clientConfig->timeoutReqToResMillis * 1000U,
+        hzlPlatform_ClockMicros(), hzlPlatform_AppClientOnlyRandom());
+#endif
+    hzlPlatform_HzlCtxLock(bus);
+    hzlPlatform_AppClientOnlyNewHandshake(bus);
+    hzlPlatform_HzlCtxUnlock(bus);
 }
 
 /**
  * @internal
- * Cleanup of the contexts and peripherals used by the TaskHzl in case the Task is restarted.
+ * Handles the case of a valid HZL-processed (validated, decrypted) message. This includes the
+ * transmission of any automatic reaction message and the handling of data that was received
+ * in either secured or unsecured format.
+ *
+ * Any real-world application should probably replace this function with the behaviour that
+ * is expected of it.
  */
 static void
-hzlPlatform_AppProcessReceivedValid(const hzl_CbsPduMsg_t* const reactionPdu,
-                                         const hzl_RxSduMsg_t* const receivedUserData)
+hzlPlatform_AppProcessReceivedValid(const uint8_t bus,
+                                         const hzl_CbsPduMsg_t* const reactionPdu,
+                                         const hzl_RxSduMsg_t* const receivedUserData,
+                                         const uint64_t rxMicros)
 {
     if (reactionPdu->dataLen > 0)
     {
         // The Hazelnet library generated an automatic response (e.g. a RES after received a REQ)
         // which we should transmit. Better do it immediately to avoid any delays and handle
         // anything else about the received message afterwards.
-        hzlPlatform_FlexcanTransmit(reactionPdu->data, reactionPdu->dataLen);
+        hzlPlatform_FlexcanTransmit(bus, reactionPdu->data, reactionPdu->dataLen);
     }
     if (!receivedUserData->isForUser)
     {
@@ -394,38 +1222,60 @@ hzlPlatform_AppProcessReceivedValid(const hzl_CbsPduMsg_t* const reactionPdu,
         // safely discarded for the sake for this demo.
         return;
     }
-    hzlPlatform_RgbLedSetColor(HZL_PLATFORM_ERR_HZL_DECRYPTED);
     // At this point we know the received message contains some application data AND that it
     // was transmitted in a secure manner on the bus.
-    //
-    // In the case of this demo, the message contains simply an encrypted uint8_t counter padded to
-    // 16 bytes to provide more noise to any attacker. For the sake of demonstration, the counter is
-    // now converted to an ASCII string and transmitted again on the bus for the human operator to
-    // see. This essentially proves that the receiving party has successfully received and decrypted
-    // the secured message.
-    // The formatted string has exactly 34 bytes of length (before the null terminator).
-    const char format[] = "RX GID=%02X,SID=%02X,Secret counter=%02X";
-    char buffer[48U];
-    sprintf(buffer,
-        format,
-        receivedUserData->gid,
-        receivedUserData->sid,
-        receivedUserData->data[0]  // The decrypted counter
-        );
-    hzlPlatform_AppLog(buffer);
+#if defined(HZL_PLATFORM_AGGREGATION)
+    // Split the aggregate back into its messages, see hzlPlatform_Aggregation.h.
+    const uint8_t* const records = receivedUserData->data;
+    const size_t recordsLen = receivedUserData->dataLen;
+    if (!hzlPlatform_AggIsWellFormed(records, recordsLen))
+    {
+        hzlPlatform_Telemetry.buses[bus].rxAggregatesMalformed++;
+        return;
+    }
+    for (size_t offset = 0U; offset < recordsLen; offset += 1U + records[offset])
+    {
+        hzlPlatform_AppDeliver(bus, receivedUserData->gid, receivedUserData->sid,
+            &records[offset + 1U], records[offset], rxMicros);
+    }
+#else
+    hzlPlatform_AppDeliver(bus, receivedUserData->gid, receivedUserData->sid,
+        receivedUserData->data, receivedUserData->dataLen, rxMicros);
+#endif
 }
 
+/**
+ * @internal
+ * Cleanup of the contexts and peripherals used by the TaskHzl in case the Task is restarted.
+ */
 static void
-hzlPlatform_TaskHzlDeinit(void)
+hzlPlatform_TaskHzlDeinit(const uint8_t bus)
 {
-    hzlPlatform_AppLog("INFO: powering down");
-    const hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_DEINIT(&hzlCtx0);
+#if !defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    // Stop the other stages of the bus outside of any Hazelnet call. Suspended rather than
+    // deleted, as the TX timer keeps notifying the TaskHzlApp.
+    hzlPlatform_HzlCtxLock(bus);
+    vTaskSuspend(hzlPlatform_Pipelines[bus].taskApp);
+    vTaskSuspend(hzlPlatform_Pipelines[bus].taskTx);
+    hzlPlatform_HzlCtxUnlock(bus);
+#endif
+    if (bus == HZL_PLATFORM_BUS_MAIN)
+    {
+        hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_POWERING_DOWN, NULL);
+        hzlPlatform_LogDeinit(HZL_PLATFORM_LOG_DEINIT_TIMEOUT_TICKS);
+    }
+    const hzl_Err_t hzlErrCode = HZL_PLATFORM_HZL_DEINIT(hzlPlatform_HzlCtxOfBus[bus]);
     if (hzlErrCode != HZL_OK)
     {
         hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_HZL_DEINIT);
     }
     // TODO Deinit the security hardware, if using it.
-    hzlPlatform_FlexcanDeinit();
+    hzlPlatform_FlexcanDeinit(bus);
+    if (bus != HZL_PLATFORM_BUS_MAIN)
+    {
+        // The TaskHzl of the main bus takes care of the LED.
+        vTaskDelete(NULL);
+    }
     while (true)
     {
         // Stuck forever in a controlled manner, waiting for an official powerdown or reset.
@@ -444,58 +1294,103 @@ hzlPlatform_TaskHzlDeinit(void)
 }
 
 void
-hzlPlatform_TaskHzl(void* const unusedParam)
+hzlPlatform_TaskHzl(void* const busIdx)
 {
-    (void) unusedParam;
-    QueueHandle_t rxCanMsgsQueue = hzlPlatform_TaskHzlInit();
-    flexcan_msgbuff_t poppedRxCanFdMsg;
-    uint8_t rollingCounterDummyTxMsgContent = HZL_PLATFORM_COUNTER_START;
+    const uint8_t bus = (uint8_t) (uintptr_t) busIdx;
+    hzlPlatform_TaskHzlInit(bus);
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+    // Otherwise the traffic is generated by the TaskHzlApp.
+    hzlPlatform_TrafficGen_t trafficGen;
+    hzlPlatform_AppTrafficInit(bus, &trafficGen);
+#endif
     bool keepRunning = true;
     // Main application loop.
-    // Periodically transmit a dummy encrypted message on the bus and react on all received
+    // Periodically transmit dummy encrypted messages on the bus and react on all received
     // messages from the bus.
     while (keepRunning)
     {
-        // Upon reception, the FLEXCAN interrupt with place the received CAN FD message into the
-        // rxCanMsgsQueue (see hzlPlatform_EnqueueReceivedCanFrame). Now we remove it from
-        // the queue and feed it to the Hazelnet library to process.
-        const BaseType_t isPoppedFromQueue = xQueueReceive(
-            rxCanMsgsQueue,
-            &poppedRxCanFdMsg,
-            HZL_PLATFORM_CANFD_RX_QUEUE_POP_TIMEOUT_TICKS);
-        if (isPoppedFromQueue)
+        // Sleep until anything happens: a CAN FD reception, the TX timer expiration or a button
+        // press all notify this task, so each is acted upon immediately. A deferred Request
+        // wakes it up when due.
+        uint32_t notificationEventBitmap = HZL_PLATFORM_TASK_EVENT_NONE;
+        xTaskNotifyWait(
+            0U,  // Do not clear any bits on entry.
+            UINT32_MAX,  // Clear notification event bitmap value on exit.
+            &notificationEventBitmap,
+            hzlPlatform_AppClientOnlyHandshakeWaitTicks(bus));
+        hzlPlatform_TelemetryEventHandled(bus, notificationEventBitmap);
+        // Whatever woke this task up, HZL_PLATFORM_TASK_EVENT_HANDSHAKE_DEFERRED included.
+        hzlPlatform_AppClientOnlyHandshakeDeferredTransmit(bus);
+        if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_CANFD_RX)
         {
-            hzlPlatform_AppProcessReceived(&poppedRxCanFdMsg);
+            // Upon reception, the FLEXCAN interrupt hands the received CAN FD message over
+            // (see hzlPlatform_EnqueueReceivedCanFrame). Now we feed each one to the Hazelnet
+            // library to process in place and then give its slot back to the driver.
+            // At most as many messages as there are slots are processed per wake-up, so a flood
+            // cannot starve the other events: any message beyond those arrived after the
+            // notification was cleared, thus it notified this task again.
+            for (uint32_t i = 0U; i < HZL_PLATFORM_CANFD_RX_SLOTS_AMOUNT; i++)
+            {
+                const flexcan_msgbuff_t* const rxCanFdMsg = hzlPlatform_FlexcanRxAcquire(bus);
+                if (rxCanFdMsg == NULL)
+                {
+                    break;
+                }
+                // One frame at a time, so the TaskHzlTx can secure its messages in between.
+                hzlPlatform_HzlCtxLock(bus);
+                hzlPlatform_AppProcessReceived(bus, rxCanFdMsg);
+                hzlPlatform_HzlCtxUnlock(bus);
+                hzlPlatform_FlexcanRxRelease(bus);
+            }
         }
-        // Periodic transmission of a dummy message when the timer expires.
-        const uint32_t notificationEventBitmap = ulTaskNotifyTake(
-        true,  // Clear notification event bitmap value on exit.
-            0U  // Timeout. Zero for non-blocking, return immediately.
-            );
+#if defined(HZL_PLATFORM_TASKHZL_SINGLE)
+        // Periodic transmission of the dummy messages when the timer expires.
         if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED)
         {
             // The time has come for the periodic transmission of dummy data.
-            hzlPlatform_AppTransmitDummyMsg(rollingCounterDummyTxMsgContent);
-            rollingCounterDummyTxMsgContent++;  // It IS supposed to overflow and roll-around.
+            hzlPlatform_AppTransmitTraffic(bus, &trafficGen);
         }
+#endif
         if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED)
         {
             // Trigger the virtual shutdown of the device.
 #if defined(HZL_PLATFORM_ROLE_SERVER)
-            hzlPlatform_AppLog("INFO: the Server cannot be powered down");
+            hzlPlatform_LogEvent(HZL_PLATFORM_LOG_EVENT_SERVER_CANNOT_POWER_DOWN, NULL);
 #else
             keepRunning = false;
+            if (bus == HZL_PLATFORM_BUS_MAIN)
+            {
+                // The buttons notify only this task: power down the other buses too.
+                for (uint8_t otherBus = 0U; otherBus < HZL_PLATFORM_BUSES_AMOUNT; otherBus++)
+                {
+                    if (otherBus != HZL_PLATFORM_BUS_MAIN
+                        && hzlPlatform_TaskHzlHandles[otherBus] != NULL)
+                    {
+                        xTaskNotify(hzlPlatform_TaskHzlHandles[otherBus],
+                            HZL_PLATFORM_TASK_EVENT_BUTTON_1_PRESSED,
+                            eSetBits);
+                    }
+                }
+            }
 #endif
         }
         if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED)
         {
             // Triggers the synchronisation of the Session manually: a REN from the Server,
             // a REQ from the Client.
+            // Only the main bus gets the button events.
+            hzlPlatform_HzlCtxLock(bus);
             // On the Server
-            hzlPlatform_AppServerOnlyForceSessionRenewal();
+            hzlPlatform_AppServerOnlyForceSessionRenewal(bus);
             // On the Client
-            hzlPlatform_AppClientOnlyNewHandshake();
+            hzlPlatform_AppClientOnlyNewHandshake(bus);
+            hzlPlatform_HzlCtxUnlock(bus);
+        }
+        if (notificationEventBitmap & HZL_PLATFORM_TASK_EVENT_BUTTON_2_LONG_PRESSED)
+        {
+            // Writes the latency histograms to the bus, if compiled in.
+            HZL_PLATFORM_LATENCY_HIST_DUMP();
         }
     }
-    hzlPlatform_TaskHzlDeinit();  // This function never returns
+    hzlPlatform_TaskHzlDeinit(bus);  // This function never returns
 }
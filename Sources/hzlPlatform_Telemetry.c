@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Storage of the run-time counters, see hzlPlatform_Telemetry.h.
+ */
+
+#include "hzlPlatform_Telemetry.h"
+#include "hzlPlatform_Clock.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @internal
+ * Amount of distinct event bits whose latency is tracked.
+ */
+#define HZL_PLATFORM_TELEMETRY_EVENT_BITS 8U
+
+volatile hzlPlatform_Telemetry_t hzlPlatform_Telemetry;
+
+/**
+ * @internal
+ * Tick at which each event bit was raised for the TaskHzl of each bus, valid only if its bit in
+ * hzlPlatform_EventsPending is set.
+ */
+static volatile uint32_t
+hzlPlatform_EventRaisedMicros[HZL_PLATFORM_TELEMETRY_BUSES_MAX][HZL_PLATFORM_TELEMETRY_EVENT_BITS];
+
+/**
+ * @internal
+ * Bitmap of the events raised but not handled yet by the TaskHzl of each bus.
+ */
+static volatile uint32_t hzlPlatform_EventsPending[HZL_PLATFORM_TELEMETRY_BUSES_MAX];
+
+void
+hzlPlatform_TelemetryEventRaised(const uint8_t bus, const uint32_t eventBitmap)
+{
+    const UBaseType_t interruptMask = taskENTER_CRITICAL_FROM_ISR();
+    const uint32_t now = (uint32_t) hzlPlatform_ClockMicros();
+    for (uint32_t bit = 0U; bit < HZL_PLATFORM_TELEMETRY_EVENT_BITS; bit++)
+    {
+        const uint32_t event = 1UL << bit;
+        if ((eventBitmap & event) && !(hzlPlatform_EventsPending[bus] & event))
+        {
+            hzlPlatform_EventRaisedMicros[bus][bit] = now;
+            hzlPlatform_EventsPending[bus] |= event;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(interruptMask);
+}
+
+void
+hzlPlatform_TelemetryEventHandled(const uint8_t bus, const uint32_t eventBitmap)
+{
+    taskENTER_CRITICAL();
+    const uint32_t now = (uint32_t) hzlPlatform_ClockMicros();
+    for (uint32_t bit = 0U; bit < HZL_PLATFORM_TELEMETRY_EVENT_BITS; bit++)
+    {
+        const uint32_t event = 1UL << bit;
+        if ((eventBitmap & event) && (hzlPlatform_EventsPending[bus] & event))
+        {
+            const uint32_t latency = now - hzlPlatform_EventRaisedMicros[bus][bit];
+            hzlPlatform_Telemetry.eventsHandled++;
+            hzlPlatform_Telemetry.eventLatencySumMicros += latency;
+            if (latency > hzlPlatform_Telemetry.eventLatencyMaxMicros)
+            {
+                hzlPlatform_Telemetry.eventLatencyMaxMicros = latency;
+            }
+            hzlPlatform_EventsPending[bus] &= ~event;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Run-time counters of the transmitted and received traffic, always enabled.
+ *
+ * Every counter is written by exactly one context (the FLEXCAN ISR or the TaskHzl of its bus,
+ * or code within a critical section) with a plain 32-bit store, which is atomic on the
+ * Cortex-M4, so no locking is needed to update them and they can be read at any time: from a
+ * debugger watching #hzlPlatform_Telemetry, from the application or from the host simulation.
+ * The traffic counters are kept per bus, see hzlPlatform_Telemetry_t.buses.
+ *
+ * The counters wrap around at 2^32.
+ */
+
+#ifndef HZL_PLATFORM_TELEMETRY_H_
+#define HZL_PLATFORM_TELEMETRY_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * Amount of buses the traffic counters are kept for: the 3 FLEXCAN instances of the S32K144.
+ * The entries beyond #HZL_PLATFORM_BUSES_AMOUNT stay zero.
+ */
+#define HZL_PLATFORM_TELEMETRY_BUSES_MAX 3U
+
+/**
+ * Classes of security warnings returned by the Hazelnet library when processing a received
+ * message, one counter each.
+ */
+typedef enum hzlPlatform_TelemetrySecWarn
+{
+    HZL_PLATFORM_TELEMETRY_SECWARN_INVALID_TAG = 0U,
+    HZL_PLATFORM_TELEMETRY_SECWARN_MESSAGE_FROM_MYSELF,
+    HZL_PLATFORM_TELEMETRY_SECWARN_NOT_EXPECTING_A_RESPONSE,
+    HZL_PLATFORM_TELEMETRY_SECWARN_SERVER_ONLY_MESSAGE,
+    HZL_PLATFORM_TELEMETRY_SECWARN_RESPONSE_TIMEOUT,
+    HZL_PLATFORM_TELEMETRY_SECWARN_OLD_MESSAGE,
+    HZL_PLATFORM_TELEMETRY_SECWARN_DENIAL_OF_SERVICE,
+    HZL_PLATFORM_TELEMETRY_SECWARN_NOT_IN_GROUP,
+    HZL_PLATFORM_TELEMETRY_SECWARN_RECEIVED_OVERFLOWN_NONCE,
+    HZL_PLATFORM_TELEMETRY_SECWARN_RECEIVED_ZERO_KEY,
+    /** Any security warning not known to this platform version. */
+    HZL_PLATFORM_TELEMETRY_SECWARN_OTHER,
+    HZL_PLATFORM_TELEMETRY_SECWARN_AMOUNT,
+} hzlPlatform_TelemetrySecWarn_t;
+
+/**
+ * Reasons of the received frames discarded before the Hazelnet library, one counter each, see
+ * hzlPlatform_RxPrefilter.h.
+ */
+typedef enum hzlPlatform_TelemetryPrefilter
+{
+    /** Transmitted with the CAN ID or the SID of this node. */
+    HZL_PLATFORM_TELEMETRY_PREFILTER_FROM_MYSELF = 0U,
+    /** CAN ID of no node this node exchanges messages with. */
+    HZL_PLATFORM_TELEMETRY_PREFILTER_UNKNOWN_SENDER,
+    /** SID in the CBS header other than the one of the CAN ID. */
+    HZL_PLATFORM_TELEMETRY_PREFILTER_SID_MISMATCH,
+    /** Too short for its CBS header or payload type, or unknown payload type. */
+    HZL_PLATFORM_TELEMETRY_PREFILTER_MALFORMED,
+    /** GID of a Group this node is not in. */
+    HZL_PLATFORM_TELEMETRY_PREFILTER_FOREIGN_GROUP,
+    HZL_PLATFORM_TELEMETRY_PREFILTER_AMOUNT,
+} hzlPlatform_TelemetryPrefilter_t;
+
+/**
+ * Counters of the traffic of one bus of this node.
+ */
+typedef struct hzlPlatform_TelemetryBus
+{
+    /** Frames accepted into the TX queue. Written within a critical section. */
+    uint32_t txFramesEnqueued;
+    /** Frames whose transmission completed. Written by the ISR. */
+    uint32_t txFramesSent;
+    /** Frames discarded because the TX queue was full. Written within a critical section. */
+    uint32_t txFramesDroppedQueueFull;
+    /**
+     * Largest amount of frames ever waiting in the TX queue at the same time,
+     * at most #HZL_PLATFORM_CANFD_TX_QUEUE_LEN. Written within a critical section.
+     */
+    uint32_t txQueueHighWaterMark;
+    /** Frames received and handed over to the TaskHzl of the bus. Written by the ISR. */
+    uint32_t rxFramesEnqueued;
+    /**
+     * Frames received but discarded because all the RX slots were still waiting for the TaskHzl.
+     * Non-zero means the TaskHzl cannot keep up with the bus load. Written by the ISR.
+     */
+    uint32_t rxFramesDroppedQueueFull;
+    /**
+     * Frames overwritten in a mailbox before being read out, see
+     * hzlPlatform_FlexcanRxLostFramesInHw(). Written by the ISR.
+     */
+    uint32_t rxFramesLostInHw;
+    /**
+     * Largest amount of frames ever waiting for the TaskHzl at the same time,
+     * at most #HZL_PLATFORM_CANFD_RX_QUEUE_LEN. Written by the ISR.
+     */
+    uint32_t rxQueueHighWaterMark;
+    /**
+     * Handshake and Session renewal frames (REQ, RES, REN) among the enqueued ones, see
+     * #HZL_PLATFORM_CANFD_RX_CONTROL_RESERVED_SLOTS. Written by the ISR.
+     */
+    uint32_t rxControlFramesEnqueued;
+    /** Handshake and Session renewal frames among the dropped ones. Written by the ISR. */
+    uint32_t rxControlFramesDropped;
+    /**
+     * Frames processed by the Hazelnet library, whatever the outcome.
+     * Written by the TaskHzl of the bus.
+     */
+    uint32_t rxFramesProcessed;
+    /** Frames not addressed to this node or not of interest (#HZL_ERR_MSG_IGNORED). */
+    uint32_t rxFramesIgnored;
+    /**
+     * Frames discarded before the Hazelnet library, per reason, not counted as processed.
+     * Written by the TaskHzl of the bus, like the following one.
+     */
+    uint32_t rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_AMOUNT];
+    /**
+     * Secured frames (SADFD, SADTP) among the prefiltered ones: authenticated decryptions the
+     * prefilter saved.
+     */
+    uint32_t rxAeadVerificationsSaved;
+    /**
+     * Processed frames carrying secured application data (SADFD, SADTP), whatever the outcome.
+     * Written by the TaskHzl of the bus.
+     */
+    uint32_t rxSecuredFramesProcessed;
+    /**
+     * Secured frames among the processed ones that were authenticated and decrypted. Divide by
+     * hzlPlatform_TelemetryBus_t.rxSecuredFramesProcessed for the decrypt-success ratio.
+     */
+    uint32_t rxSecuredFramesDecrypted;
+    /**
+     * Plaintext bytes of the decrypted secured frames: the secured goodput of the bus, divided
+     * by the elapsed time.
+     */
+    uint32_t rxSecuredPlaintextBytes;
+    /** Frames rejected with a security warning, per class. Written by the TaskHzl of the bus. */
+    uint32_t rxSecWarnings[HZL_PLATFORM_TELEMETRY_SECWARN_AMOUNT];
+    /**
+     * Resynchronisations of the bus (new handshake, Session renewal) because a sender kept
+     * causing security warnings, see hzlPlatform_SecWarnLimiter.h. Written by the TaskHzl of the
+     * bus, like the following one.
+     */
+    uint32_t secWarnResyncs;
+    /** Resynchronisations skipped because the previous one was too recent. */
+    uint32_t secWarnResyncsHeldOff;
+    /**
+     * Handshakes completed by this Client: Requests answered by a valid Response.
+     * Written by the TaskHzl of the bus, like the handshake durations.
+     */
+    uint32_t handshakesCompleted;
+    /**
+     * Sum of the durations from the transmission of a Request to the processing of its
+     * Response, in microseconds. Divide by hzlPlatform_TelemetryBus_t.handshakesCompleted for
+     * the average.
+     */
+    uint32_t handshakeSumMicros;
+    /** Longest duration from the transmission of a Request to the processing of its Response. */
+    uint32_t handshakeMaxMicros;
+    /** Requests transmitted by this Client, see hzlPlatform_HandshakeBackoff.h. */
+    uint32_t handshakeRequestsSent;
+    /** Requests held back because the previous one was too recent, counted once per wait. */
+    uint32_t handshakeRequestsDeferred;
+    /**
+     * Secured application messages decrypted and consumed by the application, whatever the
+     * task doing it (see #HZL_PLATFORM_TASKHZL_SINGLE). Written by that task.
+     */
+    uint32_t appMessagesConsumed;
+    /**
+     * Sum of the latencies from the reception of a secured message by the FLEXCAN interrupt to
+     * the application consuming its decrypted data, in microseconds. Divide by
+     * hzlPlatform_TelemetryBus_t.appMessagesConsumed for the average.
+     */
+    uint32_t appLatencySumMicros;
+    /** Largest latency from the reception of a secured message to the application consuming it. */
+    uint32_t appLatencyMaxMicros;
+    /** Decrypted messages discarded because the queue to the TaskHzlApp was full. */
+    uint32_t pipelineAppQueueFull;
+    /** Plaintext messages discarded because the queue to the TaskHzlTx was full. */
+    uint32_t pipelineTxQueueFull;
+    /**
+     * Plaintext messages produced by the traffic generator (hzlPlatform_TrafficGen.h), before
+     * securing. Written by the task owning the TX timer.
+     */
+    uint32_t trafficMessagesGenerated;
+    /**
+     * Messages packed into aggregates (hzlPlatform_Aggregation.h) and aggregates secured:
+     * their ratio is the average amount of messages sharing a frame. Written by the TaskHzlTx.
+     */
+    uint32_t txMessagesAggregated;
+    uint32_t txAggregatesSecured;
+    /**
+     * Decrypted plaintexts that are not a sequence of aggregation records, discarded.
+     * Written by the TaskHzl of the bus.
+     */
+    uint32_t rxAggregatesMalformed;
+} hzlPlatform_TelemetryBus_t;
+
+/**
+ * Counters of this node.
+ */
+typedef struct hzlPlatform_Telemetry
+{
+    /** Traffic of each bus, indexed like the buses, see #HZL_PLATFORM_BUSES_AMOUNT. */
+    hzlPlatform_TelemetryBus_t buses[HZL_PLATFORM_TELEMETRY_BUSES_MAX];
+    /**
+     * Events (RX, TX timer, buttons) the TaskHzl of any bus woke up for.
+     * Written within a critical section.
+     */
+    uint32_t eventsHandled;
+    /**
+     * Sum of the latencies from the raising of an event to the TaskHzl acting upon it, in
+     * microseconds. Divide by hzlPlatform_Telemetry_t.eventsHandled for the average.
+     * Written within a critical section.
+     */
+    uint32_t eventLatencySumMicros;
+    /** Largest latency from the raising of an event to the TaskHzl acting upon it, in microseconds. */
+    uint32_t eventLatencyMaxMicros;
+    /** Log messages (including the "xN" summaries) handed to the FLEXCAN driver. */
+    uint32_t logMessagesSent;
+    /** Log messages not transmitted as repetitions of the previous one, see hzlPlatform_Log(). */
+    uint32_t logMessagesCoalesced;
+    /** Log messages discarded because the log queue was full. */
+    uint32_t logMessagesDropped;
+    /** Requests of random bytes satisfied from the entropy pool. Written holding its mutex. */
+    uint32_t entropyRequestsFromPool;
+    /**
+     * Requests of random bytes the entropy pool could not satisfy, served by the CSEc directly.
+     * Written holding the mutex of the pool.
+     */
+    uint32_t entropyRequestsDirect;
+} hzlPlatform_Telemetry_t;
+
+/**
+ * Counters of this node. The traffic counters of a bus are reset by hzlPlatform_FlexcanInit().
+ */
+extern volatile hzlPlatform_Telemetry_t hzlPlatform_Telemetry;
+
+/**
+ * Records the moment the given events were raised for the TaskHzl of the given bus, just before
+ * notifying them. Only the first raising since the last handling counts. Callable from ISRs and
+ * tasks.
+ *
+ * @param [in] bus index of the bus whose TaskHzl is notified
+ * @param [in] eventBitmap bitmap of #hzlPlatform_TaskEventBitmap_t
+ */
+void
+hzlPlatform_TelemetryEventRaised(uint8_t bus, uint32_t eventBitmap);
+
+/**
+ * Accounts the latency of the given events, which the TaskHzl of the given bus is about to act
+ * upon. Called only by that TaskHzl.
+ *
+ * @param [in] bus index of the bus of the calling TaskHzl
+ * @param [in] eventBitmap bitmap of #hzlPlatform_TaskEventBitmap_t
+ */
+void
+hzlPlatform_TelemetryEventHandled(uint8_t bus, uint32_t eventBitmap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_TELEMETRY_H_ */
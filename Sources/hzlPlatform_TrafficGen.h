@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Generator of the secured application traffic of a node, replacing the single dummy message per
+ * TX timer expiration with a load configurable at compile time, up to the saturation of the bus.
+ *
+ * Upon every TX timer expiration (#HZL_PLATFORM_TX_TIMER_TICKS) the generator produces a burst of
+ * #HZL_PLATFORM_TRAFFIC_BURST_LEN messages, in the first #HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS
+ * timer periods of every cycle, followed by #HZL_PLATFORM_TRAFFIC_BURST_OFF_PERIODS silent ones.
+ * The plaintext lengths follow #HZL_PLATFORM_TRAFFIC_PAYLOAD between
+ * #HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN and #HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN, the target
+ * Groups cycle through #HZL_PLATFORM_TRAFFIC_GIDS. Each plaintext starts with a rolling counter,
+ * padded with 0x55.
+ *
+ * All of them can be defined per role at compile time; the defaults are the original demo: one
+ * 16-byte message to all Groups per TX timer expiration.
+ */
+
+#ifndef HZL_PLATFORM_TRAFFICGEN_H_
+#define HZL_PLATFORM_TRAFFICGEN_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "hzl.h"
+
+/** Every plaintext has the same length, #HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN. */
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_FIXED 0U
+/** Plaintext lengths drawn uniformly between the minimum and the maximum. */
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_UNIFORM 1U
+/** Plaintext lengths from the minimum to the maximum one byte at a time, then again. */
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_SWEEP 2U
+
+/**
+ * Largest plaintext of a SADFD in a 64-byte CAN FD frame with the 3-byte CBS header: 1 byte of
+ * plaintext length, 3 of counter nonce and 8 of tag are left out.
+ */
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_LIMIT 49U
+
+#ifndef HZL_PLATFORM_TRAFFIC_BURST_LEN
+#define HZL_PLATFORM_TRAFFIC_BURST_LEN 1U
+#endif
+#ifndef HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS
+#define HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS 1U
+#endif
+#ifndef HZL_PLATFORM_TRAFFIC_BURST_OFF_PERIODS
+#define HZL_PLATFORM_TRAFFIC_BURST_OFF_PERIODS 0U
+#endif
+#ifndef HZL_PLATFORM_TRAFFIC_PAYLOAD
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD HZL_PLATFORM_TRAFFIC_PAYLOAD_FIXED
+#endif
+#ifndef HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN 16U
+#endif
+#ifndef HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN
+#define HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN 16U
+#endif
+/** Comma-separated GIDs, used round-robin. */
+#ifndef HZL_PLATFORM_TRAFFIC_GIDS
+#define HZL_PLATFORM_TRAFFIC_GIDS HZL_BROADCAST_GID
+#endif
+
+#if HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS < 1U
+#error "HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS must be at least 1."
+#endif
+#if HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN < 1U \
+    || HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN > HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN \
+    || HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN > HZL_PLATFORM_TRAFFIC_PAYLOAD_LIMIT
+#error "The traffic plaintext lengths must satisfy 1 <= MIN_LEN <= MAX_LEN <= 49."
+#endif
+
+/** @internal Target Groups of the generated messages. */
+static const hzl_Gid_t hzlPlatform_TrafficGids[] = { HZL_PLATFORM_TRAFFIC_GIDS };
+
+/**
+ * Generator state, one per bus. Initialise with hzlPlatform_TrafficGenInit() before use.
+ */
+typedef struct hzlPlatform_TrafficGen
+{
+    /** Xorshift state for the uniform lengths, never 0. */
+    uint32_t prngState;
+    /** Position of the current timer period in the on/off cycle. */
+    uint32_t period;
+    /** Index of the next target in hzlPlatform_TrafficGids. */
+    uint32_t gidIdx;
+    /** Length of the next plaintext with #HZL_PLATFORM_TRAFFIC_PAYLOAD_SWEEP. */
+    uint8_t sweepLen;
+    /** First byte of the next plaintext. It IS supposed to overflow and roll around. */
+    uint8_t counter;
+} hzlPlatform_TrafficGen_t;
+
+/**
+ * Resets the generator.
+ *
+ * @param [out] gen to initialise
+ * @param [in] counterStart first value of the rolling counter
+ * @param [in] seed of the uniform lengths, e.g. the CAN ID of the node: any value, 0 included
+ */
+static inline void
+hzlPlatform_TrafficGenInit(hzlPlatform_TrafficGen_t* const gen,
+                           const uint8_t counterStart,
+                           const uint32_t seed)
+{
+    gen->prngState = seed | 1U;
+    gen->period = 0U;
+    gen->gidIdx = 0U;
+    gen->sweepLen = HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN;
+    gen->counter = counterStart;
+}
+
+/**
+ * Amount of messages to generate upon this TX timer expiration: the burst length in the on
+ * periods of the cycle, 0 in the off ones. Call once per expiration.
+ */
+static inline uint32_t
+hzlPlatform_TrafficGenBurstLen(hzlPlatform_TrafficGen_t* const gen)
+{
+    const uint32_t isOn = gen->period < HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS;
+    gen->period++;
+    if (gen->period
+        >= HZL_PLATFORM_TRAFFIC_BURST_ON_PERIODS + HZL_PLATFORM_TRAFFIC_BURST_OFF_PERIODS)
+    {
+        gen->period = 0U;
+    }
+    return isOn ? HZL_PLATFORM_TRAFFIC_BURST_LEN : 0U;
+}
+
+/**
+ * Writes the next plaintext and its target Group.
+ *
+ * @param [in, out] gen generator
+ * @param [out] data buffer of #HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN bytes
+ * @param [out] gid target Group
+ * @return length of the plaintext
+ */
+static inline size_t
+hzlPlatform_TrafficGenNext(hzlPlatform_TrafficGen_t* const gen,
+                           uint8_t* const data,
+                           hzl_Gid_t* const gid)
+{
+    size_t dataLen;
+#if HZL_PLATFORM_TRAFFIC_PAYLOAD == HZL_PLATFORM_TRAFFIC_PAYLOAD_UNIFORM
+    // Xorshift32: statistically poor but plenty for lengths, and far cheaper than the TRNG.
+    gen->prngState ^= gen->prngState << 13U;
+    gen->prngState ^= gen->prngState >> 17U;
+    gen->prngState ^= gen->prngState << 5U;
+    dataLen = HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN
+              + gen->prngState % (HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN
+                                  - HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN + 1U);
+#elif HZL_PLATFORM_TRAFFIC_PAYLOAD == HZL_PLATFORM_TRAFFIC_PAYLOAD_SWEEP
+    dataLen = gen->sweepLen;
+    gen->sweepLen = (gen->sweepLen >= HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN)
+                    ? (uint8_t) HZL_PLATFORM_TRAFFIC_PAYLOAD_MIN_LEN
+                    : (uint8_t) (gen->sweepLen + 1U);
+#else
+    dataLen = HZL_PLATFORM_TRAFFIC_PAYLOAD_MAX_LEN;
+#endif
+    memset(data, 0x55U, dataLen);  // Dummy padding value: 0b01010101
+    data[0] = gen->counter;
+    gen->counter++;
+    *gid = hzlPlatform_TrafficGids[gen->gidIdx];
+    gen->gidIdx++;
+    if (gen->gidIdx >= sizeof(hzlPlatform_TrafficGids) / sizeof(hzlPlatform_TrafficGids[0]))
+    {
+        gen->gidIdx = 0U;
+    }
+    return dataLen;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_PLATFORM_TRAFFICGEN_H_ */
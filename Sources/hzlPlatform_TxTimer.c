@@ -34,37 +34,43 @@
 
 #include "hzlPlatform.h"
 #include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_Telemetry.h"
 
-static TaskHandle_t taskToNotifyOnExpiration = NULL;
+/**
+ * @internal
+ * TaskHzl of each bus, notified by the timer of the bus.
+ */
+static TaskHandle_t taskToNotifyOnExpiration[HZL_PLATFORM_BUSES_AMOUNT];
 
 /**
  * @internal
- * Sets the event bit for the TX timer expiration to the event bitmap of the task-to-notify.
+ * Sets the event bit for the TX timer expiration to the event bitmap of the task-to-notify
+ * of the bus the timer belongs to, which is the timer ID.
  */
 static void
 hzlPlatform_CallbackOnTxTimerExpiration(TimerHandle_t whichTimerExpiredHandle)
 {
-    (void) whichTimerExpiredHandle;
+    const uint8_t bus = (uint8_t) (uintptr_t) pvTimerGetTimerID(whichTimerExpiredHandle);
+    hzlPlatform_TelemetryEventRaised(bus, HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED);
+    // Timer callbacks run in the timer service task, so the task (not ISR) variant is used.
     // eSetBits: The task's notification value is bitwise ORed with ulValue.
     // The function always returns pdPASS in this case.
-    xTaskNotifyFromISR(
-        taskToNotifyOnExpiration,
+    xTaskNotify(
+        taskToNotifyOnExpiration[bus],
         HZL_PLATFORM_TASK_EVENT_TX_TIMER_EXPIRED,
-        eSetBits,
-        NULL // pxHigherPriorityTaskWoken
+        eSetBits
         );
 }
 
 void
-hzlPlatform_PeriodicTxTimerInit(TaskHandle_t taskToNotify)
+hzlPlatform_PeriodicTxTimerInit(const uint8_t bus, TaskHandle_t taskToNotify)
 {
-    taskToNotifyOnExpiration = taskToNotify;
-    uint32_t txTimerIdentifier = 0x11U;
+    taskToNotifyOnExpiration[bus] = taskToNotify;
     TimerHandle_t timerHandle = xTimerCreate(
             "hzl_tx_timer",
             HZL_PLATFORM_TX_TIMER_TICKS,
             true, // Do autoreload, make it a periodic timer
-            &txTimerIdentifier,
+            (void*) (uintptr_t) bus,  // The timer ID tells the callback which bus it's for
             hzlPlatform_CallbackOnTxTimerExpiration
             );
     if (timerHandle == NULL)
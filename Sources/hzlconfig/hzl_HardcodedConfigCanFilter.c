@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * SIDs each SID exchanges frames with, to compute the CAN ID acceptance filters,
+ * see hzlPlatform_CanFilter.h.
+ *
+ * AUTO-GENERATED FILE by toolsupport/hzlconfiggen from hzl_HardcodedConfigServer.c
+ * (3 Clients, 5 Groups). Regenerate it whenever that file changes.
+ */
+
+#include "hzlPlatform_CanFilter.h"
+
+const uint64_t hzlPlatform_CanFilterPeersBySid[HZL_PLATFORM_CANFILTER_SIDS_AMOUNT] =
+{
+    0x00000000EU,  // SID 0
+    0x00000000DU,  // SID 1
+    0x00000000BU,  // SID 2
+    0x000000007U,  // SID 3
+    0x000000000U,  // SID 4
+    0x000000000U,  // SID 5
+    0x000000000U,  // SID 6
+    0x000000000U,  // SID 7
+    0x000000000U,  // SID 8
+    0x000000000U,  // SID 9
+    0x000000000U,  // SID 10
+    0x000000000U,  // SID 11
+    0x000000000U,  // SID 12
+    0x000000000U,  // SID 13
+    0x000000000U,  // SID 14
+    0x000000000U,  // SID 15
+    0x000000000U,  // SID 16
+    0x000000000U,  // SID 17
+    0x000000000U,  // SID 18
+    0x000000000U,  // SID 19
+    0x000000000U,  // SID 20
+    0x000000000U,  // SID 21
+    0x000000000U,  // SID 22
+    0x000000000U,  // SID 23
+    0x000000000U,  // SID 24
+    0x000000000U,  // SID 25
+    0x000000000U,  // SID 26
+    0x000000000U,  // SID 27
+    0x000000000U,  // SID 28
+    0x000000000U,  // SID 29
+    0x000000000U,  // SID 30
+    0x000000000U,  // SID 31
+    0x000000000U,  // SID 32
+};
@@ -0,0 +1,717 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host micro-benchmark of the Hazelnet operations with the exact contexts flashed on the boards
+ * (Sources/hzlconfig): the Server and all Clients are linked into one executable, each
+ * context renamed at compile time, and talk to each other directly, without any bus.
+ *
+ * Measures the ns per operation of each operation, for each GID of the Server configuration and,
+ * where the operation carries user data, for each payload length 0-64. Every measurement starts
+ * from freshly initialised contexts with established sessions, so the counter nonces never reach
+ * their upper limit, and the best of a few repetitions is kept to filter out the host noise.
+ * Operations failing for a length (too long for the frame) report the Hazelnet error code.
+ *
+ * The time is virtual and frozen, so no session expires during the run, and the random bytes
+ * come from a fast deterministic generator: the cost of the CSEc is not part of the results.
+ *
+ * The results are written to stdout as JSON, one result per line. Given a baseline, i.e. the
+ * JSON output of a previous run, the results are compared to it and every operation slower
+ * than the threshold is reported to stderr, making the exit code non-zero.
+ *
+ * Usage: `hzlbench [-n iterations] [-r repetitions] [-b baseline.json] [-t threshold_percent]
+ * [-G gid] [-l len] [-m ram_budget_bytes]`, 200 iterations, 3 repetitions and a 10% threshold by
+ * default. `-G` and `-l` restrict the sweep to one GID and one payload length. `-m` replaces the
+ * benchmark with a check of the RAM taken by the Server configuration, see hzlBench_CheckRam().
+ *
+ * Built with HZL_BENCH_SCALED, it links the scaled configurations of toolsupport/hzlconfiggen
+ * instead, with only the Client of SID 1, member of all Groups: the cost per frame with many
+ * Groups, see the "scale" target of the Makefile.
+ */
+
+#define _POSIX_C_SOURCE 199309L  // clock_gettime()
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hzl.h"
+#include "hzl_Client.h"
+#include "hzl_Server.h"
+
+#define HZL_BENCH_DEFAULT_ITERATIONS 200UL
+#define HZL_BENCH_DEFAULT_REPETITIONS 3UL
+#define HZL_BENCH_DEFAULT_THRESHOLD_PERCENT 10.0
+#define HZL_BENCH_PAYLOAD_MAX_LEN HZL_MAX_CAN_FD_DATA_LEN
+#define HZL_BENCH_OP_NAME_MAX_LEN 64U
+#define HZL_BENCH_LINE_MAX_LEN 256U
+
+// The contexts of Sources/hzlconfig, all called hzlCtx0 there, renamed by the Makefile.
+extern hzl_ServerCtx_t hzlBench_CtxServer;
+#if defined(HZL_BENCH_SCALED)
+extern hzl_ClientCtx_t hzlBench_CtxClient1;
+#else
+extern hzl_ClientCtx_t hzlBench_CtxAlice;
+extern hzl_ClientCtx_t hzlBench_CtxBob;
+extern hzl_ClientCtx_t hzlBench_CtxCharlie;
+#endif
+
+/** @internal A Client and the CAN ID it transmits with, as on the demo bus. */
+typedef struct hzlBench_Client
+{
+    hzl_ClientCtx_t* ctx;
+    hzl_CanId_t canId;
+} hzlBench_Client_t;
+
+#define HZL_BENCH_CANID_SERVER 0x700U
+/** @internal CAN ID of the Client with the given SID, as hzlPlatform_CanIdOfSid(). */
+#define HZL_BENCH_CANID_OF_SID(sid) (0x709U + (sid))
+
+static const hzlBench_Client_t gClients[] =
+{
+#if defined(HZL_BENCH_SCALED)
+    {&hzlBench_CtxClient1, HZL_BENCH_CANID_OF_SID(1U)},
+#else
+    {&hzlBench_CtxAlice, HZL_BENCH_CANID_OF_SID(1U)},
+    {&hzlBench_CtxBob, HZL_BENCH_CANID_OF_SID(2U)},
+    {&hzlBench_CtxCharlie, HZL_BENCH_CANID_OF_SID(3U)},
+#endif
+};
+#define HZL_BENCH_CLIENTS_AMOUNT (sizeof(gClients) / sizeof(gClients[0]))
+
+/** @internal One measured operation. */
+typedef struct hzlBench_Op
+{
+    const char* name;
+    /** The operation carries user data: swept over all payload lengths, otherwise length 0. */
+    bool sweepsLen;
+    /** The operation is performed by a Client: skipped for the GIDs without any Client. */
+    bool needsClient;
+    /** Untimed preparation of all the iterations, may be NULL. */
+    hzl_Err_t (*prepare)(hzl_Gid_t gid, size_t len);
+    /** Timed operation, the i-th iteration. */
+    hzl_Err_t (*run)(hzl_Gid_t gid, size_t len, size_t i);
+} hzlBench_Op_t;
+
+/** @internal One result, also the format of the baseline entries. */
+typedef struct hzlBench_Result
+{
+    char op[HZL_BENCH_OP_NAME_MAX_LEN];
+    unsigned gid;
+    unsigned len;
+    double nsPerOp;
+    int err;
+} hzlBench_Result_t;
+
+static unsigned long gIterations = HZL_BENCH_DEFAULT_ITERATIONS;
+static unsigned long gRepetitions = HZL_BENCH_DEFAULT_REPETITIONS;
+static double gThresholdPercent = HZL_BENCH_DEFAULT_THRESHOLD_PERCENT;
+/** @internal The only GID and payload length to measure, negative for all. */
+static long gOnlyGid = -1;
+static long gOnlyLen = -1;
+static uint64_t gRandomState = 0x9E3779B97F4A7C15ULL;
+static const uint8_t gPayload[HZL_BENCH_PAYLOAD_MAX_LEN] = {0x55U};
+/** @internal Client member of the GID being measured, NULL if none. */
+static const hzlBench_Client_t* gClient;
+/** @internal Frames prepared for the reception operations, one per iteration. */
+static hzl_CbsPduMsg_t* gFrames;
+static hzlBench_Result_t* gBaseline;
+static size_t gBaselineAmount;
+
+/**
+ * @internal
+ * Deterministic xorshift64* generator: the benchmark measures Hazelnet, not the entropy source.
+ */
+static hzl_Err_t
+hzlBench_Trng(uint8_t* const bytes, const size_t amount)
+{
+    for (size_t i = 0U; i < amount; i++)
+    {
+        gRandomState ^= gRandomState >> 12U;
+        gRandomState ^= gRandomState << 25U;
+        gRandomState ^= gRandomState >> 27U;
+        bytes[i] = (uint8_t) ((gRandomState * 0x2545F4914F6CDD1DULL) >> 56U);
+    }
+    return HZL_OK;
+}
+
+/** @internal Frozen virtual time: no timeout or session expiration during the measurements. */
+static hzl_Err_t
+hzlBench_CurrentTime(hzl_Timestamp_t* const timestamp)
+{
+    *timestamp = 1000U;
+    return HZL_OK;
+}
+
+static uint64_t
+hzlBench_NowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+/** @internal Whether the Client is configured to be in the group. */
+static bool
+hzlBench_ClientIsInGroup(const hzl_ClientCtx_t* const client, const hzl_Gid_t gid)
+{
+    for (hzl_Gid_t i = 0U; i < client->clientConfig->amountOfGroups; i++)
+    {
+        if (client->groupConfigs[i].gid == gid)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @internal REQ of the Client, processed by the Server, whose RES is processed by the Client. */
+static hzl_Err_t
+hzlBench_Handshake(const hzlBench_Client_t* const client, const hzl_Gid_t gid)
+{
+    hzl_CbsPduMsg_t req;
+    hzl_CbsPduMsg_t res;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    hzl_Err_t err = hzl_ClientBuildRequest(&req, client->ctx, gid);
+    if (err == HZL_OK)
+    {
+        err = hzl_ServerProcessReceived(&res, &sdu, &hzlBench_CtxServer,
+                                        req.data, req.dataLen, client->canId);
+    }
+    if (err == HZL_OK)
+    {
+        err = hzl_ClientProcessReceived(&reaction, &sdu, client->ctx,
+                                        res.data, res.dataLen, HZL_BENCH_CANID_SERVER);
+    }
+    return err;
+}
+
+/**
+ * @internal
+ * Brings all contexts to the state of a running bus: initialised, with every Client having
+ * completed the handshake of each of its groups.
+ */
+static void
+hzlBench_Reset(void)
+{
+    hzl_ServerDeInit(&hzlBench_CtxServer);
+    hzlBench_CtxServer.io.trng = hzlBench_Trng;
+    hzlBench_CtxServer.io.currentTime = hzlBench_CurrentTime;
+    hzl_Err_t err = hzl_ServerInit(&hzlBench_CtxServer);
+    for (size_t c = 0U; c < HZL_BENCH_CLIENTS_AMOUNT && err == HZL_OK; c++)
+    {
+        hzl_ClientCtx_t* const ctx = gClients[c].ctx;
+        hzl_ClientDeInit(ctx);
+        ctx->io.trng = hzlBench_Trng;
+        ctx->io.currentTime = hzlBench_CurrentTime;
+        err = hzl_ClientInit(ctx);
+        for (hzl_Gid_t g = 0U; g < ctx->clientConfig->amountOfGroups && err == HZL_OK; g++)
+        {
+            err = hzlBench_Handshake(&gClients[c], ctx->groupConfigs[g].gid);
+        }
+    }
+    if (err != HZL_OK)
+    {
+        fprintf(stderr, "Cannot set up the contexts, err=%d\n", (int) err);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static hzl_Err_t
+hzlBench_RunServerBuildSecuredFd(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) i;
+    hzl_CbsPduMsg_t pdu;
+    return hzl_ServerBuildSecuredFd(&pdu, &hzlBench_CtxServer, gPayload, len, gid);
+}
+
+static hzl_Err_t
+hzlBench_RunClientBuildSecuredFd(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) i;
+    hzl_CbsPduMsg_t pdu;
+    return hzl_ClientBuildSecuredFd(&pdu, gClient->ctx, gPayload, len, gid);
+}
+
+static hzl_Err_t
+hzlBench_RunServerBuildUnsecured(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) i;
+    hzl_CbsPduMsg_t pdu;
+    return hzl_ServerBuildUnsecured(&pdu, &hzlBench_CtxServer, gPayload, len, gid);
+}
+
+static hzl_Err_t
+hzlBench_RunClientBuildUnsecured(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) i;
+    hzl_CbsPduMsg_t pdu;
+    return hzl_ClientBuildUnsecured(&pdu, gClient->ctx, gPayload, len, gid);
+}
+
+static hzl_Err_t
+hzlBench_PrepareFromServer(const hzl_Gid_t gid, const size_t len)
+{
+    hzl_Err_t err = HZL_OK;
+    for (size_t i = 0U; i < gIterations && err == HZL_OK; i++)
+    {
+        err = hzl_ServerBuildSecuredFd(&gFrames[i], &hzlBench_CtxServer, gPayload, len, gid);
+    }
+    return err;
+}
+
+static hzl_Err_t
+hzlBench_RunClientProcessReceived(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) gid;
+    (void) len;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    return hzl_ClientProcessReceived(&reaction, &sdu, gClient->ctx,
+                                     gFrames[i].data, gFrames[i].dataLen, HZL_BENCH_CANID_SERVER);
+}
+
+static hzl_Err_t
+hzlBench_PrepareFromClient(const hzl_Gid_t gid, const size_t len)
+{
+    hzl_Err_t err = HZL_OK;
+    for (size_t i = 0U; i < gIterations && err == HZL_OK; i++)
+    {
+        err = hzl_ClientBuildSecuredFd(&gFrames[i], gClient->ctx, gPayload, len, gid);
+    }
+    return err;
+}
+
+static hzl_Err_t
+hzlBench_RunServerProcessReceived(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) gid;
+    (void) len;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    return hzl_ServerProcessReceived(&reaction, &sdu, &hzlBench_CtxServer,
+                                     gFrames[i].data, gFrames[i].dataLen, gClient->canId);
+}
+
+static hzl_Err_t
+hzlBench_RunHandshake(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) len;
+    (void) i;
+    return hzlBench_Handshake(gClient, gid);
+}
+
+static hzl_Err_t
+hzlBench_RunForceSessionRenewal(const hzl_Gid_t gid, const size_t len, const size_t i)
+{
+    (void) len;
+    (void) i;
+    hzl_CbsPduMsg_t pdu;
+    return hzl_ServerForceSessionRenewal(&pdu, &hzlBench_CtxServer, gid);
+}
+
+static const hzlBench_Op_t gOps[] =
+{
+    {"ServerBuildSecuredFd", true, false, NULL, hzlBench_RunServerBuildSecuredFd},
+    {"ClientBuildSecuredFd", true, true, NULL, hzlBench_RunClientBuildSecuredFd},
+    {"ServerBuildUnsecured", true, false, NULL, hzlBench_RunServerBuildUnsecured},
+    {"ClientBuildUnsecured", true, true, NULL, hzlBench_RunClientBuildUnsecured},
+    {"ClientProcessReceived", true, true, hzlBench_PrepareFromServer,
+     hzlBench_RunClientProcessReceived},
+    {"ServerProcessReceived", true, true, hzlBench_PrepareFromClient,
+     hzlBench_RunServerProcessReceived},
+    {"Handshake", false, true, NULL, hzlBench_RunHandshake},
+    {"ForceSessionRenewal", false, false, NULL, hzlBench_RunForceSessionRenewal},
+};
+#define HZL_BENCH_OPS_AMOUNT (sizeof(gOps) / sizeof(gOps[0]))
+
+/**
+ * @internal
+ * Measures one operation for one GID and length: best ns/op over the repetitions and the
+ * first error code encountered, if any.
+ */
+static void
+hzlBench_Measure(hzlBench_Result_t* const result, const hzlBench_Op_t* const op,
+                 const hzl_Gid_t gid, const size_t len)
+{
+    result->nsPerOp = 0.0;
+    result->err = HZL_OK;
+    for (unsigned long r = 0U; r < gRepetitions && result->err == HZL_OK; r++)
+    {
+        hzlBench_Reset();
+        if (op->prepare != NULL)
+        {
+            result->err = (int) op->prepare(gid, len);
+            if (result->err != HZL_OK)
+            {
+                break;
+            }
+        }
+        hzl_Err_t err = HZL_OK;
+        const uint64_t start = hzlBench_NowNanos();
+        for (size_t i = 0U; i < gIterations && err == HZL_OK; i++)
+        {
+            err = op->run(gid, len, i);
+        }
+        const double nsPerOp = (double) (hzlBench_NowNanos() - start) / (double) gIterations;
+        result->err = (int) err;
+        if (r == 0U || nsPerOp < result->nsPerOp)
+        {
+            result->nsPerOp = nsPerOp;
+        }
+    }
+}
+
+/**
+ * @internal
+ * Reads the results of a previous run. Only the result lines are parsed, as written by
+ * hzlBench_PrintResult().
+ */
+static void
+hzlBench_LoadBaseline(const char* const path)
+{
+    FILE* const file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    size_t capacity = 0U;
+    char line[HZL_BENCH_LINE_MAX_LEN];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        hzlBench_Result_t entry;
+        if (sscanf(line, " {\"op\": \"%63[^\"]\", \"gid\": %u, \"len\": %u, \"ns_per_op\": %lf, "
+                         "\"err\": %d}",
+                   entry.op, &entry.gid, &entry.len, &entry.nsPerOp, &entry.err) != 5)
+        {
+            continue;
+        }
+        if (gBaselineAmount == capacity)
+        {
+            capacity = capacity ? capacity * 2U : 256U;
+            gBaseline = realloc(gBaseline, capacity * sizeof(gBaseline[0]));
+            if (gBaseline == NULL)
+            {
+                fprintf(stderr, "Out of memory\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        gBaseline[gBaselineAmount++] = entry;
+    }
+    fclose(file);
+}
+
+/**
+ * @internal
+ * Compares the result to the baseline entry of the same operation, GID and length, if any.
+ * Returns true and reports it to stderr in case of regression: slower beyond the threshold or
+ * a different error code.
+ */
+static bool
+hzlBench_IsRegression(const hzlBench_Result_t* const result)
+{
+    for (size_t i = 0U; i < gBaselineAmount; i++)
+    {
+        const hzlBench_Result_t* const base = &gBaseline[i];
+        if (strcmp(base->op, result->op) != 0 || base->gid != result->gid
+            || base->len != result->len)
+        {
+            continue;
+        }
+        if (base->err != result->err)
+        {
+            fprintf(stderr, "REGRESSION %s gid=%u len=%u: err %d -> %d\n",
+                    result->op, result->gid, result->len, base->err, result->err);
+            return true;
+        }
+        const double changePercent = (result->nsPerOp / base->nsPerOp - 1.0) * 100.0;
+        if (result->err == HZL_OK && changePercent > gThresholdPercent)
+        {
+            fprintf(stderr, "REGRESSION %s gid=%u len=%u: %.1f -> %.1f ns/op (+%.1f%%)\n",
+                    result->op, result->gid, result->len, base->nsPerOp, result->nsPerOp,
+                    changePercent);
+            return true;
+        }
+        return false;
+    }
+    return false;  // New measurement, nothing to compare to.
+}
+
+static void
+hzlBench_PrintResult(const hzlBench_Result_t* const result, const bool isFirst)
+{
+    printf("%s    {\"op\": \"%s\", \"gid\": %u, \"len\": %u, \"ns_per_op\": %.1f, \"err\": %d}",
+           isFirst ? "" : ",\n", result->op, result->gid, result->len, result->nsPerOp,
+           result->err);
+}
+
+/** @internal ABI the sizes measured with sizeof() hold for. */
+#if defined(__x86_64__)
+#define HZL_BENCH_HOST_ABI "host x86_64"
+#elif defined(__aarch64__)
+#define HZL_BENCH_HOST_ABI "host aarch64"
+#elif defined(__i386__)
+#define HZL_BENCH_HOST_ABI "host i386"
+#elif defined(__arm__)
+#define HZL_BENCH_HOST_ABI "host arm"
+#else
+#define HZL_BENCH_HOST_ABI "host unknown"
+#endif
+
+/**
+ * @internal
+ * Sections of the Server configuration object compiled for the S32K144, as printed by
+ * arm-none-eabi-size. All 0 if not measured.
+ */
+typedef struct hzlBench_TargetSize
+{
+    unsigned long text;
+    unsigned long data;
+    unsigned long bss;
+} hzlBench_TargetSize_t;
+
+/**
+ * @internal
+ * Memory check instead of the benchmark: brings every Group of the configuration to an
+ * established session at the same time, exchanges one secured frame in each direction per
+ * Group, then prints the RAM and flash the Server configuration takes.
+ *
+ * Only the Group states (bss) and the context (data) are in RAM, the configurations are const
+ * and stay in flash. With the sizes of the configuration compiled for the S32K144 the figures
+ * are those of the target. Otherwise they are sizeof() on the host, whose ABI is printed along:
+ * the configurations hold pointers, so at least the flash differs from the target. Fails if any
+ * Group does not work or if the RAM does not fit into the budget.
+ */
+static int
+hzlBench_CheckRam(const unsigned long budgetBytes, const hzlBench_TargetSize_t* const target)
+{
+    const hzl_ServerCtx_t* const server = &hzlBench_CtxServer;
+    const size_t groups = server->serverConfig->amountOfGroups;
+    const size_t clients = server->serverConfig->amountOfClients;
+    size_t groupsVerified = 0U;
+    size_t groupsWithoutClient = 0U;
+    hzlBench_Reset();
+    for (size_t g = 0U; g < groups; g++)
+    {
+        const hzl_Gid_t gid = server->groupConfigs[g].gid;
+        gClient = NULL;
+        for (size_t c = 0U; c < HZL_BENCH_CLIENTS_AMOUNT && gClient == NULL; c++)
+        {
+            if (hzlBench_ClientIsInGroup(gClients[c].ctx, gid))
+            {
+                gClient = &gClients[c];
+            }
+        }
+        if (gClient == NULL)
+        {
+            groupsWithoutClient++;
+            continue;
+        }
+        hzl_Err_t err = hzl_ServerBuildSecuredFd(&gFrames[0], &hzlBench_CtxServer,
+                                                 gPayload, 8U, gid);
+        if (err == HZL_OK)
+        {
+            err = hzlBench_RunClientProcessReceived(gid, 8U, 0U);
+        }
+        if (err == HZL_OK)
+        {
+            err = hzl_ClientBuildSecuredFd(&gFrames[0], gClient->ctx, gPayload, 8U, gid);
+        }
+        if (err == HZL_OK)
+        {
+            err = hzlBench_RunServerProcessReceived(gid, 8U, 0U);
+        }
+        if (err == HZL_OK)
+        {
+            groupsVerified++;
+        }
+        else
+        {
+            fprintf(stderr, "GID %u does not work, err=%d\n", (unsigned) gid, (int) err);
+        }
+    }
+    const bool isTarget = target->bss > 0U;
+    const size_t ramBytesPerGroup = isTarget ? target->bss / groups
+                                             : sizeof(hzl_ServerGroupState_t);
+    const size_t ramBytes = isTarget ? target->data + target->bss
+                                     : groups * sizeof(hzl_ServerGroupState_t);
+    const size_t flashBytes = isTarget ? target->text + target->data
+                                       : sizeof(hzl_ServerConfig_t)
+                                         + clients * sizeof(hzl_ServerClientConfig_t)
+                                         + groups * sizeof(hzl_ServerGroupConfig_t);
+    printf("{\n  \"clients\": %zu,\n  \"groups\": %zu,\n  \"groups_verified\": %zu,\n"
+           "  \"abi\": \"%s\",\n  \"ram_bytes_per_group\": %zu,\n  \"ram_bytes\": %zu,\n"
+           "  \"ram_budget_bytes\": %lu,\n  \"flash_bytes\": %zu\n}\n",
+           clients, groups, groupsVerified, isTarget ? "arm-none-eabi" : HZL_BENCH_HOST_ABI,
+           ramBytesPerGroup, ramBytes, budgetBytes, flashBytes);
+    if (ramBytes > budgetBytes)
+    {
+        fprintf(stderr, "The Group states take %zu bytes of RAM, over the budget of %lu\n",
+                ramBytes, budgetBytes);
+        return EXIT_FAILURE;
+    }
+    return (groupsVerified + groupsWithoutClient == groups) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int
+main(const int argc, const char* const argv[])
+{
+    const char* baselinePath = NULL;
+    long ramBudgetBytes = -1;
+    hzlBench_TargetSize_t targetSize = {0U, 0U, 0U};
+    bool isTargetSizeValid = true;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-n") == 0)
+        {
+            gIterations = strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-r") == 0)
+        {
+            gRepetitions = strtoul(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-b") == 0)
+        {
+            baselinePath = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-t") == 0)
+        {
+            gThresholdPercent = strtod(argv[i + 1], NULL);
+        }
+        else if (strcmp(argv[i], "-G") == 0)
+        {
+            gOnlyGid = strtol(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-l") == 0)
+        {
+            gOnlyLen = strtol(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-m") == 0)
+        {
+            ramBudgetBytes = strtol(argv[i + 1], NULL, 10);
+        }
+        else if (strcmp(argv[i], "-T") == 0)
+        {
+            isTargetSizeValid = sscanf(argv[i + 1], "%lu %lu %lu", &targetSize.text,
+                                       &targetSize.data, &targetSize.bss) == 3;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (argc % 2 == 0 || gIterations == 0U || gRepetitions == 0U || !isTargetSizeValid)
+    {
+        fprintf(stderr, "Usage: %s [-n iterations] [-r repetitions] [-b baseline.json] "
+                        "[-t threshold_percent] [-G gid] [-l len] [-m ram_budget_bytes] "
+                        "[-T \"target_text target_data target_bss\"]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (baselinePath != NULL)
+    {
+        hzlBench_LoadBaseline(baselinePath);
+    }
+    gFrames = calloc(gIterations, sizeof(gFrames[0]));
+    if (gFrames == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    if (ramBudgetBytes >= 0)
+    {
+        const int result = hzlBench_CheckRam((unsigned long) ramBudgetBytes, &targetSize);
+        free(gFrames);
+        return result;
+    }
+    const hzl_ServerCtx_t* const server = &hzlBench_CtxServer;
+    printf("{\n  \"hazelnet\": \"%s\",\n  \"cbs\": \"%s\",\n  \"clients\": %u,\n"
+           "  \"groups\": %u,\n  \"iterations\": %lu,\n  \"repetitions\": %lu,\n"
+           "  \"results\": [\n",
+           HZL_VERSION, HZL_CBS_PROTOCOL_VERSION_SUPPORTED,
+           (unsigned) server->serverConfig->amountOfClients,
+           (unsigned) server->serverConfig->amountOfGroups, gIterations, gRepetitions);
+    size_t regressions = 0U;
+    bool isFirst = true;
+    for (hzl_Gid_t g = 0U; g < server->serverConfig->amountOfGroups; g++)
+    {
+        const hzl_Gid_t gid = server->groupConfigs[g].gid;
+        if (gOnlyGid >= 0 && gid != gOnlyGid)
+        {
+            continue;
+        }
+        gClient = NULL;
+        for (size_t c = 0U; c < HZL_BENCH_CLIENTS_AMOUNT && gClient == NULL; c++)
+        {
+            if (hzlBench_ClientIsInGroup(gClients[c].ctx, gid))
+            {
+                gClient = &gClients[c];
+            }
+        }
+        for (size_t o = 0U; o < HZL_BENCH_OPS_AMOUNT; o++)
+        {
+            const hzlBench_Op_t* const op = &gOps[o];
+            if (op->needsClient && gClient == NULL)
+            {
+                continue;
+            }
+            const size_t maxLen = op->sweepsLen ? HZL_BENCH_PAYLOAD_MAX_LEN : 0U;
+            for (size_t len = 0U; len <= maxLen; len++)
+            {
+                if (op->sweepsLen && gOnlyLen >= 0 && (long) len != gOnlyLen)
+                {
+                    continue;
+                }
+                hzlBench_Result_t result;
+                snprintf(result.op, sizeof(result.op), "%s", op->name);
+                result.gid = gid;
+                result.len = (unsigned) len;
+                hzlBench_Measure(&result, op, gid, len);
+                hzlBench_PrintResult(&result, isFirst);
+                isFirst = false;
+                regressions += hzlBench_IsRegression(&result);
+            }
+        }
+    }
+    printf("\n  ]\n}\n");
+    free(gFrames);
+    free(gBaseline);
+    if (baselinePath != NULL)
+    {
+        fprintf(stderr, "%zu regressions against %s (threshold %.1f%%)\n",
+                regressions, baselinePath, gThresholdPercent);
+    }
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
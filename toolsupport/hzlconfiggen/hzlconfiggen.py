@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+# Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+# <https://matjaz.it>. All rights reserved.
+# SPDX-License-Identifier: BSD-3-Clause
+
+"""Build-time generator of Hazelnet Server configuration sources for the platform.
+
+Subcommands:
+
+- ``filter SERVER_C OUT_C``: reads a Server configuration generated by hzlconfig
+  (e.g. ``Sources/hzlconfig/hzl_HardcodedConfigServer.c``) and writes the
+  table of the SIDs each SID exchanges frames with, from which every node
+  programs the CAN ID acceptance filters of its FLEXCAN mailboxes
+  (``hzlPlatform_CanFilter.h``): the Server hears all Clients, a Client hears
+  the Server and the other members of its Groups.
+- ``scaled --clients C --groups G OUT_DIR``: writes a Server configuration with
+  C Clients (SIDs 1..C) and G Groups (GIDs 0..G-1, every Client in every Group)
+  and the Client configuration of each SID. Same format as hzlconfig, with
+  dummy long-term keys: for benchmarks and scaling tests only.
+
+Only the Python standard library is used.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+CLIENTS_MAX = 32  # Bits of clientSidsInGroupBitmap
+GROUPS_MAX = 255  # hzl_Gid_t amountOfGroups
+SIDS_AMOUNT = CLIENTS_MAX + 1  # SID 0 is the Server
+
+LICENSE = """\
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+"""
+
+
+def fail(message):
+    sys.exit("hzlconfiggen: " + message)
+
+
+def filter_source(sids, bitmaps, origin):
+    """Bitmap of the SIDs each SID hears: bit s set for SID s."""
+    if len(sids) > CLIENTS_MAX or any(not 1 <= sid <= CLIENTS_MAX for sid in sids):
+        fail("expected up to %d SIDs in 1..%d, got %s" % (CLIENTS_MAX, CLIENTS_MAX, sids))
+    peers = [0] * SIDS_AMOUNT
+    for sid in sids:
+        peers[0] |= 1 << sid
+        peers[sid] |= 1 << 0
+    for bitmap in bitmaps:
+        # Bit i of clientSidsInGroupBitmap is the Client with SID i+1.
+        members = [sid for sid in sids if bitmap & (1 << (sid - 1))]
+        for sid in members:
+            for other in members:
+                if other != sid:
+                    peers[sid] |= 1 << other
+    return LICENSE + """
+/**
+ * @file
+ * SIDs each SID exchanges frames with, to compute the CAN ID acceptance filters,
+ * see hzlPlatform_CanFilter.h.
+ *
+ * AUTO-GENERATED FILE by toolsupport/hzlconfiggen from %s
+ * (%d Clients, %d Groups). Regenerate it whenever that file changes.
+ */
+
+#include "hzlPlatform_CanFilter.h"
+
+const uint64_t hzlPlatform_CanFilterPeersBySid[HZL_PLATFORM_CANFILTER_SIDS_AMOUNT] =
+{
+%s
+};
+""" % (origin, len(sids), len(bitmaps),
+       "\n".join("    0x%09XU,  // SID %d" % (bits, sid) for sid, bits in enumerate(peers)))
+
+
+def parse_server_config(text):
+    """GIDs, SIDs and Group member bitmaps of a hzlconfig Server configuration, in the order of
+    the arrays."""
+    clients = re.search(r"clientConfigs\[[^\]]*\]\s*=\s*\{(.*?)\n\};", text, re.S)
+    groups = re.search(r"groupConfigs\[[^\]]*\]\s*=\s*\{(.*?)\n\};", text, re.S)
+    if clients is None or groups is None:
+        fail("clientConfigs[] or groupConfigs[] not found")
+    sids = [int(v, 0) for v in re.findall(r"\.sid\s*=\s*(\w+)", clients.group(1))]
+    gids = [int(v, 0) for v in re.findall(r"\.gid\s*=\s*(\w+)", groups.group(1))]
+    bitmaps = [int(v, 0) for v in
+               re.findall(r"\.clientSidsInGroupBitmap\s*=\s*(\w+)", groups.group(1))]
+    if len(bitmaps) != len(gids):
+        fail("expected a clientSidsInGroupBitmap for each of the %d Groups" % len(gids))
+    return gids, sids, bitmaps
+
+
+def dummy_ltk(sid):
+    return [(sid * 16 + i) & 0xFF for i in range(16)]
+
+
+def field_block(ltk):
+    return "\n".join("        0x%02X," % b for b in ltk)
+
+
+def scaled_server_source(clients, groups):
+    client_entries = ",\n".join("""{
+    .sid = %d,
+    .ltk =
+    {
+%s
+    },
+}""" % (sid, field_block(dummy_ltk(sid))) for sid in range(1, clients + 1))
+    bitmap = (1 << clients) - 1
+    group_entries = ",\n".join("""{
+    .maxCtrnonceDelayMsgs = 20,
+    .ctrNonceUpperLimit = 0xFF0000,
+    .sessionDurationMillis = 30000,
+    .delayBetweenRenNotificationsMillis = 250,
+    .clientSidsInGroupBitmap = 0x%08X,
+    .maxSilenceIntervalMillis = 5000,
+    .gid = %d,
+    .unusedPadding =
+    {
+        0xAA,
+    },
+}""" % (0xFFFFFFFF if gid == 0 else bitmap, gid) for gid in range(groups))
+    return LICENSE + """
+/**
+ * @file
+ * Compile-time constant configuration with static memory for the Hazelnet
+ * context state for a Server with %d Clients and %d Groups.
+ *
+ * AUTO-GENERATED FILE by toolsupport/hzlconfiggen. Dummy keys, for benchmarks only.
+ */
+
+#include "hzl.h"
+#include "hzl_Server.h"
+
+#define AMOUNT_OF_CLIENTS %dU
+#define AMOUNT_OF_GROUPS %dU
+
+static const hzl_ServerConfig_t serverConfig =
+{
+    .amountOfGroups = %d,
+    .amountOfClients = %d,
+    .headerType = 0,
+};
+
+static const hzl_ServerClientConfig_t clientConfigs[AMOUNT_OF_CLIENTS] =
+{
+%s
+};
+
+static const hzl_ServerGroupConfig_t groupConfigs[AMOUNT_OF_GROUPS] =
+{
+%s
+};
+
+static hzl_ServerGroupState_t groupStates[AMOUNT_OF_GROUPS];
+
+hzl_ServerCtx_t hzlCtx0 =
+{
+    .serverConfig = &serverConfig,
+    .clientConfigs = clientConfigs,
+    .groupConfigs = groupConfigs,
+    .groupStates = groupStates,
+};
+""" % (clients, groups, clients, groups, groups, clients, client_entries, group_entries)
+
+
+def scaled_client_source(sid, groups):
+    group_entries = ",\n".join("""{
+    .maxCtrnonceDelayMsgs = 20,
+    .maxSilenceIntervalMillis = 5000,
+    .sessionRenewalDurationMillis = 2000,
+    .gid = %d,
+    .unusedPadding =
+    {
+        0xAA,
+        0xAA,
+        0xAA,
+    },
+}""" % gid for gid in range(groups))
+    return LICENSE + """
+/**
+ * @file
+ * Compile-time constant configuration with static memory for the Hazelnet
+ * context state for the Client with SID %d, member of %d Groups.
+ *
+ * AUTO-GENERATED FILE by toolsupport/hzlconfiggen. Dummy keys, for benchmarks only.
+ */
+
+#include "hzl.h"
+#include "hzl_Client.h"
+
+#define AMOUNT_OF_GROUPS %dU
+
+static const hzl_ClientConfig_t clientConfig =
+{
+    .timeoutReqToResMillis = 10000,
+    .ltk =
+    {
+%s
+    },
+    .sid = %d,
+    .headerType = 0,
+    .amountOfGroups = %d,
+    .unusedPadding =
+    {
+        0xAA,
+    },
+};
+
+static const hzl_ClientGroupConfig_t groupConfigs[AMOUNT_OF_GROUPS] =
+{
+%s
+};
+
+static hzl_ClientGroupState_t groupStates[AMOUNT_OF_GROUPS];
+
+hzl_ClientCtx_t hzlCtx0 =
+{
+    .clientConfig = &clientConfig,
+    .groupConfigs = groupConfigs,
+    .groupStates = groupStates,
+};
+""" % (sid, groups, groups, field_block(dummy_ltk(sid)), sid, groups, group_entries)
+
+
+def write(path, content):
+    with open(path, "w", encoding="utf-8") as file:
+        file.write(content)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    filter_ = commands.add_parser("filter", help="CAN ID filter table of a Server configuration")
+    filter_.add_argument("server_c")
+    filter_.add_argument("out_c")
+    scaled = commands.add_parser("scaled", help="Server and Client configurations of any size")
+    scaled.add_argument("--clients", type=int, default=CLIENTS_MAX)
+    scaled.add_argument("--groups", type=int, required=True)
+    scaled.add_argument("out_dir")
+    args = parser.parse_args()
+    if args.command == "filter":
+        with open(args.server_c, encoding="utf-8") as file:
+            _, sids, bitmaps = parse_server_config(file.read())
+        write(args.out_c, filter_source(sids, bitmaps, os.path.basename(args.server_c)))
+    else:
+        if not 1 <= args.clients <= CLIENTS_MAX or not 1 <= args.groups <= GROUPS_MAX:
+            fail("up to %d Clients and %d Groups" % (CLIENTS_MAX, GROUPS_MAX))
+        os.makedirs(args.out_dir, exist_ok=True)
+        write(os.path.join(args.out_dir, "hzl_HardcodedConfigServer.c"),
+              scaled_server_source(args.clients, args.groups))
+        for sid in range(1, args.clients + 1):
+            write(os.path.join(args.out_dir, "hzl_HardcodedConfigClient%d.c" % sid),
+                  scaled_client_source(sid, args.groups))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,272 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host decoder of the log messages the platform writes to the bus: turns the binary log events
+ * of hzlPlatform_LogEvents.h back into text, passing the plain ASCII messages through.
+ *
+ * Reads the captured frames from stdin, one per line, in any of these formats:
+ * - `candump -L` log: `(1652000000.000000) can0 7FF##1C0000104`
+ * - `candump` default output: `can0  7FF  [8]  C0 00 00 01 04 00 00 00`
+ * - just the hex bytes: `C0 00 00 01 04` or `C000000104`
+ *
+ * Usage: `hzllogdecoder [-H header_bytes] < capture.log`
+ *
+ * The first `header_bytes` of every frame are the CBS header and are skipped: 3 by default,
+ * matching the header type 0 (GID, SID, PTY) used by the configurations in Sources/hzlconfig.
+ * Pass `-H 0` if the lines contain only the UAD payload, as printed by CBS-aware sniffers.
+ * Frames that are not log messages produce garbage, filter them beforehand by PTY if needed.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hzlPlatform_LatencyHist.h"
+#include "hzlPlatform_LogEvents.h"
+
+#define HZL_LOGDECODER_DEFAULT_HEADER_LEN 3U
+#define HZL_LOGDECODER_FRAME_MAX_LEN 64U
+#define HZL_LOGDECODER_LINE_MAX_LEN 512U
+#define HZL_LOGDECODER_TEXT_MAX_LEN 256U
+
+#define HZL_LOGDECODER_ARGS_AMOUNT_ENTRY(name, argsAmount, format) argsAmount,
+#define HZL_LOGDECODER_FORMAT_ENTRY(name, argsAmount, format) format,
+#define HZL_LOGDECODER_LATENCY_OP_ENTRY(name, printable) printable,
+
+static const unsigned gArgsAmount[HZL_PLATFORM_LOG_EVENT_AMOUNT] =
+{
+    0U,  // HZL_PLATFORM_LOG_EVENT_INVALID
+    HZL_PLATFORM_LOG_EVENTS(HZL_LOGDECODER_ARGS_AMOUNT_ENTRY)
+};
+
+static const char* const gFormats[HZL_PLATFORM_LOG_EVENT_AMOUNT] =
+{
+    "INVALID",
+    HZL_PLATFORM_LOG_EVENTS(HZL_LOGDECODER_FORMAT_ENTRY)
+};
+
+static const char* const gLatencyOps[HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT] =
+{
+    HZL_PLATFORM_LATENCY_HIST_OPS(HZL_LOGDECODER_LATENCY_OP_ENTRY)
+};
+
+/**
+ * @internal
+ * Decodes the arguments of a latency histogram log event: operation, first bucket and the
+ * uint16_t counters of the following buckets. Only the non-empty buckets are printed, as
+ * " 2^k:count", where k is the log2 of the cycles.
+ */
+static void
+hzlLogDecoder_DecodeLatencyHist(char* const text, const size_t textSize, const uint8_t* const args)
+{
+    char buckets[HZL_LOGDECODER_TEXT_MAX_LEN];
+    size_t bucketsLen = 0U;
+    buckets[0] = '\0';
+    for (unsigned i = 0U; i < HZL_PLATFORM_LATENCY_HIST_BUCKETS_PER_LOG; i++)
+    {
+        const unsigned count = args[2U + 2U * i] | (unsigned) args[3U + 2U * i] << 8U;
+        if (count > 0U && bucketsLen < sizeof(buckets))
+        {
+            bucketsLen += (size_t) snprintf(&buckets[bucketsLen], sizeof(buckets) - bucketsLen,
+                                            " 2^%u:%u", args[1] + i, count);
+        }
+    }
+    const char* const op = args[0] < HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT
+                           ? gLatencyOps[args[0]] : "<unknown>";
+    snprintf(text, textSize, gFormats[HZL_PLATFORM_LOG_EVENT_LATENCY_HIST], op, buckets);
+}
+
+/**
+ * @internal
+ * Decodes one log message into text. Returns the amount of bytes of the message that were
+ * consumed, so any trailing CAN FD padding can be ignored.
+ */
+static size_t
+hzlLogDecoder_Decode(char* const text, const size_t textSize,
+                     const uint8_t* const msg, const size_t msgLen)
+{
+    if (msgLen == 0U)
+    {
+        snprintf(text, textSize, "<empty>");
+        return 0U;
+    }
+    if (msg[0] > HZL_PLATFORM_LOG_EVENT_ID_MAX)
+    {
+        // Plain ASCII message, possibly padded with zeros.
+        size_t len = 0U;
+        while (len < msgLen && len + 1U < textSize && msg[len] != '\0')
+        {
+            text[len] = isprint(msg[len]) ? (char) msg[len] : '.';
+            len++;
+        }
+        text[len] = '\0';
+        return len;
+    }
+    if (msg[0] >= HZL_PLATFORM_LOG_EVENT_AMOUNT || msg[0] == HZL_PLATFORM_LOG_EVENT_INVALID)
+    {
+        snprintf(text, textSize, "<unknown log event 0x%02X>", msg[0]);
+        return 1U;
+    }
+    const unsigned argsAmount = gArgsAmount[msg[0]];
+    if (msgLen < 1U + argsAmount)
+    {
+        snprintf(text, textSize, "<truncated log event 0x%02X>", msg[0]);
+        return msgLen;
+    }
+    if (msg[0] == HZL_PLATFORM_LOG_EVENT_REPEATED)
+    {
+        char repeated[HZL_LOGDECODER_TEXT_MAX_LEN];
+        const size_t repeatedLen = hzlLogDecoder_Decode(repeated, sizeof(repeated),
+                                                        &msg[1U + argsAmount],
+                                                        msgLen - 1U - argsAmount);
+        snprintf(text, textSize, gFormats[msg[0]], repeated, msg[1] | (unsigned) msg[2] << 8U);
+        return 1U + argsAmount + repeatedLen;
+    }
+    if (msg[0] == HZL_PLATFORM_LOG_EVENT_LATENCY_HIST)
+    {
+        hzlLogDecoder_DecodeLatencyHist(text, textSize, &msg[1]);
+        return 1U + argsAmount;
+    }
+    unsigned args[3U] = {0U, 0U, 0U};
+    for (unsigned i = 0U; i < argsAmount && i < 3U; i++)
+    {
+        args[i] = msg[1U + i];
+    }
+    snprintf(text, textSize, gFormats[msg[0]], args[0], args[1], args[2]);
+    return 1U + argsAmount;
+}
+
+/**
+ * @internal
+ * Parses a hex string (spaces allowed between the bytes) into bytes.
+ * Returns the amount of parsed bytes, stopping at the first non-hex character.
+ */
+static size_t
+hzlLogDecoder_ParseHex(const char* str, uint8_t* const bytes, const size_t bytesSize)
+{
+    size_t len = 0U;
+    while (len < bytesSize)
+    {
+        while (*str == ' ' || *str == '\t')
+        {
+            str++;
+        }
+        if (!isxdigit((unsigned char) str[0]) || !isxdigit((unsigned char) str[1]))
+        {
+            break;
+        }
+        const char pair[3] = {str[0], str[1], '\0'};
+        bytes[len++] = (uint8_t) strtoul(pair, NULL, 16);
+        str += 2;
+    }
+    return len;
+}
+
+/**
+ * @internal
+ * Finds the frame payload in a captured line, in any of the supported formats.
+ * Returns the start of the hex payload and sets the CAN ID, if present in the line.
+ */
+static const char*
+hzlLogDecoder_FindPayload(const char* const line, char* const canId, const size_t canIdSize)
+{
+    canId[0] = '\0';
+    const char* hash = strchr(line, '#');
+    if (hash != NULL)
+    {
+        // candump -L: "(timestamp) interface ID#payload" or "ID##<flags>payload" for CAN FD.
+        const char* idStart = hash;
+        while (idStart > line && isxdigit((unsigned char) idStart[-1]))
+        {
+            idStart--;
+        }
+        snprintf(canId, canIdSize, "%.*s", (int) (hash - idStart), idStart);
+        return (hash[1] == '#' && hash[2] != '\0') ? hash + 3 : hash + 1;
+    }
+    const char* bracket = strchr(line, ']');
+    if (bracket != NULL)
+    {
+        // candump: "interface  ID  [length]  payload"
+        const char* idEnd = strchr(line, '[');
+        while (idEnd > line && idEnd[-1] == ' ')
+        {
+            idEnd--;
+        }
+        const char* idStart = idEnd;
+        while (idStart > line && isxdigit((unsigned char) idStart[-1]))
+        {
+            idStart--;
+        }
+        snprintf(canId, canIdSize, "%.*s", (int) (idEnd - idStart), idStart);
+        return bracket + 1;
+    }
+    return line;
+}
+
+int
+main(const int argc, char* const argv[])
+{
+    size_t headerLen = HZL_LOGDECODER_DEFAULT_HEADER_LEN;
+    if (argc == 3 && strcmp(argv[1], "-H") == 0)
+    {
+        headerLen = strtoul(argv[2], NULL, 10);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "Usage: %s [-H header_bytes] < capture.log\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char line[HZL_LOGDECODER_LINE_MAX_LEN];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        char canId[16U];
+        uint8_t frame[HZL_LOGDECODER_FRAME_MAX_LEN];
+        const char* const payload = hzlLogDecoder_FindPayload(line, canId, sizeof(canId));
+        const size_t frameLen = hzlLogDecoder_ParseHex(payload, frame, sizeof(frame));
+        if (frameLen <= headerLen)
+        {
+            continue;  // Not a frame or no payload.
+        }
+        char text[HZL_LOGDECODER_TEXT_MAX_LEN];
+        hzlLogDecoder_Decode(text, sizeof(text), &frame[headerLen], frameLen - headerLen);
+        if (canId[0] != '\0')
+        {
+            printf("%s %s\n", canId, text);
+        }
+        else
+        {
+            printf("%s\n", text);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Host (Linux) simulation of the Hazelnet Demo Platform: virtual CAN FD bus shared by all
+ * simulated nodes, and the entry points of the nodes themselves.
+ *
+ * Each node (Server, Alice, Bob, Charlie) is the unmodified platform layer from `Sources/`
+ * compiled with its `HZL_PLATFORM_ROLE_*` macro, linked against the simulated peripherals of
+ * hzlSim_Sdk.c and turned into a single relocatable object where only its start function is
+ * visible. All nodes share one FreeRTOS (POSIX port) scheduler, so each TaskHzl is a thread of
+ * the same process.
+ */
+
+#ifndef HZL_SIM_H_
+#define HZL_SIM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hzlPlatform_Telemetry.h"
+#include "hzlPlatform_CpuStats.h"
+#include "hzlPlatform_LatencyHist.h"
+
+/**
+ * Amount of virtual buses, one per FLEXCAN instance used by the platform layer
+ * (#HZL_PLATFORM_BUSES_AMOUNT). Every node is attached to all of them.
+ */
+#if defined(HZL_PLATFORM_BUSES_AMOUNT)
+#define HZL_SIM_BUSES_AMOUNT HZL_PLATFORM_BUSES_AMOUNT
+#else
+#define HZL_SIM_BUSES_AMOUNT 1U
+#endif
+
+/** Maximum amount of nodes that can be attached to the virtual bus: enough for the fleet. */
+#define HZL_SIM_BUS_MAX_PORTS 40U
+
+/** Amount of frames each bus can hold while they wait to be delivered. */
+#define HZL_SIM_BUS_QUEUE_LEN 64U
+
+/** Frames of each burst of the data load generator, see hzlSim_BusLoadStart(). */
+#define HZL_SIM_LOAD_BURST_LEN 16U
+
+/** Priority of the bus tasks. Higher than any platform task, like a peripheral would be. */
+#define HZL_SIM_TASK_PRIORITY_BUS (configMAX_PRIORITIES - 1U)
+
+/**
+ * Nominal bit of the frames of the traffic generators, 500 kbit/s like the FLEXCAN of the nodes.
+ */
+#define HZL_SIM_BUS_NOMINAL_BIT_NANOS 2000U
+
+/**
+ * Bit durations of a CAN FD frame, as programmed into the FLEXCAN of its transmitter.
+ */
+typedef struct hzlSim_BitTiming
+{
+    uint32_t nominalBitNanos;  ///< Arbitration phase and frame end.
+    uint32_t dataBitNanos;  ///< Data phase, equal to the nominal bit without Bit Rate Switch.
+} hzlSim_BitTiming_t;
+
+/**
+ * A CAN FD frame travelling on the virtual bus.
+ */
+typedef struct hzlSim_Frame
+{
+    uint64_t txTimestampNanos;  ///< When the frame was handed to the bus by the transmitter.
+    uint32_t busNanos;  ///< Time the frame occupies the bus, see hzlSim_BusFrameNanos().
+    uint32_t canId;
+    uint8_t dataLen;
+    uint8_t data[64];
+} hzlSim_Frame_t;
+
+typedef struct hzlSim_Port hzlSim_Port_t;
+
+/**
+ * Attachment point of a node to the virtual buses, with the statistics collected about it,
+ * summed over all buses.
+ *
+ * The port is allocated by the simulation main and filled in by the node start function.
+ */
+struct hzlSim_Port
+{
+    /** Human readable name of the node, set by the node. */
+    const char* name;
+    /**
+     * Called by the task of the given bus for every frame transmitted on it by ANY port, with the
+     * scheduler suspended, telling whether it was THIS port. It acts as the FLEXCAN interrupt
+     * service routine of the node.
+     */
+    void (* deliver)(hzlSim_Port_t* port, uint8_t bus, const hzlSim_Frame_t* frame,
+                     bool isOwnFrame);
+    /**
+     * Called by the task of the given bus, with the scheduler suspended, once a frame
+     * transmitted on it by THIS port was delivered to all ports. It acts as the FLEXCAN
+     * TX-complete interrupt.
+     */
+    void (* txComplete)(hzlSim_Port_t* port, uint8_t bus, uint8_t txMailboxIdx);
+    /** Returns the current color of the RGB LED of the node, as hzlPlatform_RgbColor_t. */
+    uint32_t (* ledColor)(hzlSim_Port_t* port);
+    /**
+     * Short press of Button 2 of the node: a new handshake on a Client, a Session renewal on the
+     * Server. Callable from any task.
+     */
+    void (* pressButton2)(hzlSim_Port_t* port);
+    /** Frames this node transmitted on the bus. */
+    uint64_t framesTransmitted;
+    /** Frames this node accepted into a reception mailbox. */
+    uint64_t framesReceived;
+    /**
+     * Frames this node transmitted itself and accepted back into a reception mailbox, as the
+     * FLEXCAN does unless its self reception is disabled. Also counted as received.
+     */
+    uint64_t framesSelfReceived;
+    /** Frames this node could not accept because no reception mailbox was armed. */
+    uint64_t framesLostNoMailbox;
+    /**
+     * Frames this node discarded in hardware, without an interrupt, because their CAN ID matched
+     * the acceptance filter of no reception mailbox.
+     */
+    uint64_t framesFilteredInHw;
+    /** Sum of the bus-to-mailbox latencies of the received frames. */
+    uint64_t latencySumNanos;
+    /** Largest bus-to-mailbox latency of the received frames. */
+    uint64_t latencyMaxNanos;
+    /** Run-time counters kept by the platform layer of the node, set by the node. */
+    const volatile hzlPlatform_Telemetry_t* telemetry;
+    /** CPU share of the tasks as seen by the platform layer of the node, set by the node. */
+    const volatile hzlPlatform_CpuStats_t* cpuStats;
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+    /** Latency histograms of the node, indexed by hzlPlatform_LatencyHistOp_t, set by the node. */
+    const volatile hzlPlatform_LatencyHist_t* latencyHists;
+#endif
+};
+
+/**
+ * Signature of the node start functions. Creates the tasks of the node, without starting the
+ * scheduler.
+ */
+typedef void (* hzlSim_NodeStartFunc)(hzlSim_Port_t* port);
+
+void hzlSim_NodeStartServer(hzlSim_Port_t* port);
+void hzlSim_NodeStartAlice(hzlSim_Port_t* port);
+void hzlSim_NodeStartBob(hzlSim_Port_t* port);
+void hzlSim_NodeStartCharlie(hzlSim_Port_t* port);
+
+/**
+ * Applies the given macro to the SID of each Client of the fleet: the Clients 1 to 32 of the
+ * configuration generated by `hzlconfiggen scaled`, each a node built with
+ * `HZL_PLATFORM_ROLE_CLIENT`. Run with the Server instead of the four usual nodes when
+ * `HZL_SIM_FLEET` is defined.
+ */
+#define HZL_SIM_FLEET_SIDS(X) \
+    X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) X(16) \
+    X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(30) X(31) \
+    X(32)
+#define HZL_SIM_FLEET_NODE_START_DECLARATION(sid) \
+    void hzlSim_NodeStartClient##sid(hzlSim_Port_t* port);
+HZL_SIM_FLEET_SIDS(HZL_SIM_FLEET_NODE_START_DECLARATION)
+
+/**
+ * Monotonic host clock in nanoseconds, for statistics only.
+ */
+uint64_t
+hzlSim_NowNanos(void);
+
+/**
+ * Creates the task and the frame queue of each bus. Must be called before any hzlSim_BusAttach().
+ */
+void
+hzlSim_BusInit(void);
+
+/**
+ * Attaches a node to all buses, so it receives all frames transmitted by the other nodes.
+ */
+void
+hzlSim_BusAttach(hzlSim_Port_t* port);
+
+/**
+ * Hands a frame over to the given bus without blocking. Once the frame is carried, the
+ * txComplete function of the source port is called with the bus and the given mailbox index.
+ *
+ * With #HZL_SIM_BUS_BIT_TIMING defined, the bus carries the frames one after the other, each
+ * for the time hzlSim_BusFrameNanos() of its bit timing, so it saturates like a real one.
+ * Otherwise the frames are delivered as soon as possible and their time is only accounted.
+ *
+ * @return true if the frame was accepted by the bus, false if the bus queue is full.
+ */
+bool
+hzlSim_BusTransmit(hzlSim_Port_t* src, uint8_t bus, uint8_t txMailboxIdx, uint32_t canId,
+                   const uint8_t* data, size_t dataLen, const hzlSim_BitTiming_t* bitTiming);
+
+/**
+ * Time a CAN FD frame with a 29-bit CAN ID occupies the bus, from the start of frame to the end
+ * of the intermission: the arbitration phase and the frame end at the nominal bitrate, the
+ * control field, the payload padded to the next CAN FD length and the CRC field at the
+ * data-phase bitrate. Counts the worst case of the dynamic stuff bits, one every 4 bits.
+ *
+ * @param dataLen payload length before the padding, at most 64.
+ */
+uint32_t
+hzlSim_BusFrameNanos(size_t dataLen, const hzlSim_BitTiming_t* bitTiming);
+
+/**
+ * Amount of frames the given bus carried since hzlSim_BusInit().
+ */
+uint64_t
+hzlSim_BusFramesCarried(uint8_t bus);
+
+/**
+ * Sum of the hzlSim_BusFrameNanos() of the frames the given bus carried since hzlSim_BusInit().
+ * Divided by the elapsed time, it is the bus occupancy.
+ */
+uint64_t
+hzlSim_BusOccupiedNanos(uint8_t bus);
+
+/**
+ * From now on, every bus carries the Session renewal notifications (REN) to no node, as if all
+ * Clients missed them: after a renewal of the Server, they keep the previous Session and notice
+ * the renewal only from the security warnings that the new one causes.
+ */
+void
+hzlSim_BusLoseRen(void);
+
+/**
+ * Amount of Session renewal notifications lost on all buses, see hzlSim_BusLoseRen().
+ */
+uint64_t
+hzlSim_BusRenLost(void);
+
+/**
+ * Starts a generator of foreign traffic on every bus: frames from a node that is not part of the
+ * Hazelnet network, with random CAN IDs below the ones of the platform (0x700), as on a bus
+ * shared with other applications. Does nothing if the rate is 0.
+ *
+ * @param framesPerSecond frames transmitted per second on each bus.
+ */
+void
+hzlSim_BusNoiseStart(uint32_t framesPerSecond);
+
+/**
+ * Amount of foreign frames the traffic generator transmitted on all buses.
+ */
+uint64_t
+hzlSim_BusNoiseFramesTransmitted(void);
+
+/**
+ * Starts a generator of application data load on every bus: unsecured data frames (UAD) with
+ * the CAN ID and the SID of the Server, like its log messages, which every Client receives and
+ * processes. They are transmitted in bursts of #HZL_SIM_LOAD_BURST_LEN back-to-back frames,
+ * which fill the RX slots of the Clients faster than they process them. Does nothing if the rate
+ * is 0.
+ *
+ * @param framesPerSecond average frames transmitted per second on each bus.
+ */
+void
+hzlSim_BusLoadStart(uint32_t framesPerSecond);
+
+/**
+ * Amount of data load frames the generator transmitted on all buses.
+ */
+uint64_t
+hzlSim_BusLoadFramesTransmitted(void);
+
+/**
+ * Starts a generator of forged secured frames on every bus: SADFD with random counter nonce,
+ * ciphertext and tag, in the name of the Server and of Alice in turns, as an attacker injecting
+ * junk to provoke security warnings would. They pass the CAN ID filters and fail the
+ * authentication. Does nothing if the rate is 0.
+ *
+ * @param framesPerSecond frames transmitted per second on each bus.
+ */
+void
+hzlSim_BusForgeryStart(uint32_t framesPerSecond);
+
+/**
+ * Amount of forged frames the generator transmitted on all buses.
+ */
+uint64_t
+hzlSim_BusForgeryFramesTransmitted(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_SIM_H_ */
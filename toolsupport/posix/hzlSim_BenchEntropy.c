@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host benchmark of the latency of the random bytes requested by the Hazelnet library through
+ * hzlPlatform_HzlAdapterTrng(), with a mocked CSEc as slow as configured.
+ *
+ * Compares, per request:
+ * - direct generation: the entropy pool is not running, every request waits for the CSEc;
+ * - entropy pool: the real hzlPlatform_Entropy.c, refilled by its low-priority TaskEntropy
+ *   between the requests.
+ *
+ * The requests are spaced as during a burst of handshakes, so the pool has time to refill.
+ *
+ * Usage: `hzlsim_bench_entropy [requests [csec_rnd_micros]]`, 200 requests and 50 us per
+ * CSEc RND command by default.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_Telemetry.h"
+#include "hzlSim.h"
+
+#define HZL_SIM_BENCH_DEFAULT_REQUESTS 200UL
+#define HZL_SIM_BENCH_DEFAULT_CSEC_RND_MICROS 50UL
+/** Random bytes per request: e.g. a Session key and a nonce. */
+#define HZL_SIM_BENCH_REQUEST_LEN 24U
+#define HZL_SIM_BENCH_REQUEST_PERIOD_TICKS 5U
+
+/** @internal Measured latency of one run. */
+typedef struct hzlSim_BenchResult
+{
+    uint64_t sumNanos;
+    uint64_t maxNanos;
+} hzlSim_BenchResult_t;
+
+static unsigned long gRequests = HZL_SIM_BENCH_DEFAULT_REQUESTS;
+static unsigned long gCsecRndMicros = HZL_SIM_BENCH_DEFAULT_CSEC_RND_MICROS;
+static uint64_t gTrngState = 0U;
+
+/**
+ * @internal
+ * Slow mock of the CSEc: busy-waits like the driver polling the CSEc for the command to
+ * complete, then outputs SplitMix64 bytes.
+ */
+status_t
+CSEC_DRV_GenerateRND(uint8_t* const rnd)
+{
+    const uint64_t end = hzlSim_NowNanos() + gCsecRndMicros * 1000U;
+    while (hzlSim_NowNanos() < end)
+    {
+        // Busy-wait.
+    }
+    for (size_t i = 0U; i < 16U; i++)
+    {
+        gTrngState += 0x9E3779B97F4A7C15ULL;
+        rnd[i] = (uint8_t) (gTrngState >> 56U);
+    }
+    return STATUS_SUCCESS;
+}
+
+void
+hzlPlatform_FatalCrashAlternating(const hzlPlatform_RgbColor_t longer,
+                                  const hzlPlatform_RgbColor_t shorter)
+{
+    fprintf(stderr, "FATAL: colors %u,%u\n", (unsigned) longer, (unsigned) shorter);
+    exit(EXIT_FAILURE);
+}
+
+static hzlSim_BenchResult_t
+hzlSim_BenchRequests(void)
+{
+    hzlSim_BenchResult_t result = {0};
+    uint8_t bytes[HZL_SIM_BENCH_REQUEST_LEN];
+    for (unsigned long request = 0U; request < gRequests; request++)
+    {
+        vTaskDelay(HZL_SIM_BENCH_REQUEST_PERIOD_TICKS);
+        const uint64_t start = hzlSim_NowNanos();
+        if (hzlPlatform_HzlAdapterTrng(bytes, sizeof(bytes)) != HZL_OK)
+        {
+            fprintf(stderr, "Cannot generate random bytes\n");
+            exit(EXIT_FAILURE);
+        }
+        const uint64_t nanos = hzlSim_NowNanos() - start;
+        result.sumNanos += nanos;
+        if (nanos > result.maxNanos)
+        {
+            result.maxNanos = nanos;
+        }
+    }
+    return result;
+}
+
+static void
+hzlSim_BenchPrint(const char* const name, const hzlSim_BenchResult_t* const result)
+{
+    printf("%-10s %10.2f us/request avg %10.2f us/request max\n",
+           name,
+           (double) result->sumNanos / (double) gRequests / 1000.0,
+           (double) result->maxNanos / 1000.0);
+}
+
+/**
+ * @internal
+ * Runs the benchmarks within a task with the priority of the TaskHzl, above the TaskEntropy.
+ */
+static void
+hzlSim_TaskBench(void* const unusedParam)
+{
+    (void) unusedParam;
+    const hzlSim_BenchResult_t direct = hzlSim_BenchRequests();
+    hzlPlatform_EntropyInit();
+    vTaskDelay(HZL_SIM_BENCH_REQUEST_PERIOD_TICKS);  // Initial filling.
+    const hzlSim_BenchResult_t pool = hzlSim_BenchRequests();
+    printf("Random bytes: %lu requests of %u B, CSEc RND command %lu us\n",
+           gRequests, HZL_SIM_BENCH_REQUEST_LEN, gCsecRndMicros);
+    hzlSim_BenchPrint("Direct", &direct);
+    hzlSim_BenchPrint("Pool", &pool);
+    printf("Served by the pool: %" PRIu32 "/%lu\n",
+           hzlPlatform_Telemetry.entropyRequestsFromPool, gRequests);
+    printf("Speedup: %.2fx\n", (double) direct.sumNanos / (double) pool.sumNanos);
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+int
+main(const int argc, const char* const argv[])
+{
+    if (argc > 1)
+    {
+        gRequests = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        gCsecRndMicros = strtoul(argv[2], NULL, 10);
+    }
+    if (gRequests == 0U)
+    {
+        gRequests = 1U;
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskBench,
+        "SimBench",
+        configMINIMAL_STACK_SIZE * 4U,
+        NULL,
+        HZL_PLATFORM_TASK_PRIORITY_HZL,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the benchmark task\n");
+        return EXIT_FAILURE;
+    }
+    vTaskStartScheduler();
+    return EXIT_FAILURE;  // The scheduler never returns in the POSIX port.
+}
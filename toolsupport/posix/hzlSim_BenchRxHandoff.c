@@ -0,0 +1,252 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host benchmark of the handover of received CAN FD frames from the FLEXCAN ISR to the TaskHzl.
+ *
+ * Compares, per frame:
+ * - the FreeRTOS queue: the driver receives into a temporary message, which is copied into the
+ *   queue with xQueueSendToBackFromISR() and copied out again with xQueueReceive();
+ * - the SPSC rings of hzlPlatform_Flexcan.c: the driver receives directly into a free slot,
+ *   whose index is handed over and processed in place.
+ *
+ * Both runs include the copy out of the mailbox RAM done by the driver and the reading of
+ * the payload by the task. Frames are handed over in bursts of #HZL_PLATFORM_CANFD_RX_QUEUE_LEN,
+ * as a bus burst would. The absolute figures are of the host CPU, only their ratio is meaningful
+ * for the target.
+ *
+ * Usage: `hzlsim_bench_rx [frames]`, 1000000 frames by default.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HZL_SIM_BENCH_HAS_CYCLES 1
+#endif
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "hzlSim_Sdk.h"
+#include "hzlSim.h"
+#include "hzlPlatform_SpscRing.h"
+
+// Same sizes as in hzlPlatform.h, which cannot be included here as it requires a role.
+#define HZL_SIM_BENCH_RX_QUEUE_LEN 8U
+#define HZL_SIM_BENCH_RX_SLOTS_AMOUNT (HZL_SIM_BENCH_RX_QUEUE_LEN + 6U)
+#define HZL_SIM_BENCH_RX_RING_CAPACITY 16U
+#define HZL_SIM_BENCH_DEFAULT_FRAMES 1000000UL
+#define HZL_SIM_BENCH_PAYLOAD_LEN 64U
+
+/** @internal Measured cost of one run. */
+typedef struct hzlSim_BenchResult
+{
+    uint64_t nanos;
+    uint64_t cycles;
+    uint32_t checksum;
+} hzlSim_BenchResult_t;
+
+static unsigned long gFrames = HZL_SIM_BENCH_DEFAULT_FRAMES;
+/** @internal Content of the mailbox RAM the driver copies from. */
+static volatile flexcan_msgbuff_t gHwMailbox;
+static flexcan_msgbuff_t gRxSlots[HZL_SIM_BENCH_RX_SLOTS_AMOUNT];
+
+static inline uint64_t
+hzlSim_BenchCycles(void)
+{
+#if defined(HZL_SIM_BENCH_HAS_CYCLES)
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+/**
+ * @internal
+ * Copy out of the mailbox RAM, as done by the FLEXCAN driver before calling the callback.
+ */
+static inline void
+hzlSim_BenchDriverReceive(flexcan_msgbuff_t* const destination, const uint32_t frameIdx)
+{
+    gHwMailbox.data[0] = (uint8_t) frameIdx;
+    memcpy(destination, (const void*) &gHwMailbox, sizeof(*destination));
+}
+
+/**
+ * @internal
+ * Reading of the payload, as done by the Hazelnet library when processing the frame.
+ */
+static inline uint32_t
+hzlSim_BenchProcess(const flexcan_msgbuff_t* const msg)
+{
+    uint32_t sum = msg->msgId;
+    for (uint32_t i = 0U; i < msg->dataLen; i++)
+    {
+        sum += msg->data[i];
+    }
+    return sum;
+}
+
+static hzlSim_BenchResult_t
+hzlSim_BenchQueue(void)
+{
+    hzlSim_BenchResult_t result = {0};
+    const QueueHandle_t queue = xQueueCreate(HZL_SIM_BENCH_RX_QUEUE_LEN, sizeof(flexcan_msgbuff_t));
+    if (queue == NULL)
+    {
+        fprintf(stderr, "Cannot create the queue\n");
+        exit(EXIT_FAILURE);
+    }
+    flexcan_msgbuff_t tempRxMsg;
+    flexcan_msgbuff_t poppedMsg;
+    const uint64_t startNanos = hzlSim_NowNanos();
+    const uint64_t startCycles = hzlSim_BenchCycles();
+    for (unsigned long frame = 0U; frame < gFrames; frame += HZL_SIM_BENCH_RX_QUEUE_LEN)
+    {
+        for (uint32_t i = 0U; i < HZL_SIM_BENCH_RX_QUEUE_LEN; i++)
+        {
+            BaseType_t higherPriorityTaskWoken = pdFALSE;
+            hzlSim_BenchDriverReceive(&tempRxMsg, i);
+            xQueueSendToBackFromISR(queue, &tempRxMsg, &higherPriorityTaskWoken);
+        }
+        while (xQueueReceive(queue, &poppedMsg, 0U) == pdTRUE)
+        {
+            result.checksum += hzlSim_BenchProcess(&poppedMsg);
+        }
+    }
+    result.cycles = hzlSim_BenchCycles() - startCycles;
+    result.nanos = hzlSim_NowNanos() - startNanos;
+    vQueueDelete(queue);
+    return result;
+}
+
+static hzlSim_BenchResult_t
+hzlSim_BenchSpscRing(void)
+{
+    hzlSim_BenchResult_t result = {0};
+    hzlPlatform_SpscRing_t readySlots;
+    hzlPlatform_SpscRing_t freeSlots;
+    uint8_t readySlotsItems[HZL_SIM_BENCH_RX_RING_CAPACITY];
+    uint8_t freeSlotsItems[HZL_SIM_BENCH_RX_RING_CAPACITY];
+    hzlPlatform_SpscRingInit(&readySlots, readySlotsItems, HZL_SIM_BENCH_RX_RING_CAPACITY);
+    hzlPlatform_SpscRingInit(&freeSlots, freeSlotsItems, HZL_SIM_BENCH_RX_RING_CAPACITY);
+    for (uint8_t slotIdx = 0U; slotIdx < HZL_SIM_BENCH_RX_SLOTS_AMOUNT; slotIdx++)
+    {
+        (void) hzlPlatform_SpscRingPush(&freeSlots, slotIdx);
+    }
+    const uint64_t startNanos = hzlSim_NowNanos();
+    const uint64_t startCycles = hzlSim_BenchCycles();
+    for (unsigned long frame = 0U; frame < gFrames; frame += HZL_SIM_BENCH_RX_QUEUE_LEN)
+    {
+        for (uint32_t i = 0U; i < HZL_SIM_BENCH_RX_QUEUE_LEN; i++)
+        {
+            uint8_t slotIdx;
+            if (hzlPlatform_SpscRingPop(&freeSlots, &slotIdx))
+            {
+                hzlSim_BenchDriverReceive(&gRxSlots[slotIdx], i);
+                (void) hzlPlatform_SpscRingPush(&readySlots, slotIdx);
+            }
+        }
+        uint8_t slotIdx;
+        while (hzlPlatform_SpscRingPop(&readySlots, &slotIdx))
+        {
+            result.checksum += hzlSim_BenchProcess(&gRxSlots[slotIdx]);
+            (void) hzlPlatform_SpscRingPush(&freeSlots, slotIdx);
+        }
+    }
+    result.cycles = hzlSim_BenchCycles() - startCycles;
+    result.nanos = hzlSim_NowNanos() - startNanos;
+    return result;
+}
+
+static void
+hzlSim_BenchPrint(const char* const name, const hzlSim_BenchResult_t* const result)
+{
+    printf("%-10s %10.1f ns/frame", name, (double) result->nanos / (double) gFrames);
+#if defined(HZL_SIM_BENCH_HAS_CYCLES)
+    printf(" %10.1f cycles/frame", (double) result->cycles / (double) gFrames);
+#endif
+    printf("   (checksum %08" PRIX32 ")\n", result->checksum);
+}
+
+/**
+ * @internal
+ * Runs the benchmarks within a task, as the queue requires a running scheduler.
+ */
+static void
+hzlSim_TaskBench(void* const unusedParam)
+{
+    (void) unusedParam;
+    gHwMailbox.msgId = HZL_SIM_BENCH_PAYLOAD_LEN;
+    gHwMailbox.dataLen = HZL_SIM_BENCH_PAYLOAD_LEN;
+    // Warm-up of caches and branch predictors, then the measured runs.
+    (void) hzlSim_BenchQueue();
+    (void) hzlSim_BenchSpscRing();
+    const hzlSim_BenchResult_t queue = hzlSim_BenchQueue();
+    const hzlSim_BenchResult_t ring = hzlSim_BenchSpscRing();
+    printf("RX handover of %lu frames of %u B\n", gFrames, HZL_SIM_BENCH_PAYLOAD_LEN);
+    hzlSim_BenchPrint("xQueue", &queue);
+    hzlSim_BenchPrint("SPSC ring", &ring);
+    printf("Speedup: %.2fx\n", (double) queue.nanos / (double) ring.nanos);
+    fflush(stdout);
+    exit(queue.checksum == ring.checksum ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int
+main(const int argc, const char* const argv[])
+{
+    if (argc > 1)
+    {
+        gFrames = strtoul(argv[1], NULL, 10);
+    }
+    // Whole bursts only, so both runs process the same frames.
+    gFrames -= gFrames % HZL_SIM_BENCH_RX_QUEUE_LEN;
+    if (gFrames == 0U)
+    {
+        gFrames = HZL_SIM_BENCH_RX_QUEUE_LEN;
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskBench,
+        "SimBench",
+        configMINIMAL_STACK_SIZE * 4U,
+        NULL,
+        tskIDLE_PRIORITY + 1U,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the benchmark task\n");
+        return EXIT_FAILURE;
+    }
+    vTaskStartScheduler();
+    return EXIT_FAILURE;  // The scheduler never returns in the POSIX port.
+}
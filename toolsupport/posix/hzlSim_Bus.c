@@ -0,0 +1,582 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Virtual CAN FD buses: a FreeRTOS task per bus broadcasting every frame transmitted on it to all
+ * other nodes.
+ *
+ * The frames are delivered in transmission order with the scheduler suspended, which is the
+ * closest the POSIX port gets to the receiving nodes being interrupted by their FLEXCAN peripheral.
+ * With HZL_SIM_BUS_BIT_TIMING defined, each frame is delivered only once the bus had the time to
+ * carry it and the previous ones at their bitrates, within the resolution of the tick.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hzlSim.h"
+#include "hzlPlatform_CbsHeader.h"
+#include "hzlPlatform_Clock.h"
+#include "queue.h"
+
+typedef struct hzlSim_BusEntry
+{
+    hzlSim_Port_t* src;
+    uint8_t txMailboxIdx;
+    hzlSim_Frame_t frame;
+} hzlSim_BusEntry_t;
+
+/** Largest CAN ID of the foreign traffic, just below the CAN IDs of the platform. */
+#define HZL_SIM_NOISE_CANID_MAX 0x6FFU
+/** Payload length of the foreign frames. */
+#define HZL_SIM_NOISE_DATA_LEN 64U
+/** CAN ID of the data load, the one of the Server (HZL_PLATFORM_CANID_FROM_SERVER). */
+#define HZL_SIM_LOAD_CANID 0x700U
+/** SID of the data load, the one of the Server. */
+#define HZL_SIM_LOAD_SID 0U
+/** Payload length of the data load frames, CBS header included. */
+#define HZL_SIM_LOAD_DATA_LEN 64U
+/**
+ * CAN IDs and SIDs of the forged frames, in turns: the ones of the Server, which all Clients
+ * receive, and of Alice, which the Server receives (HZL_PLATFORM_CANID_FROM_ALICE).
+ */
+#define HZL_SIM_FORGERY_CANID_SERVER 0x700U
+#define HZL_SIM_FORGERY_SID_SERVER 0U
+#define HZL_SIM_FORGERY_CANID_ALICE 0x70AU
+#define HZL_SIM_FORGERY_SID_ALICE 1U
+/** Payload length of the forged frames, CBS header included. */
+#define HZL_SIM_FORGERY_DATA_LEN 64U
+
+/**
+ * Bits of a CAN FD frame with a 29-bit CAN ID at the nominal bitrate, before the data phase:
+ * SOF, base ID, SRR, IDE, ID extension, RRS, FDF, res and BRS.
+ */
+#define HZL_SIM_CANFD_ARBITRATION_BITS 36U
+/**
+ * Bits at the nominal bitrate after the data phase: CRC delimiter, ACK slot, ACK delimiter,
+ * end of frame and intermission.
+ */
+#define HZL_SIM_CANFD_END_BITS 13U
+/** Bits of the data phase before the payload: ESI and DLC. */
+#define HZL_SIM_CANFD_CONTROL_BITS 5U
+/** Stuff count of the CRC field, preceding the CRC itself. */
+#define HZL_SIM_CANFD_STUFF_COUNT_BITS 4U
+/** CRC of the payloads up to 16 bytes and of the longer ones. */
+#define HZL_SIM_CANFD_CRC17_BITS 17U
+#define HZL_SIM_CANFD_CRC21_BITS 21U
+
+static QueueHandle_t gBusQueues[HZL_SIM_BUSES_AMOUNT];
+static hzlSim_Port_t* gPorts[HZL_SIM_BUS_MAX_PORTS];
+static size_t gPortsAmount = 0U;
+static volatile uint64_t gFramesCarried[HZL_SIM_BUSES_AMOUNT];
+static volatile uint64_t gOccupiedNanos[HZL_SIM_BUSES_AMOUNT];
+/** Whether the Session renewal notifications are no longer delivered, see hzlSim_BusLoseRen(). */
+static volatile bool gIsLosingRen = false;
+static volatile uint64_t gRenLost = 0U;
+
+uint64_t
+hzlSim_NowNanos(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @internal
+ * Host replacement of the SysTick-based clock of hzlPlatform_Clock.c, shared by all nodes.
+ */
+uint64_t
+hzlPlatform_ClockMicros(void)
+{
+    return hzlSim_NowNanos() / 1000U;
+}
+
+/**
+ * @internal
+ * Length of the payload on the bus: the FLEXCAN pads it to the next length a DLC can encode.
+ */
+static uint32_t
+hzlSim_BusPaddedDataLen(const size_t dataLen)
+{
+    static const uint8_t canFdLens[] = {12U, 16U, 20U, 24U, 32U, 48U, 64U};
+    if (dataLen <= 8U)
+    {
+        return (uint32_t) dataLen;
+    }
+    for (size_t i = 0U; i < sizeof(canFdLens); i++)
+    {
+        if (dataLen <= canFdLens[i])
+        {
+            return canFdLens[i];
+        }
+    }
+    return 64U;
+}
+
+uint32_t
+hzlSim_BusFrameNanos(const size_t dataLen, const hzlSim_BitTiming_t* const bitTiming)
+{
+    const uint32_t paddedLen = hzlSim_BusPaddedDataLen(dataLen);
+    const uint32_t crcBits = paddedLen <= 16U ? HZL_SIM_CANFD_CRC17_BITS : HZL_SIM_CANFD_CRC21_BITS;
+    // Dynamic stuff bits up to the CRC field, fixed ones in the CRC field: before the stuff
+    // count and after every 4 bits.
+    const uint32_t arbitrationBits = HZL_SIM_CANFD_ARBITRATION_BITS
+                                     + (HZL_SIM_CANFD_ARBITRATION_BITS - 1U) / 4U;
+    const uint32_t controlAndDataBits = HZL_SIM_CANFD_CONTROL_BITS + 8U * paddedLen;
+    const uint32_t dataPhaseBits = controlAndDataBits + controlAndDataBits / 4U
+                                   + HZL_SIM_CANFD_STUFF_COUNT_BITS + crcBits
+                                   + 1U + (HZL_SIM_CANFD_STUFF_COUNT_BITS + crcBits) / 4U;
+    return (arbitrationBits + HZL_SIM_CANFD_END_BITS) * bitTiming->nominalBitNanos
+           + dataPhaseBits * bitTiming->dataBitNanos;
+}
+
+#if defined(HZL_SIM_BUS_BIT_TIMING)
+/**
+ * @internal
+ * Waits until the bus carried the frame, starting when the bus becomes idle after the previous
+ * one. Sleeps only for whole ticks: the remainder is carried over to the next frames, so the bus
+ * throughput is exact even if the single frames are late by up to a tick.
+ */
+static void
+hzlSim_BusCarry(const uint8_t bus, const uint32_t frameNanos)
+{
+    static uint64_t idleAtNanos[HZL_SIM_BUSES_AMOUNT];
+    const uint64_t tickNanos = 1000000000ULL / configTICK_RATE_HZ;
+    const uint64_t now = hzlSim_NowNanos();
+    idleAtNanos[bus] = (idleAtNanos[bus] > now ? idleAtNanos[bus] : now) + frameNanos;
+    const uint64_t waitTicks = (idleAtNanos[bus] - now) / tickNanos;
+    if (waitTicks > 0U)
+    {
+        vTaskDelay((TickType_t) waitTicks);
+    }
+}
+#endif
+
+/**
+ * @internal
+ * Whether the frame is a Session renewal notification.
+ */
+static bool
+hzlSim_BusIsRen(const uint8_t* const data, const size_t dataLen)
+{
+    return hzlPlatform_CbsPty(data, (uint32_t) dataLen) == HZL_PLATFORM_CBS_PTY_REN;
+}
+
+/**
+ * @internal
+ * Pops the frames transmitted on the bus and hands them to every port, the transmitting one
+ * included, as a FLEXCAN receives its own frames unless told otherwise. The buses are
+ * independent, so frames on different buses are carried concurrently.
+ *
+ * @param busIdx index of the bus, cast to a pointer
+ */
+static void
+hzlSim_TaskBus(void* const busIdx)
+{
+    const uint8_t bus = (uint8_t) (uintptr_t) busIdx;
+    hzlSim_BusEntry_t entry;
+    while (true)
+    {
+        if (xQueueReceive(gBusQueues[bus], &entry, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+#if defined(HZL_SIM_BUS_BIT_TIMING)
+        hzlSim_BusCarry(bus, entry.frame.busNanos);
+#endif
+        vTaskSuspendAll();
+        const bool isLost = gIsLosingRen
+                            && hzlSim_BusIsRen(entry.frame.data, entry.frame.dataLen);
+        for (size_t i = 0U; i < gPortsAmount && !isLost; i++)
+        {
+            gPorts[i]->deliver(gPorts[i], bus, &entry.frame, gPorts[i] == entry.src);
+        }
+        gRenLost += isLost ? 1U : 0U;
+        gFramesCarried[bus]++;
+        gOccupiedNanos[bus] += entry.frame.busNanos;
+        entry.src->txComplete(entry.src, bus, entry.txMailboxIdx);
+        (void) xTaskResumeAll();
+    }
+}
+
+void
+hzlSim_BusInit(void)
+{
+    static const char* const taskNames[] = {"SimBus", "SimBus1", "SimBus2"};
+    for (uint8_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+    {
+        gBusQueues[bus] = xQueueCreate(HZL_SIM_BUS_QUEUE_LEN, sizeof(hzlSim_BusEntry_t));
+        if (gBusQueues[bus] == NULL)
+        {
+            fprintf(stderr, "Cannot create the virtual bus queue\n");
+            exit(EXIT_FAILURE);
+        }
+        const BaseType_t created = xTaskCreate(
+            hzlSim_TaskBus,
+            taskNames[bus],
+            configMINIMAL_STACK_SIZE * 4U,
+            (void*) (uintptr_t) bus,
+            HZL_SIM_TASK_PRIORITY_BUS,
+            NULL);
+        if (created != pdPASS)
+        {
+            fprintf(stderr, "Cannot create the virtual bus task\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void
+hzlSim_BusAttach(hzlSim_Port_t* const port)
+{
+    if (gPortsAmount >= HZL_SIM_BUS_MAX_PORTS)
+    {
+        fprintf(stderr, "Too many nodes on the virtual bus\n");
+        exit(EXIT_FAILURE);
+    }
+    gPorts[gPortsAmount++] = port;
+}
+
+bool
+hzlSim_BusTransmit(hzlSim_Port_t* const src,
+                   const uint8_t bus,
+                   const uint8_t txMailboxIdx,
+                   const uint32_t canId,
+                   const uint8_t* const data,
+                   const size_t dataLen,
+                   const hzlSim_BitTiming_t* const bitTiming)
+{
+    hzlSim_BusEntry_t entry;
+    if (bus >= HZL_SIM_BUSES_AMOUNT || dataLen > sizeof(entry.frame.data))
+    {
+        return false;
+    }
+    entry.src = src;
+    entry.txMailboxIdx = txMailboxIdx;
+    entry.frame.canId = canId;
+    entry.frame.dataLen = (uint8_t) dataLen;
+    memcpy(entry.frame.data, data, dataLen);
+    entry.frame.txTimestampNanos = hzlSim_NowNanos();
+    entry.frame.busNanos = hzlSim_BusFrameNanos(dataLen, bitTiming);
+    // Called like a peripheral register write: from within critical sections of the platform
+    // and from the bus task itself by a TX-complete callback. The ISR variant neither blocks
+    // nor switches immediately to the bus task, which runs at the next scheduling point, so the
+    // caller's critical section is not broken.
+    BaseType_t isBusTaskWoken = pdFALSE;
+    if (xQueueSendToBackFromISR(gBusQueues[bus], &entry, &isBusTaskWoken) != pdTRUE)
+    {
+        return false;
+    }
+    src->framesTransmitted++;
+    return true;
+}
+
+uint64_t
+hzlSim_BusFramesCarried(const uint8_t bus)
+{
+    return gFramesCarried[bus];
+}
+
+uint64_t
+hzlSim_BusOccupiedNanos(const uint8_t bus)
+{
+    return gOccupiedNanos[bus];
+}
+
+void
+hzlSim_BusLoseRen(void)
+{
+    gIsLosingRen = true;
+}
+
+uint64_t
+hzlSim_BusRenLost(void)
+{
+    return gRenLost;
+}
+
+/**
+ * @internal
+ * The traffic generators do not switch bitrate in the data phase.
+ */
+static const hzlSim_BitTiming_t gGeneratorBitTiming =
+{
+    .nominalBitNanos = HZL_SIM_BUS_NOMINAL_BIT_NANOS,
+    .dataBitNanos = HZL_SIM_BUS_NOMINAL_BIT_NANOS,
+};
+
+/**
+ * @internal
+ * The traffic generators are not attached to the buses, so they only need a TX-complete
+ * callback.
+ */
+static void
+hzlSim_GeneratorTxComplete(hzlSim_Port_t* const port,
+                           const uint8_t bus,
+                           const uint8_t txMailboxIdx)
+{
+    (void) port;
+    (void) bus;
+    (void) txMailboxIdx;
+}
+
+static hzlSim_Port_t gNoisePort =
+{
+    .name = "Noise",
+    .txComplete = hzlSim_GeneratorTxComplete,
+};
+
+static hzlSim_Port_t gLoadPort =
+{
+    .name = "Load",
+    .txComplete = hzlSim_GeneratorTxComplete,
+};
+
+static hzlSim_Port_t gForgeryPort =
+{
+    .name = "Forgery",
+    .txComplete = hzlSim_GeneratorTxComplete,
+};
+
+/**
+ * @internal
+ * Xorshift32, plenty for traffic that only has to look different.
+ */
+static uint8_t
+hzlSim_BusRandomByte(uint32_t* const state)
+{
+    *state ^= *state << 13U;
+    *state ^= *state >> 17U;
+    *state ^= *state << 5U;
+    return (uint8_t) *state;
+}
+
+/**
+ * @internal
+ * Transmits the foreign frames due in every tick on every bus, with pseudo-random CAN IDs and
+ * payloads. Frames not fitting into the bus queue are not retried.
+ *
+ * @param framesPerSecond rate on each bus, cast to a pointer
+ */
+static void
+hzlSim_TaskNoise(void* const framesPerSecond)
+{
+    const uint32_t rate = (uint32_t) (uintptr_t) framesPerSecond;
+    uint32_t random = 0x2545F491U;
+    uint32_t framesDueTimesTickRate = 0U;
+    uint8_t data[HZL_SIM_NOISE_DATA_LEN];
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, 1U);
+        framesDueTimesTickRate += rate;
+        for (; framesDueTimesTickRate >= configTICK_RATE_HZ;
+             framesDueTimesTickRate -= configTICK_RATE_HZ)
+        {
+            for (uint8_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+            {
+                for (size_t i = 0U; i < sizeof(data); i++)
+                {
+                    data[i] = hzlSim_BusRandomByte(&random);
+                }
+                (void) hzlSim_BusTransmit(&gNoisePort, bus, 0U,
+                                          random % (HZL_SIM_NOISE_CANID_MAX + 1U),
+                                          data, sizeof(data), &gGeneratorBitTiming);
+            }
+        }
+    }
+}
+
+void
+hzlSim_BusNoiseStart(const uint32_t framesPerSecond)
+{
+    if (framesPerSecond == 0U)
+    {
+        return;
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskNoise,
+        "SimNoise",
+        configMINIMAL_STACK_SIZE * 4U,
+        (void*) (uintptr_t) framesPerSecond,
+        HZL_SIM_TASK_PRIORITY_BUS,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the foreign traffic task\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+uint64_t
+hzlSim_BusNoiseFramesTransmitted(void)
+{
+    return gNoisePort.framesTransmitted;
+}
+
+/**
+ * @internal
+ * Transmits a burst of data load frames on every bus every time enough frames are due.
+ * Frames not fitting into the bus queue are not retried.
+ *
+ * @param framesPerSecond average rate on each bus, cast to a pointer
+ */
+static void
+hzlSim_TaskLoad(void* const framesPerSecond)
+{
+    const uint32_t rate = (uint32_t) (uintptr_t) framesPerSecond;
+    uint32_t framesDueTimesTickRate = 0U;
+    uint8_t data[HZL_SIM_LOAD_DATA_LEN];
+    memset(data, 0x55, sizeof(data));
+    data[HZL_PLATFORM_CBS_HEADER_GID_IDX] = 0U;  // Broadcast GID
+    data[HZL_PLATFORM_CBS_HEADER_SID_IDX] = HZL_SIM_LOAD_SID;
+    data[HZL_PLATFORM_CBS_HEADER_PTY_IDX] = HZL_PLATFORM_CBS_PTY_UAD;
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, 1U);
+        framesDueTimesTickRate += rate;
+        for (; framesDueTimesTickRate >= HZL_SIM_LOAD_BURST_LEN * configTICK_RATE_HZ;
+             framesDueTimesTickRate -= HZL_SIM_LOAD_BURST_LEN * configTICK_RATE_HZ)
+        {
+            for (uint8_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+            {
+                for (uint32_t i = 0U; i < HZL_SIM_LOAD_BURST_LEN; i++)
+                {
+                    (void) hzlSim_BusTransmit(&gLoadPort, bus, 0U, HZL_SIM_LOAD_CANID,
+                                              data, sizeof(data), &gGeneratorBitTiming);
+                }
+            }
+        }
+    }
+}
+
+void
+hzlSim_BusLoadStart(const uint32_t framesPerSecond)
+{
+    if (framesPerSecond == 0U)
+    {
+        return;
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskLoad,
+        "SimLoad",
+        configMINIMAL_STACK_SIZE * 4U,
+        (void*) (uintptr_t) framesPerSecond,
+        HZL_SIM_TASK_PRIORITY_BUS,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the data load task\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+uint64_t
+hzlSim_BusLoadFramesTransmitted(void)
+{
+    return gLoadPort.framesTransmitted;
+}
+
+/**
+ * @internal
+ * Transmits the forged frames due in every tick on every bus, alternating the CAN ID and SID of
+ * the Server and of Alice. Frames not fitting into the bus queue are not retried.
+ *
+ * @param framesPerSecond rate on each bus, cast to a pointer
+ */
+static void
+hzlSim_TaskForgery(void* const framesPerSecond)
+{
+    const uint32_t rate = (uint32_t) (uintptr_t) framesPerSecond;
+    uint32_t random = 0x6B8B4567U;
+    uint32_t framesDueTimesTickRate = 0U;
+    bool isAsServer = true;
+    uint8_t data[HZL_SIM_FORGERY_DATA_LEN];
+    data[HZL_PLATFORM_CBS_HEADER_GID_IDX] = 0U;  // Broadcast GID
+    data[HZL_PLATFORM_CBS_HEADER_PTY_IDX] = HZL_PLATFORM_CBS_PTY_SADFD;
+    TickType_t lastWake = xTaskGetTickCount();
+    while (true)
+    {
+        vTaskDelayUntil(&lastWake, 1U);
+        framesDueTimesTickRate += rate;
+        for (; framesDueTimesTickRate >= configTICK_RATE_HZ;
+             framesDueTimesTickRate -= configTICK_RATE_HZ)
+        {
+            data[HZL_PLATFORM_CBS_HEADER_SID_IDX] = isAsServer
+                                                    ? HZL_SIM_FORGERY_SID_SERVER
+                                                    : HZL_SIM_FORGERY_SID_ALICE;
+            const uint32_t canId = isAsServer
+                                   ? HZL_SIM_FORGERY_CANID_SERVER
+                                   : HZL_SIM_FORGERY_CANID_ALICE;
+            isAsServer = !isAsServer;
+            for (uint8_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+            {
+                // Counter nonce, ciphertext and tag: anything but valid.
+                for (size_t i = HZL_PLATFORM_CBS_HEADER_LEN; i < sizeof(data); i++)
+                {
+                    data[i] = hzlSim_BusRandomByte(&random);
+                }
+                (void) hzlSim_BusTransmit(&gForgeryPort, bus, 0U, canId,
+                                          data, sizeof(data), &gGeneratorBitTiming);
+            }
+        }
+    }
+}
+
+void
+hzlSim_BusForgeryStart(const uint32_t framesPerSecond)
+{
+    if (framesPerSecond == 0U)
+    {
+        return;
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskForgery,
+        "SimForge",
+        configMINIMAL_STACK_SIZE * 4U,
+        (void*) (uintptr_t) framesPerSecond,
+        HZL_SIM_TASK_PRIORITY_BUS,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the forged traffic task\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+uint64_t
+hzlSim_BusForgeryFramesTransmitted(void)
+{
+    return gForgeryPort.framesTransmitted;
+}
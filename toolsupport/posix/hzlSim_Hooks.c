@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * FreeRTOS hooks of the host executables (simulation and benchmarks).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "hzlPlatform_Clock.h"
+#include "hzlPlatform_CpuStats.h"
+
+/**
+ * @internal
+ * FreeRTOS heap_3 (host malloc) failed: nothing sensible to simulate anymore.
+ */
+void
+vApplicationMallocFailedHook(void)
+{
+    fprintf(stderr, "FATAL: FreeRTOS out of memory\n");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @internal
+ * Nothing to configure: the run-time statistics counter is derived from the host clock.
+ */
+void
+vMainConfigureTimerForRunTimeStats(void)
+{
+}
+
+/**
+ * @internal
+ * Counter of the FreeRTOS run-time statistics, at the same frequency as on the S32K144.
+ */
+unsigned long
+ulMainGetRunTimeCounterValue(void)
+{
+    return (unsigned long) (hzlPlatform_ClockMicros()
+                            / (1000000UL / HZL_PLATFORM_CPU_STATS_COUNTER_HZ));
+}
+
+/**
+ * @internal
+ * Failed configASSERT() within the FreeRTOS kernel.
+ */
+void
+vAssertCalled(const char* const file, const unsigned long line)
+{
+    fprintf(stderr, "FATAL: FreeRTOS assertion failed at %s:%lu\n", file, line);
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,625 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Main of the host simulation: starts the virtual buses, the four nodes and a monitor task that
+ * prints the bus statistics after the requested amount of simulated seconds.
+ *
+ * Usage: `hzlsim [seconds] [foreign frames/s] [data frames/s] [forged frames/s] [renewal s]`,
+ * 30 seconds without foreign traffic, data load, forged frames and renewal by default. The foreign frames are
+ * transmitted on every bus by a node outside of the Hazelnet network, see hzlSim_BusNoiseStart(),
+ * the data load in bursts in the name of the Server, see hzlSim_BusLoadStart(), the forged
+ * frames in the name of the Server and of Alice, see hzlSim_BusForgeryStart(). With the data load
+ * argument, even 0, but without the forged frames one, the Clients also start a new handshake
+ * every #HZL_SIM_HANDSHAKE_PERIOD_MS, to measure its duration under load. With the renewal
+ * argument, the Server renews the Session that many seconds after the start, like upon a press
+ * of its Button 2, while the buses lose every renewal notification from then on (see
+ * hzlSim_BusLoseRen()): the Clients have to resynchronise from the security warnings.
+ *
+ * With `HZL_SIM_FLEET` the Server runs with the 32 Clients of #HZL_SIM_FLEET_SIDS instead of
+ * Alice, Bob and Charlie. Either way the report tells how long after the start all Clients had
+ * established their Session.
+ *
+ * The exit status is a failure if the forged frames resynchronised a bus more often than the
+ * security-warning limiter allows, or if no Client resynchronised after the lost renewal.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hzlPlatform_SecWarnLimiter.h"
+#include "hzlSim.h"
+
+#define HZL_SIM_DEFAULT_DURATION_SECONDS 30UL
+#define HZL_SIM_TASK_PRIORITY_MONITOR (tskIDLE_PRIORITY + 1U)
+#define HZL_SIM_HANDSHAKE_PERIOD_MS 500UL
+
+static const hzlSim_NodeStartFunc gNodeStartFuncs[] =
+{
+    hzlSim_NodeStartServer,
+#if defined(HZL_SIM_FLEET)
+#define HZL_SIM_FLEET_NODE_START_ENTRY(sid) hzlSim_NodeStartClient##sid,
+    HZL_SIM_FLEET_SIDS(HZL_SIM_FLEET_NODE_START_ENTRY)
+#else
+    hzlSim_NodeStartAlice,
+    hzlSim_NodeStartBob,
+    hzlSim_NodeStartCharlie,
+#endif
+};
+#define HZL_SIM_NODES_AMOUNT (sizeof(gNodeStartFuncs) / sizeof(gNodeStartFuncs[0]))
+
+static hzlSim_Port_t gPorts[HZL_SIM_NODES_AMOUNT];
+static unsigned long gDurationSeconds = HZL_SIM_DEFAULT_DURATION_SECONDS;
+static uint32_t gNoiseFramesPerSecond = 0U;
+static uint32_t gLoadFramesPerSecond = 0U;
+static uint32_t gForgeryFramesPerSecond = 0U;
+static unsigned long gRenewalSeconds = 0U;
+static bool gIsHandshakeLoop = false;
+/** Time from the start until every Client completed a handshake on every bus, 0 until then. */
+static uint64_t gAllSessionsNanos = 0U;
+
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+#define HZL_SIM_LATENCY_OP_NAME_ENTRY(name, printable) printable,
+
+static const char* const gLatencyOpNames[HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT] =
+{
+    HZL_PLATFORM_LATENCY_HIST_OPS(HZL_SIM_LATENCY_OP_NAME_ENTRY)
+};
+
+/**
+ * @internal
+ * Upper bound of the given percentile of a log2 histogram, in cycles: the end of the bucket
+ * the percentile falls into.
+ */
+static uint64_t
+hzlSim_LatencyPercentile(const volatile hzlPlatform_LatencyHist_t* const hist,
+                         const uint32_t percent)
+{
+    const uint64_t rank = ((uint64_t) hist->samples * percent + 99U) / 100U;
+    uint64_t seen = 0U;
+    for (uint32_t bucket = 0U; bucket < HZL_PLATFORM_LATENCY_HIST_BUCKETS; bucket++)
+    {
+        seen += hist->buckets[bucket];
+        if (seen >= rank)
+        {
+            return 2ULL << bucket;
+        }
+    }
+    return 0U;
+}
+
+/**
+ * @internal
+ * Prints the latency percentiles of each operation of each node.
+ */
+static void
+hzlSim_PrintLatencyHists(void)
+{
+    printf("%-8s %-20s %10s %10s %10s %12s\n",
+           "Node", "Latency (cycles)", "Samples", "p50 <", "p99 <", "Max");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        for (uint32_t op = 0U; op < HZL_PLATFORM_LATENCY_HIST_OP_AMOUNT; op++)
+        {
+            const volatile hzlPlatform_LatencyHist_t* const hist = &gPorts[i].latencyHists[op];
+            if (hist->samples == 0U)
+            {
+                continue;
+            }
+            printf("%-8s %-20s %10" PRIu32 " %10" PRIu64 " %10" PRIu64 " %12" PRIu32 "\n",
+                   gPorts[i].name,
+                   gLatencyOpNames[op],
+                   hist->samples,
+                   hzlSim_LatencyPercentile(hist, 50U),
+                   hzlSim_LatencyPercentile(hist, 99U),
+                   hist->maxCycles);
+        }
+    }
+}
+#endif  /* HZL_PLATFORM_LATENCY_HIST */
+
+/**
+ * @internal
+ * Traffic counters of a node summed over all its buses, taking the largest high-water marks.
+ */
+static hzlPlatform_TelemetryBus_t
+hzlSim_TelemetryAllBuses(const volatile hzlPlatform_Telemetry_t* const telemetry)
+{
+    hzlPlatform_TelemetryBus_t sum = {0};
+    for (size_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+    {
+        const volatile hzlPlatform_TelemetryBus_t* const counters = &telemetry->buses[bus];
+        sum.txFramesEnqueued += counters->txFramesEnqueued;
+        sum.txFramesSent += counters->txFramesSent;
+        sum.txFramesDroppedQueueFull += counters->txFramesDroppedQueueFull;
+        if (counters->txQueueHighWaterMark > sum.txQueueHighWaterMark)
+        {
+            sum.txQueueHighWaterMark = counters->txQueueHighWaterMark;
+        }
+        sum.rxFramesEnqueued += counters->rxFramesEnqueued;
+        sum.rxFramesDroppedQueueFull += counters->rxFramesDroppedQueueFull;
+        sum.rxFramesLostInHw += counters->rxFramesLostInHw;
+        if (counters->rxQueueHighWaterMark > sum.rxQueueHighWaterMark)
+        {
+            sum.rxQueueHighWaterMark = counters->rxQueueHighWaterMark;
+        }
+        sum.rxControlFramesEnqueued += counters->rxControlFramesEnqueued;
+        sum.rxControlFramesDropped += counters->rxControlFramesDropped;
+        sum.rxFramesProcessed += counters->rxFramesProcessed;
+        sum.rxFramesIgnored += counters->rxFramesIgnored;
+        for (size_t reason = 0U; reason < HZL_PLATFORM_TELEMETRY_PREFILTER_AMOUNT; reason++)
+        {
+            sum.rxFramesPrefiltered[reason] += counters->rxFramesPrefiltered[reason];
+        }
+        sum.rxAeadVerificationsSaved += counters->rxAeadVerificationsSaved;
+        sum.rxSecuredFramesProcessed += counters->rxSecuredFramesProcessed;
+        sum.rxSecuredFramesDecrypted += counters->rxSecuredFramesDecrypted;
+        sum.rxSecuredPlaintextBytes += counters->rxSecuredPlaintextBytes;
+        for (size_t warnClass = 0U; warnClass < HZL_PLATFORM_TELEMETRY_SECWARN_AMOUNT; warnClass++)
+        {
+            sum.rxSecWarnings[warnClass] += counters->rxSecWarnings[warnClass];
+        }
+        sum.secWarnResyncs += counters->secWarnResyncs;
+        sum.secWarnResyncsHeldOff += counters->secWarnResyncsHeldOff;
+        sum.handshakesCompleted += counters->handshakesCompleted;
+        sum.handshakeRequestsSent += counters->handshakeRequestsSent;
+        sum.handshakeRequestsDeferred += counters->handshakeRequestsDeferred;
+        sum.handshakeSumMicros += counters->handshakeSumMicros;
+        if (counters->handshakeMaxMicros > sum.handshakeMaxMicros)
+        {
+            sum.handshakeMaxMicros = counters->handshakeMaxMicros;
+        }
+        sum.appMessagesConsumed += counters->appMessagesConsumed;
+        sum.appLatencySumMicros += counters->appLatencySumMicros;
+        if (counters->appLatencyMaxMicros > sum.appLatencyMaxMicros)
+        {
+            sum.appLatencyMaxMicros = counters->appLatencyMaxMicros;
+        }
+        sum.pipelineAppQueueFull += counters->pipelineAppQueueFull;
+        sum.pipelineTxQueueFull += counters->pipelineTxQueueFull;
+        sum.trafficMessagesGenerated += counters->trafficMessagesGenerated;
+        sum.txMessagesAggregated += counters->txMessagesAggregated;
+        sum.txAggregatesSecured += counters->txAggregatesSecured;
+        sum.rxAggregatesMalformed += counters->rxAggregatesMalformed;
+    }
+    return sum;
+}
+
+/**
+ * @internal
+ * Prints the statistics of the simulation run in a human readable table.
+ */
+static void
+hzlSim_PrintReport(const double elapsedSeconds)
+{
+    uint64_t frames = 0U;
+    for (uint8_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+    {
+        const uint64_t busFrames = hzlSim_BusFramesCarried(bus);
+        printf("Bus %u carried %" PRIu64 " frames, %.1f frames/s, %.1f%% occupied\n",
+               (unsigned) bus, busFrames, (double) busFrames / elapsedSeconds,
+               100.0 * (double) hzlSim_BusOccupiedNanos(bus) / 1e9 / elapsedSeconds);
+        frames += busFrames;
+    }
+    printf("Simulated %.3f s, %u bus(es) carried %" PRIu64 " frames, %.1f frames/s\n",
+           elapsedSeconds, (unsigned) HZL_SIM_BUSES_AMOUNT, frames,
+           (double) frames / elapsedSeconds);
+    printf("Foreign frames %" PRIu64 ", %.1f frames/s\n",
+           hzlSim_BusNoiseFramesTransmitted(),
+           (double) hzlSim_BusNoiseFramesTransmitted() / elapsedSeconds);
+    printf("Data load frames %" PRIu64 ", %.1f frames/s\n",
+           hzlSim_BusLoadFramesTransmitted(),
+           (double) hzlSim_BusLoadFramesTransmitted() / elapsedSeconds);
+    printf("Forged frames %" PRIu64 ", %.1f frames/s\n",
+           hzlSim_BusForgeryFramesTransmitted(),
+           (double) hzlSim_BusForgeryFramesTransmitted() / elapsedSeconds);
+    printf("Renewal notifications lost %" PRIu64 "\n", hzlSim_BusRenLost());
+    if (gAllSessionsNanos != 0U)
+    {
+        printf("Sessions of all %u Clients established after %.3f ms\n",
+               (unsigned) (HZL_SIM_NODES_AMOUNT - 1U), (double) gAllSessionsNanos / 1e6);
+    }
+    else
+    {
+        printf("Sessions of all %u Clients NOT established\n",
+               (unsigned) (HZL_SIM_NODES_AMOUNT - 1U));
+    }
+    printf("%-8s %10s %10s %10s %10s %10s %14s %14s %4s\n", "Node", "TX", "RX", "RX self",
+           "RX lost", "RX filt", "RX lat avg us", "RX lat max us", "LED");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlSim_Port_t* const port = &gPorts[i];
+        const double avgLatencyUs = port->framesReceived
+                                    ? (double) port->latencySumNanos
+                                      / (double) port->framesReceived / 1000.0
+                                    : 0.0;
+        printf("%-8s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+               " %14.1f %14.1f %4" PRIu32 "\n",
+               port->name,
+               port->framesTransmitted,
+               port->framesReceived,
+               port->framesSelfReceived,
+               port->framesLostNoMailbox,
+               port->framesFilteredInHw,
+               avgLatencyUs,
+               (double) port->latencyMaxNanos / 1000.0,
+               port->ledColor(&gPorts[i]));
+    }
+    printf("%-8s %10s %10s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+           "Node", "TX sent", "TX drop", "TX HWM",
+           "RX enq", "RX drop", "RX lost HW", "RX HWM", "Processed", "Ignored", "Secwarns");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        uint32_t secWarnings = 0U;
+        for (size_t warnClass = 0U; warnClass < HZL_PLATFORM_TELEMETRY_SECWARN_AMOUNT; warnClass++)
+        {
+            secWarnings += telemetry.rxSecWarnings[warnClass];
+        }
+        printf("%-8s %10" PRIu32 " %10" PRIu32 " %10" PRIu32
+               " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32
+               " %10" PRIu32 " %10" PRIu32 "\n",
+               gPorts[i].name,
+               telemetry.txFramesSent,
+               telemetry.txFramesDroppedQueueFull,
+               telemetry.txQueueHighWaterMark,
+               telemetry.rxFramesEnqueued,
+               telemetry.rxFramesDroppedQueueFull,
+               telemetry.rxFramesLostInHw,
+               telemetry.rxQueueHighWaterMark,
+               telemetry.rxFramesProcessed,
+               telemetry.rxFramesIgnored,
+               secWarnings);
+    }
+    printf("%-8s %10s %10s %12s %12s %10s %10s %10s %10s %10s %10s\n", "Node", "Handshakes",
+           "HS avg ms", "HS max ms", "Timeouts", "Ctl enq", "Ctl drop", "Resyncs", "Held off",
+           "REQ sent", "REQ defer");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        const double avgHandshakeMs = telemetry.handshakesCompleted
+                                      ? (double) telemetry.handshakeSumMicros
+                                        / (double) telemetry.handshakesCompleted / 1000.0
+                                      : 0.0;
+        printf("%-8s %10" PRIu32 " %10.3f %12.3f %10" PRIu32 " %10" PRIu32 " %10" PRIu32
+               " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n",
+               gPorts[i].name,
+               telemetry.handshakesCompleted,
+               avgHandshakeMs,
+               (double) telemetry.handshakeMaxMicros / 1000.0,
+               telemetry.rxSecWarnings[HZL_PLATFORM_TELEMETRY_SECWARN_RESPONSE_TIMEOUT],
+               telemetry.rxControlFramesEnqueued,
+               telemetry.rxControlFramesDropped,
+               telemetry.secWarnResyncs,
+               telemetry.secWarnResyncsHeldOff,
+               telemetry.handshakeRequestsSent,
+               telemetry.handshakeRequestsDeferred);
+    }
+    printf("%-8s %10s %10s %10s %10s %10s %10s %12s\n", "Node", "Gen msg/s", "TX drop",
+           "Sec RX/s", "Decr/s", "Decrypt %", "RX drop", "Goodput B/s");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        const double decryptPercent = telemetry.rxSecuredFramesProcessed
+                                      ? 100.0 * (double) telemetry.rxSecuredFramesDecrypted
+                                        / (double) telemetry.rxSecuredFramesProcessed
+                                      : 0.0;
+        // Lost anywhere between the mailboxes and the application.
+        const uint32_t rxDropped = telemetry.rxFramesDroppedQueueFull
+                                   + telemetry.rxFramesLostInHw
+                                   + telemetry.pipelineAppQueueFull;
+        printf("%-8s %10.1f %10" PRIu32 " %10.1f %10.1f %10.2f %10" PRIu32 " %12.1f\n",
+               gPorts[i].name,
+               (double) telemetry.trafficMessagesGenerated / elapsedSeconds,
+               telemetry.txFramesDroppedQueueFull + telemetry.pipelineTxQueueFull,
+               (double) telemetry.rxSecuredFramesProcessed / elapsedSeconds,
+               (double) telemetry.rxSecuredFramesDecrypted / elapsedSeconds,
+               decryptPercent,
+               rxDropped,
+               (double) telemetry.rxSecuredPlaintextBytes / elapsedSeconds);
+    }
+    printf("%-8s %10s %10s %12s %12s %10s %10s\n", "Node", "App msgs", "App msg/s",
+           "E2E avg us", "E2E max us", "App qfull", "TX qfull");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        const double avgAppLatencyUs = telemetry.appMessagesConsumed
+                                       ? (double) telemetry.appLatencySumMicros
+                                         / (double) telemetry.appMessagesConsumed
+                                       : 0.0;
+        printf("%-8s %10" PRIu32 " %10.1f %12.1f %12" PRIu32 " %10" PRIu32 " %10" PRIu32 "\n",
+               gPorts[i].name,
+               telemetry.appMessagesConsumed,
+               (double) telemetry.appMessagesConsumed / elapsedSeconds,
+               avgAppLatencyUs,
+               telemetry.appLatencyMaxMicros,
+               telemetry.pipelineAppQueueFull,
+               telemetry.pipelineTxQueueFull);
+    }
+    printf("%-8s %10s %10s %10s %10s\n", "Node", "Agg msgs", "Aggregates", "Msgs/frame",
+           "Agg bad");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        const double messagesPerFrame = telemetry.txAggregatesSecured
+                                        ? (double) telemetry.txMessagesAggregated
+                                          / (double) telemetry.txAggregatesSecured
+                                        : 0.0;
+        printf("%-8s %10" PRIu32 " %10" PRIu32 " %10.2f %10" PRIu32 "\n",
+               gPorts[i].name,
+               telemetry.txMessagesAggregated,
+               telemetry.txAggregatesSecured,
+               messagesPerFrame,
+               telemetry.rxAggregatesMalformed);
+    }
+    printf("%-8s %10s %10s %10s %10s %10s %10s %10s\n", "Node", "Prefilt", "Myself",
+           "Unknown", "SID bad", "Malformed", "Foreign G", "AEAD saved");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const hzlPlatform_TelemetryBus_t telemetry = hzlSim_TelemetryAllBuses(gPorts[i].telemetry);
+        uint32_t prefiltered = 0U;
+        for (size_t reason = 0U; reason < HZL_PLATFORM_TELEMETRY_PREFILTER_AMOUNT; reason++)
+        {
+            prefiltered += telemetry.rxFramesPrefiltered[reason];
+        }
+        printf("%-8s %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32
+               " %10" PRIu32 " %10" PRIu32 "\n",
+               gPorts[i].name,
+               prefiltered,
+               telemetry.rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_FROM_MYSELF],
+               telemetry.rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_UNKNOWN_SENDER],
+               telemetry.rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_SID_MISMATCH],
+               telemetry.rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_MALFORMED],
+               telemetry.rxFramesPrefiltered[HZL_PLATFORM_TELEMETRY_PREFILTER_FOREIGN_GROUP],
+               telemetry.rxAeadVerificationsSaved);
+    }
+    printf("%-8s %10s %16s %16s %10s %10s %10s %10s %10s\n", "Node", "Events", "Ev lat avg us",
+           "Ev lat max us", "Log sent", "Log coal", "Log drop", "Rnd pool", "Rnd direct");
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        const volatile hzlPlatform_Telemetry_t* const telemetry = gPorts[i].telemetry;
+        const double avgEventLatency = telemetry->eventsHandled
+                                       ? (double) telemetry->eventLatencySumMicros
+                                         / (double) telemetry->eventsHandled
+                                       : 0.0;
+        printf("%-8s %10" PRIu32 " %16.3f %16" PRIu32 " %10" PRIu32 " %10" PRIu32 " %10" PRIu32
+               " %10" PRIu32 " %10" PRIu32 "\n",
+               gPorts[i].name,
+               telemetry->eventsHandled,
+               avgEventLatency,
+               telemetry->eventLatencyMaxMicros,
+               telemetry->logMessagesSent,
+               telemetry->logMessagesCoalesced,
+               telemetry->logMessagesDropped,
+               telemetry->entropyRequestsFromPool,
+               telemetry->entropyRequestsDirect);
+    }
+    // All nodes share the scheduler, so any node's snapshot covers all tasks.
+    const volatile hzlPlatform_CpuStats_t* const cpuStats = gPorts[0].cpuStats;
+    printf("CPU share in the last %u ticks (%" PRIu32 " snapshots)\n",
+           HZL_PLATFORM_CPU_STATS_PERIOD_TICKS, cpuStats->snapshots);
+    printf("%-10s %10s %16s\n", "Task", "CPU %", "Stack free words");
+    for (uint32_t i = 0U; i < cpuStats->tasksAmount; i++)
+    {
+        const volatile hzlPlatform_CpuStatsTask_t* const task = &cpuStats->tasks[i];
+        printf("%-10.*s %10.1f %16" PRIu32 "\n",
+               (int) sizeof(task->name), (const char*) task->name,
+               (double) task->sharePermille / 10.0,
+               task->stackHighWaterMarkWords);
+    }
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+    hzlSim_PrintLatencyHists();
+#endif
+}
+
+/**
+ * @internal
+ * Checks the resynchronisations caused by the security warnings, printing what fails:
+ * - with forged frames, each node resynchronised each bus at most once per
+ *   #HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS;
+ * - with the Session renewal lost, at least one Client resynchronised.
+ *
+ * @returns whether all checks passed
+ */
+static bool
+hzlSim_CheckResyncs(const uint64_t elapsedNanos)
+{
+    bool isPassed = true;
+    if (gForgeryFramesPerSecond != 0U)
+    {
+        // The first resynchronisation may come at any time, the holdoff applies after it.
+        const uint64_t maxResyncs =
+            elapsedNanos / 1000U / HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS + 1U;
+        for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+        {
+            for (size_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+            {
+                const uint32_t resyncs = gPorts[i].telemetry->buses[bus].secWarnResyncs;
+                if (resyncs > maxResyncs)
+                {
+                    printf("FAILED: %s resynchronised bus %zu %" PRIu32 " times, at most %" PRIu64
+                           " allowed\n", gPorts[i].name, bus, resyncs, maxResyncs);
+                    isPassed = false;
+                }
+            }
+        }
+    }
+    if (gRenewalSeconds != 0U)
+    {
+        uint32_t clientResyncs = 0U;
+        // All nodes but the Server, which is the first one.
+        for (size_t i = 1U; i < HZL_SIM_NODES_AMOUNT; i++)
+        {
+            clientResyncs += hzlSim_TelemetryAllBuses(gPorts[i].telemetry).secWarnResyncs;
+        }
+        if (clientResyncs == 0U)
+        {
+            printf("FAILED: no Client resynchronised after the lost Session renewal\n");
+            isPassed = false;
+        }
+    }
+    return isPassed;
+}
+
+/**
+ * @internal
+ * Whether every Client, i.e. every node but the Server, completed a handshake on every bus.
+ */
+static bool
+hzlSim_AllSessionsEstablished(void)
+{
+    for (size_t i = 1U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        for (size_t bus = 0U; bus < HZL_SIM_BUSES_AMOUNT; bus++)
+        {
+            if (gPorts[i].telemetry->buses[bus].handshakesCompleted == 0U)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @internal
+ * Lets the nodes run for the requested time, then reports and terminates the process, with a
+ * failure status if hzlSim_CheckResyncs() fails.
+ */
+static void
+hzlSim_TaskMonitor(void* const unusedParam)
+{
+    (void) unusedParam;
+    const uint64_t start = hzlSim_NowNanos();
+    if (gIsHandshakeLoop)
+    {
+        for (unsigned long elapsedMs = 0U; elapsedMs < gDurationSeconds * 1000UL;
+             elapsedMs += HZL_SIM_HANDSHAKE_PERIOD_MS)
+        {
+            vTaskDelay(pdMS_TO_TICKS(HZL_SIM_HANDSHAKE_PERIOD_MS));
+            if (gAllSessionsNanos == 0U && hzlSim_AllSessionsEstablished())
+            {
+                // Only to the period: the first presses restart the handshakes anyway.
+                gAllSessionsNanos = hzlSim_NowNanos() - start;
+            }
+            // All nodes but the Server, which is the first one.
+            for (size_t i = 1U; i < HZL_SIM_NODES_AMOUNT; i++)
+            {
+                gPorts[i].pressButton2(&gPorts[i]);
+            }
+        }
+    }
+    else
+    {
+        // Every tick until all Sessions are established, then straight to the end.
+        const TickType_t durationTicks = pdMS_TO_TICKS(gDurationSeconds * 1000UL);
+        TickType_t elapsedTicks = 0U;
+        while (elapsedTicks < durationTicks && !hzlSim_AllSessionsEstablished())
+        {
+            vTaskDelay(1U);
+            elapsedTicks++;
+        }
+        if (elapsedTicks < durationTicks)
+        {
+            gAllSessionsNanos = hzlSim_NowNanos() - start;
+        }
+        const TickType_t renewalTicks = pdMS_TO_TICKS(gRenewalSeconds * 1000UL);
+        if (gRenewalSeconds != 0U && elapsedTicks < renewalTicks && renewalTicks < durationTicks)
+        {
+            vTaskDelay(renewalTicks - elapsedTicks);
+            elapsedTicks = renewalTicks;
+            hzlSim_BusLoseRen();
+            // The Server is the first node.
+            gPorts[0].pressButton2(&gPorts[0]);
+        }
+        if (elapsedTicks < durationTicks)
+        {
+            vTaskDelay(durationTicks - elapsedTicks);
+        }
+    }
+    const uint64_t elapsedNanos = hzlSim_NowNanos() - start;
+    hzlSim_PrintReport((double) elapsedNanos / 1e9);
+    const bool isPassed = hzlSim_CheckResyncs(elapsedNanos);
+    fflush(stdout);
+    exit(isPassed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+int
+main(const int argc, const char* const argv[])
+{
+    if (argc > 1)
+    {
+        gDurationSeconds = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2)
+    {
+        gNoiseFramesPerSecond = (uint32_t) strtoul(argv[2], NULL, 10);
+    }
+    if (argc > 3)
+    {
+        gLoadFramesPerSecond = (uint32_t) strtoul(argv[3], NULL, 10);
+        gIsHandshakeLoop = true;
+    }
+    if (argc > 4)
+    {
+        // The handshakes must come from the forged frames only.
+        gForgeryFramesPerSecond = (uint32_t) strtoul(argv[4], NULL, 10);
+        gIsHandshakeLoop = false;
+    }
+    if (argc > 5)
+    {
+        gRenewalSeconds = strtoul(argv[5], NULL, 10);
+    }
+    hzlSim_BusInit();
+    hzlSim_BusNoiseStart(gNoiseFramesPerSecond);
+    hzlSim_BusLoadStart(gLoadFramesPerSecond);
+    hzlSim_BusForgeryStart(gForgeryFramesPerSecond);
+    for (size_t i = 0U; i < HZL_SIM_NODES_AMOUNT; i++)
+    {
+        gNodeStartFuncs[i](&gPorts[i]);
+    }
+    const BaseType_t created = xTaskCreate(
+        hzlSim_TaskMonitor,
+        "SimMon",
+        configMINIMAL_STACK_SIZE * 4U,
+        NULL,
+        HZL_SIM_TASK_PRIORITY_MONITOR,
+        NULL);
+    if (created != pdPASS)
+    {
+        fprintf(stderr, "Cannot create the monitor task\n");
+        return EXIT_FAILURE;
+    }
+    vTaskStartScheduler();
+    return EXIT_FAILURE;  // The scheduler never returns in the POSIX port.
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Start function of ONE simulated node, replacing hzlPlatform_FreeRtosStart.c and the fatal
+ * error handling of hzlPlatform_FreeRtosHooks.c, which are specific to the S32K144.
+ *
+ * Compiled once per role, exactly like the platform sources.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hzlPlatform.h"
+#include "hzlPlatform_FatalError.h"
+#include "hzlPlatform_Telemetry.h"
+#include "hzlPlatform_CpuStats.h"
+#include "hzlSim.h"
+
+#if defined(HZL_PLATFORM_ROLE_SERVER)
+#define HZL_SIM_NODE_NAME "Server"
+#define HZL_SIM_NODE_START hzlSim_NodeStartServer
+#elif defined(HZL_PLATFORM_ROLE_ALICE)
+#define HZL_SIM_NODE_NAME "Alice"
+#define HZL_SIM_NODE_START hzlSim_NodeStartAlice
+#elif defined(HZL_PLATFORM_ROLE_BOB)
+#define HZL_SIM_NODE_NAME "Bob"
+#define HZL_SIM_NODE_START hzlSim_NodeStartBob
+#elif defined(HZL_PLATFORM_ROLE_CHARLIE)
+#define HZL_SIM_NODE_NAME "Charlie"
+#define HZL_SIM_NODE_START hzlSim_NodeStartCharlie
+#elif defined(HZL_PLATFORM_ROLE_CLIENT)
+#define HZL_SIM_STRINGIFY(x) HZL_SIM_STRINGIFY_EXPANDED(x)
+#define HZL_SIM_STRINGIFY_EXPANDED(x) #x
+#define HZL_SIM_NODE_START_OF(sid) HZL_SIM_NODE_START_OF_EXPANDED(sid)
+#define HZL_SIM_NODE_START_OF_EXPANDED(sid) hzlSim_NodeStartClient##sid
+// The SID is passed without the U suffix, as it is part of the name.
+#define HZL_SIM_NODE_NAME "Client" HZL_SIM_STRINGIFY(HZL_PLATFORM_CLIENT_SID)
+#define HZL_SIM_NODE_START HZL_SIM_NODE_START_OF(HZL_PLATFORM_CLIENT_SID)
+#endif
+
+/** The TaskHzl of the main bus, which the buttons notify. */
+static TaskHandle_t gTaskHzl;
+
+/**
+ * @internal
+ * On the host there is no LED to blink forever: print the color pair and terminate the whole
+ * simulation, as the results would be meaningless anyway.
+ */
+void
+hzlPlatform_FatalCrashAlternating(const hzlPlatform_RgbColor_t longer,
+                                  const hzlPlatform_RgbColor_t shorter)
+{
+    fprintf(stderr, "FATAL: node %s crashed with colors %u,%u (see hzlPlatform_FatalError.h)\n",
+            HZL_SIM_NODE_NAME, (unsigned) longer, (unsigned) shorter);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @internal
+ * Notifies the TaskHzl like the Button 2 interrupt does upon a short press.
+ */
+static void
+hzlSim_NodePressButton2(hzlSim_Port_t* const port)
+{
+    (void) port;
+    hzlPlatform_TelemetryEventRaised(HZL_PLATFORM_BUS_MAIN,
+        HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED);
+    xTaskNotify(gTaskHzl, HZL_PLATFORM_TASK_EVENT_BUTTON_2_PRESSED, eSetBits);
+}
+
+__attribute__((visibility("default"))) void
+HZL_SIM_NODE_START(hzlSim_Port_t* const port)
+{
+    port->name = HZL_SIM_NODE_NAME;
+    port->telemetry = &hzlPlatform_Telemetry;
+    port->cpuStats = &hzlPlatform_CpuStats;
+    port->pressButton2 = hzlSim_NodePressButton2;
+#if defined(HZL_PLATFORM_LATENCY_HIST)
+    port->latencyHists = hzlPlatform_LatencyHists;
+#endif
+    hzlSim_SdkBind(port, HZL_PLATFORM_CANID_FROM_ME);
+    hzlPlatform_RgbLedInit(NULL);
+    hzlSim_BusAttach(port);
+    // Only the TaskHzl of the main bus: it creates the ones of the other buses.
+    const BaseType_t created = xTaskCreate(
+        hzlPlatform_TaskHzl,
+        "TaskHzl",
+        HZL_PLATFORM_TASK_STACK_WORDS_HZL,
+        NULL,
+        HZL_PLATFORM_TASK_PRIORITY_HZL,
+        &gTaskHzl);
+    if (created != pdPASS)
+    {
+        hzlPlatform_FatalCrashAlternating(HZL_PLATFORM_CRASH_RTOS_TASK_CREATION);
+    }
+}
@@ -0,0 +1,572 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Simulated S32K144 peripherals of ONE node: FLEXCAN mailboxes connected to the virtual bus,
+ * a repeatable pseudo-random CSEc, GPIO registers for the RGB LED and buttons and a table of
+ * installed interrupt handlers.
+ *
+ * This file is compiled once per node, so every static variable here is a per-node peripheral.
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hzlSim_Sdk.h"
+#include "hzlSim.h"
+
+#define HZL_SIM_FLEXCAN_CS_CODE_SHIFT 24U
+#define HZL_SIM_FLEXCAN_CS_CODE_FULL 0x2U
+#define HZL_SIM_FLEXCAN_CS_CODE_OVERRUN 0x6U
+
+/**
+ * @internal
+ * State of a simulated FLEXCAN instance.
+ */
+typedef struct hzlSim_Flexcan
+{
+    bool isInitialised;
+    flexcan_state_t* state;
+    /** Non-NULL when the mailbox is armed for reception with FLEXCAN_DRV_Receive(). */
+    flexcan_msgbuff_t* rxBuffer[HZL_SIM_FLEXCAN_MAILBOXES];
+    bool isRxMailbox[HZL_SIM_FLEXCAN_MAILBOXES];
+    uint32_t filterId[HZL_SIM_FLEXCAN_MAILBOXES];
+    uint32_t filterMask[HZL_SIM_FLEXCAN_MAILBOXES];
+    /** A frame was dropped while the mailbox was not armed: report it on its next reception. */
+    bool isOverrun[HZL_SIM_FLEXCAN_MAILBOXES];
+    /** The TX mailbox holds a frame the bus did not carry yet. */
+    bool isTxBusy[HZL_SIM_FLEXCAN_MAILBOXES];
+    /** Arbitration-phase and data-phase bit durations, from the programmed time segments. */
+    hzlSim_BitTiming_t bitTiming;
+} hzlSim_Flexcan_t;
+
+/** Nominal bit timing of ProcessorExpert.pe: 500 kbit/s from the 40 MHz protocol clock. */
+#define HZL_SIM_FLEXCAN_BITRATE \
+    {.propSeg = 7U, .phaseSeg1 = 4U, .phaseSeg2 = 1U, .preDivider = 4U, .rJumpwidth = 1U}
+/** Data-phase bit timing of ProcessorExpert.pe: 500 kbit/s as well. */
+#define HZL_SIM_FLEXCAN_BITRATE_CBT \
+    {.propSeg = 29U, .phaseSeg1 = 4U, .phaseSeg2 = 4U, .preDivider = 1U, .rJumpwidth = 1U}
+
+GPIO_Type hzlSim_GpioC;
+GPIO_Type hzlSim_GpioD;
+PORT_Type hzlSim_PortC;
+PORT_Type hzlSim_PortD;
+CAN_Type hzlSim_Can[HZL_SIM_FLEXCAN_INSTANCES];
+pin_settings_config_t g_pin_mux_InitConfigArr[1];
+clock_manager_user_config_t clockMan1_InitConfig0;
+csec_state_t csec1_State;
+flexcan_state_t canCom1_State;
+const flexcan_user_config_t canCom1_InitConfig0 =
+{
+    .max_num_mb = HZL_SIM_FLEXCAN_MAILBOXES,
+    .fd_enable = true,
+    .bitrate = HZL_SIM_FLEXCAN_BITRATE,
+    .bitrate_cbt = HZL_SIM_FLEXCAN_BITRATE_CBT,
+};
+flexcan_state_t canCom2_State;
+const flexcan_user_config_t canCom2_InitConfig0 =
+{
+    .max_num_mb = HZL_SIM_FLEXCAN_MAILBOXES,
+    .fd_enable = true,
+    .bitrate = HZL_SIM_FLEXCAN_BITRATE,
+    .bitrate_cbt = HZL_SIM_FLEXCAN_BITRATE_CBT,
+};
+flexcan_state_t canCom3_State;
+const flexcan_user_config_t canCom3_InitConfig0 =
+{
+    .max_num_mb = HZL_SIM_FLEXCAN_MAILBOXES,
+    .fd_enable = true,
+    .bitrate = HZL_SIM_FLEXCAN_BITRATE,
+    .bitrate_cbt = HZL_SIM_FLEXCAN_BITRATE_CBT,
+};
+
+static hzlSim_Port_t* gPort = NULL;
+static uint64_t gTrngState = 0U;
+static isr_t gIsrTable[HZL_SIM_IRQn_AMOUNT];
+static hzlSim_Flexcan_t gFlexcan[HZL_SIM_FLEXCAN_INSTANCES];
+
+// ------------- Interrupt manager -----------------
+
+void
+INT_SYS_InstallHandler(const IRQn_Type irqNumber, const isr_t newHandler, isr_t* const oldHandler)
+{
+    if (oldHandler != NULL)
+    {
+        *oldHandler = gIsrTable[irqNumber];
+    }
+    gIsrTable[irqNumber] = newHandler;
+}
+
+void
+INT_SYS_EnableIRQ(const IRQn_Type irqNumber)
+{
+    (void) irqNumber;
+}
+
+void
+INT_SYS_DisableIRQ(const IRQn_Type irqNumber)
+{
+    (void) irqNumber;
+}
+
+void
+INT_SYS_SetPriority(const IRQn_Type irqNumber, const uint8_t priority)
+{
+    (void) irqNumber;
+    (void) priority;
+}
+
+// ------------- Clock manager -----------------
+
+status_t
+CLOCK_DRV_Init(const clock_manager_user_config_t* const config)
+{
+    (void) config;
+    return STATUS_SUCCESS;
+}
+
+// ------------- Pins -----------------
+
+status_t
+PINS_DRV_Init(const uint32_t pinCount, const pin_settings_config_t config[])
+{
+    (void) pinCount;
+    (void) config;
+    return STATUS_SUCCESS;
+}
+
+void
+PINS_DRV_SetMuxModeSel(PORT_Type* const base, const uint32_t pin, const port_mux_t mux)
+{
+    (void) base;
+    (void) pin;
+    (void) mux;
+}
+
+void
+PINS_DRV_SetPinIntSel(PORT_Type* const base, const uint32_t pin,
+                      const port_interrupt_config_t intConfig)
+{
+    (void) base;
+    (void) pin;
+    (void) intConfig;
+}
+
+uint32_t
+PINS_DRV_GetPortIntFlag(const PORT_Type* const base)
+{
+    return base->ISFR;
+}
+
+void
+PINS_DRV_ClearPortIntFlagCmd(PORT_Type* const base)
+{
+    base->ISFR = 0U;
+}
+
+void
+PINS_DRV_SetPinsDirection(GPIO_Type* const base, const pins_channel_type_t pins)
+{
+    base->PDDR = pins;
+}
+
+void
+PINS_DRV_SetPinDirection(GPIO_Type* const base, const pins_channel_type_t pin,
+                         const pins_level_type_t direction)
+{
+    if (direction)
+    {
+        base->PDDR |= 1U << pin;
+    }
+    else
+    {
+        base->PDDR &= ~(1U << pin);
+    }
+}
+
+void
+PINS_DRV_WritePin(GPIO_Type* const base, const pins_channel_type_t pin,
+                  const pins_level_type_t value)
+{
+    if (value)
+    {
+        base->PDOR |= 1U << pin;
+    }
+    else
+    {
+        base->PDOR &= ~(1U << pin);
+    }
+}
+
+void
+PINS_DRV_SetPins(GPIO_Type* const base, const pins_channel_type_t pins)
+{
+    base->PDOR |= pins;
+}
+
+void
+PINS_DRV_ClearPins(GPIO_Type* const base, const pins_channel_type_t pins)
+{
+    base->PDOR &= ~pins;
+}
+
+void
+PINS_DRV_TogglePins(GPIO_Type* const base, const pins_channel_type_t pins)
+{
+    base->PDOR ^= pins;
+}
+
+pins_channel_type_t
+PINS_DRV_ReadPins(const GPIO_Type* const base)
+{
+    return base->PDIR;
+}
+
+// ------------- CSEc -----------------
+
+void
+CSEC_DRV_Init(csec_state_t* const state)
+{
+    (void) state;
+}
+
+status_t
+CSEC_DRV_InitRNG(void)
+{
+    return STATUS_SUCCESS;
+}
+
+/**
+ * @internal
+ * SplitMix64 generator: NOT cryptographically secure, but repeatable across runs, which is what
+ * a benchmark needs.
+ */
+static uint64_t
+hzlSim_TrngNext(void)
+{
+    uint64_t z = (gTrngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+}
+
+status_t
+CSEC_DRV_GenerateRND(uint8_t* const rnd)
+{
+    for (size_t i = 0U; i < 16U; i += sizeof(uint64_t))
+    {
+        const uint64_t word = hzlSim_TrngNext();
+        memcpy(&rnd[i], &word, sizeof(word));
+    }
+    return STATUS_SUCCESS;
+}
+
+// ------------- FLEXCAN -----------------
+
+/**
+ * @internal
+ * Duration of a bit with the given time segments, with the register semantics of the
+ * arbitration phase (CTRL1) or of the data phase (FDCBT), where the propagation segment is not
+ * offset by one.
+ */
+static uint32_t
+hzlSim_FlexcanBitNanos(const flexcan_time_segment_t* const segments, const bool isDataPhase)
+{
+    const uint32_t timeQuanta = 1U + segments->propSeg + (isDataPhase ? 0U : 1U)
+                                + segments->phaseSeg1 + 1U + segments->phaseSeg2 + 1U;
+    return (uint32_t) ((uint64_t) (segments->preDivider + 1U) * timeQuanta * 1000000000ULL
+                       / HZL_SIM_FLEXCAN_CLOCK_HZ);
+}
+
+status_t
+FLEXCAN_DRV_Init(const uint8_t instance, flexcan_state_t* const state,
+                 const flexcan_user_config_t* const data)
+{
+    if (instance >= HZL_SIM_FLEXCAN_INSTANCES)
+    {
+        return STATUS_ERROR;
+    }
+    memset(&gFlexcan[instance], 0, sizeof(gFlexcan[instance]));
+    hzlSim_Can[instance].MCR = 0U;  // The soft reset enables the self reception again.
+    gFlexcan[instance].state = state;
+    gFlexcan[instance].bitTiming.nominalBitNanos = hzlSim_FlexcanBitNanos(&data->bitrate, false);
+    gFlexcan[instance].bitTiming.dataBitNanos = hzlSim_FlexcanBitNanos(&data->bitrate_cbt, true);
+    gFlexcan[instance].isInitialised = true;
+    return STATUS_SUCCESS;
+}
+
+void
+FLEXCAN_DRV_SetBitrateCbt(const uint8_t instance, const flexcan_time_segment_t* const bitrate)
+{
+    gFlexcan[instance].bitTiming.dataBitNanos = hzlSim_FlexcanBitNanos(bitrate, true);
+}
+
+void
+FLEXCAN_DRV_SetTDCOffset(const uint8_t instance, const bool enable, const uint8_t offset)
+{
+    // No transceiver loop delay on the virtual bus.
+    (void) instance;
+    (void) enable;
+    (void) offset;
+}
+
+status_t
+FLEXCAN_DRV_Deinit(const uint8_t instance)
+{
+    gFlexcan[instance].isInitialised = false;
+    return STATUS_SUCCESS;
+}
+
+void
+FLEXCAN_DRV_SetRxMaskType(const uint8_t instance, const flexcan_rx_mask_type_t type)
+{
+    (void) instance;
+    (void) type;
+}
+
+status_t
+FLEXCAN_DRV_SetRxIndividualMask(const uint8_t instance,
+                                const flexcan_msgbuff_id_type_t idType,
+                                const uint8_t mbIdx,
+                                const uint32_t mask)
+{
+    (void) idType;
+    if (mbIdx >= HZL_SIM_FLEXCAN_MAILBOXES)
+    {
+        return STATUS_ERROR;
+    }
+    gFlexcan[instance].filterMask[mbIdx] = mask;
+    return STATUS_SUCCESS;
+}
+
+status_t
+FLEXCAN_DRV_ConfigTxMb(const uint8_t instance, const uint8_t mbIdx,
+                       const flexcan_data_info_t* const txInfo, const uint32_t msgId)
+{
+    (void) txInfo;
+    (void) msgId;
+    if (mbIdx >= HZL_SIM_FLEXCAN_MAILBOXES)
+    {
+        return STATUS_ERROR;
+    }
+    gFlexcan[instance].isRxMailbox[mbIdx] = false;
+    gFlexcan[instance].rxBuffer[mbIdx] = NULL;
+    gFlexcan[instance].isTxBusy[mbIdx] = false;
+    return STATUS_SUCCESS;
+}
+
+status_t
+FLEXCAN_DRV_ConfigRxMb(const uint8_t instance, const uint8_t mbIdx,
+                       const flexcan_data_info_t* const rxInfo, const uint32_t msgId)
+{
+    (void) rxInfo;
+    if (mbIdx >= HZL_SIM_FLEXCAN_MAILBOXES)
+    {
+        return STATUS_ERROR;
+    }
+    gFlexcan[instance].isRxMailbox[mbIdx] = true;
+    gFlexcan[instance].filterId[mbIdx] = msgId;
+    return STATUS_SUCCESS;
+}
+
+status_t
+FLEXCAN_DRV_Receive(const uint8_t instance, const uint8_t mbIdx, flexcan_msgbuff_t* const data)
+{
+    if (mbIdx >= HZL_SIM_FLEXCAN_MAILBOXES || !gFlexcan[instance].isRxMailbox[mbIdx])
+    {
+        return STATUS_ERROR;
+    }
+    if (gFlexcan[instance].rxBuffer[mbIdx] != NULL)
+    {
+        return STATUS_BUSY;
+    }
+    gFlexcan[instance].rxBuffer[mbIdx] = data;
+    return STATUS_SUCCESS;
+}
+
+status_t
+FLEXCAN_DRV_Send(const uint8_t instance, const uint8_t mbIdx,
+                 const flexcan_data_info_t* const txInfo, const uint32_t msgId,
+                 const uint8_t* const mbData)
+{
+    hzlSim_Flexcan_t* const flexcan = &gFlexcan[instance];
+    if (!flexcan->isInitialised || mbIdx >= HZL_SIM_FLEXCAN_MAILBOXES
+        || flexcan->isRxMailbox[mbIdx])
+    {
+        return STATUS_ERROR;
+    }
+    if (flexcan->isTxBusy[mbIdx])
+    {
+        return STATUS_BUSY;
+    }
+    // Without BRS the data phase stays at the nominal bitrate.
+    hzlSim_BitTiming_t bitTiming = flexcan->bitTiming;
+    if (!txInfo->enable_brs)
+    {
+        bitTiming.dataBitNanos = bitTiming.nominalBitNanos;
+    }
+    // Each TX mailbox has at most one frame on the bus queue, so it never overflows.
+    // Each FLEXCAN instance is attached to the virtual bus with the same index.
+    if (!hzlSim_BusTransmit(gPort, instance, mbIdx, msgId, mbData, txInfo->data_length,
+                            &bitTiming))
+    {
+        return STATUS_ERROR;
+    }
+    flexcan->isTxBusy[mbIdx] = true;
+    return STATUS_SUCCESS;
+}
+
+void
+FLEXCAN_DRV_InstallEventCallback(const uint8_t instance, const flexcan_callback_t callback,
+                                 void* const callbackParam)
+{
+    gFlexcan[instance].state->callback = callback;
+    gFlexcan[instance].state->callbackParam = callbackParam;
+}
+
+// ------------- Simulation only -----------------
+
+/**
+ * @internal
+ * The FLEXCAN reception interrupt of this node for the FLEXCAN instance attached to the given
+ * bus: stores the frame in the lowest-index armed mailbox whose filter matches, just like the
+ * hardware matching process does. The frames of the node itself take part in the matching
+ * unless its self reception is disabled (MCR[SRXDIS]).
+ */
+static void
+hzlSim_SdkDeliver(hzlSim_Port_t* const port, const uint8_t bus,
+                  const hzlSim_Frame_t* const frame, const bool isOwnFrame)
+{
+    hzlSim_Flexcan_t* const flexcan = &gFlexcan[bus];
+    if (!flexcan->isInitialised
+        || (isOwnFrame && (hzlSim_Can[bus].MCR & CAN_MCR_SRXDIS_MASK) != 0U))
+    {
+        return;
+    }
+    bool isMatchingAnyMailbox = false;
+    uint8_t lastMatchingMbIdx = 0U;
+    for (uint8_t mbIdx = 0U; mbIdx < HZL_SIM_FLEXCAN_MAILBOXES; mbIdx++)
+    {
+        const uint32_t mask = flexcan->filterMask[mbIdx];
+        if (!flexcan->isRxMailbox[mbIdx]
+            || (frame->canId & mask) != (flexcan->filterId[mbIdx] & mask))
+        {
+            continue;
+        }
+        isMatchingAnyMailbox = true;
+        lastMatchingMbIdx = mbIdx;
+        flexcan_msgbuff_t* const rxBuffer = flexcan->rxBuffer[mbIdx];
+        if (rxBuffer == NULL)
+        {
+            continue;  // Mailbox not armed, try the next one.
+        }
+        rxBuffer->cs = (flexcan->isOverrun[mbIdx]
+                        ? HZL_SIM_FLEXCAN_CS_CODE_OVERRUN
+                        : HZL_SIM_FLEXCAN_CS_CODE_FULL) << HZL_SIM_FLEXCAN_CS_CODE_SHIFT;
+        flexcan->isOverrun[mbIdx] = false;
+        rxBuffer->msgId = frame->canId;
+        rxBuffer->dataLen = frame->dataLen;
+        memcpy(rxBuffer->data, frame->data, frame->dataLen);
+        flexcan->rxBuffer[mbIdx] = NULL;  // The driver disarms the mailbox after reception.
+        const uint64_t latency = hzlSim_NowNanos() - frame->txTimestampNanos;
+        port->framesReceived++;
+        port->framesSelfReceived += isOwnFrame ? 1U : 0U;
+        port->latencySumNanos += latency;
+        if (latency > port->latencyMaxNanos)
+        {
+            port->latencyMaxNanos = latency;
+        }
+        if (flexcan->state->callback != NULL)
+        {
+            flexcan->state->callback(bus, FLEXCAN_EVENT_RX_COMPLETE, mbIdx, flexcan->state);
+        }
+        return;
+    }
+    if (isMatchingAnyMailbox)
+    {
+        // The hardware overwrites the last matching mailbox and flags it as overrun.
+        flexcan->isOverrun[lastMatchingMbIdx] = true;
+        port->framesLostNoMailbox++;
+    }
+    else
+    {
+        // No acceptance filter matches: the hardware ignores the frame, no interrupt.
+        port->framesFilteredInHw++;
+    }
+}
+
+/**
+ * @internal
+ * The FLEXCAN transmission-complete interrupt of this node: frees the TX mailbox the bus just
+ * carried the frame of.
+ */
+static void
+hzlSim_SdkTxComplete(hzlSim_Port_t* const port, const uint8_t bus, const uint8_t mbIdx)
+{
+    (void) port;
+    hzlSim_Flexcan_t* const flexcan = &gFlexcan[bus];
+    if (!flexcan->isInitialised || !flexcan->isTxBusy[mbIdx])
+    {
+        return;
+    }
+    flexcan->isTxBusy[mbIdx] = false;
+    if (flexcan->state->callback != NULL)
+    {
+        flexcan->state->callback(bus, FLEXCAN_EVENT_TX_COMPLETE, mbIdx, flexcan->state);
+    }
+}
+
+/**
+ * @internal
+ * Reads back the RGB LED color from the GPIO pins written by hzlPlatform_RgbLed.c.
+ * The pins are active-low, see hzlPlatform_RgbLedSetColor().
+ */
+static uint32_t
+hzlSim_SdkLedColor(hzlSim_Port_t* const port)
+{
+    (void) port;
+    const uint32_t pdor = hzlSim_GpioD.PDOR;
+    uint32_t color = 0U;
+    color |= (pdor & (1U << 15U)) ? 0U : 1U;  // Red
+    color |= (pdor & (1U << 16U)) ? 0U : 2U;  // Green
+    color |= (pdor & (1U << 0U)) ? 0U : 4U;  // Blue
+    return color;
+}
+
+void
+hzlSim_SdkBind(hzlSim_Port_t* const port, const uint64_t trngSeed)
+{
+    gPort = port;
+    gTrngState = trngSeed;
+    port->deliver = hzlSim_SdkDeliver;
+    port->txComplete = hzlSim_SdkTxComplete;
+    port->ledColor = hzlSim_SdkLedColor;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Minimal assertions of the host tests of the header-only platform modules. A failed assertion
+ * is reported with its location and the test goes on, so one run shows all failures; the test
+ * exits with a failure status at the end.
+ */
+
+#ifndef HZL_SIM_TEST_H_
+#define HZL_SIM_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** @internal Failed assertions of the test so far. */
+static unsigned long hzlSim_TestFailures = 0U;
+
+/** Reports the condition with its location if false. */
+#define HZL_SIM_TEST_ASSERT(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #condition); \
+            hzlSim_TestFailures++; \
+        } \
+    } while (0)
+
+/**
+ * Prints the outcome of the test with the given name.
+ *
+ * @returns the exit status of the test: failure if any assertion failed.
+ */
+static inline int
+hzlSim_TestResult(const char* const name)
+{
+    if (hzlSim_TestFailures != 0U)
+    {
+        printf("%s: %lu assertions FAILED\n", name, hzlSim_TestFailures);
+        return EXIT_FAILURE;
+    }
+    printf("%s: passed\n", name);
+    return EXIT_SUCCESS;
+}
+
+#endif  /* HZL_SIM_TEST_H_ */
@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host test of the message aggregation of hzlPlatform_Aggregation.h: the validation of the
+ * received plaintexts, the room left in a batch and the choice of the batch a message goes into.
+ *
+ * Usage: `hzlsim_test_aggregation`, exits with a failure status if any assertion fails.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "hzlPlatform_Aggregation.h"
+#include "hzlSim_Test.h"
+
+/** @internal Any Group: the tests of a single batch do not depend on it. */
+#define HZL_SIM_TEST_GID 3U
+
+/**
+ * @internal
+ * Writes a record of the given length, with arbitrary content, at the given offset.
+ *
+ * @returns the offset after the record
+ */
+static size_t
+hzlSim_TestRecord(uint8_t* const plaintext, const size_t offset, const uint8_t len)
+{
+    plaintext[offset] = len;
+    memset(&plaintext[offset + 1U], 0xA5, len);
+    return offset + 1U + len;
+}
+
+/** @internal Plaintexts accepted or rejected by hzlPlatform_AggIsWellFormed(). */
+static void
+hzlSim_TestWellFormed(void)
+{
+    uint8_t plaintext[HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX] = {0};
+    // Empty plaintext: no records at all.
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, 0U));
+    // Zero-length record, alone and after a valid one.
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, 1U));
+    size_t len = hzlSim_TestRecord(plaintext, 0U, 2U);
+    plaintext[len++] = 0U;
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, len));
+    // Record running past the end, by one byte and by its whole content.
+    len = hzlSim_TestRecord(plaintext, 0U, 4U);
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, len - 1U));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, 1U));
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggIsWellFormed(plaintext, len));
+    // Exact fill of the 49 bytes: one longest message, and two records.
+    len = hzlSim_TestRecord(plaintext, 0U, HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN);
+    HZL_SIM_TEST_ASSERT(len == HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggIsWellFormed(plaintext, len));
+    len = hzlSim_TestRecord(plaintext, 0U, 23U);
+    len = hzlSim_TestRecord(plaintext, len, 24U);
+    HZL_SIM_TEST_ASSERT(len == HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggIsWellFormed(plaintext, len));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggIsWellFormed(plaintext, len - 1U));
+}
+
+/** @internal Room left in a batch, up to the exact fill of its plaintext. */
+static void
+hzlSim_TestBatchBoundaries(void)
+{
+    const uint8_t message[HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN] = {0};
+    hzlPlatform_Aggregator_t agg;
+    hzlPlatform_AggregatorInit(&agg);
+    hzlPlatform_AggBatch_t* const batch = &agg.batches[0];
+    // A free batch takes the longest message of any Group.
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID,
+                                                 HZL_PLATFORM_AGGREGATION_MESSAGE_MAX_LEN));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchIsFull(batch));
+    // 47 of 49 bytes used: room for the record of exactly one more byte.
+    hzlPlatform_AggBatchAppend(batch, HZL_SIM_TEST_GID, message,
+                               HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX - 3U, 100U);
+    HZL_SIM_TEST_ASSERT(batch->len == HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX - 2U);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID, 1U));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID, 2U));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID + 1U, 1U));
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchIsFull(batch));
+    // Exactly full, and well-formed.
+    hzlPlatform_AggBatchAppend(batch, HZL_SIM_TEST_GID, message, 1U, 200U);
+    HZL_SIM_TEST_ASSERT(batch->len == HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX);
+    HZL_SIM_TEST_ASSERT(batch->messages == 2U);
+    HZL_SIM_TEST_ASSERT(batch->deadlineMicros == 100U);
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID, 1U));
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchIsFull(batch));
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggIsWellFormed(batch->data, batch->len));
+    // One byte short of the exact fill is full as well: a record needs 2 bytes at least.
+    hzlPlatform_AggregatorInit(&agg);
+    hzlPlatform_AggBatchAppend(batch, HZL_SIM_TEST_GID, message,
+                               HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX - 2U, 100U);
+    HZL_SIM_TEST_ASSERT(batch->len == HZL_PLATFORM_AGGREGATION_PLAINTEXT_MAX - 1U);
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchFits(batch, HZL_SIM_TEST_GID, 1U));
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchIsFull(batch));
+}
+
+/** @internal Batch of a new Group with all batches in use: the one due first is replaced. */
+static void
+hzlSim_TestBatchReplacement(void)
+{
+    const uint8_t message[1] = {0};
+    hzlPlatform_Aggregator_t agg;
+    hzlPlatform_AggregatorInit(&agg);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorNextDeadline(&agg) == UINT64_MAX);
+    // Open every batch, for the Groups 0, 1, ... The middle one is due first.
+    const size_t dueFirstIdx = HZL_PLATFORM_AGGREGATION_BATCHES / 2U;
+    for (size_t i = 0U; i < HZL_PLATFORM_AGGREGATION_BATCHES; i++)
+    {
+        const hzl_Gid_t gid = (hzl_Gid_t) i;
+        hzlPlatform_AggBatch_t* const batch = hzlPlatform_AggregatorBatchOf(&agg, gid);
+        HZL_SIM_TEST_ASSERT(batch == &agg.batches[i]);
+        HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchFits(batch, gid, 1U));
+        hzlPlatform_AggBatchAppend(batch, gid, message, sizeof(message),
+                                   (i == dueFirstIdx) ? 1000U : 2000U + i);
+    }
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorNextDeadline(&agg) == 1000U);
+    // A Group with an open batch keeps it.
+    for (size_t i = 0U; i < HZL_PLATFORM_AGGREGATION_BATCHES; i++)
+    {
+        HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorBatchOf(&agg, (hzl_Gid_t) i)
+                            == &agg.batches[i]);
+    }
+    // A new Group gets the batch due first, which must be secured before.
+    const hzl_Gid_t newGid = (hzl_Gid_t) HZL_PLATFORM_AGGREGATION_BATCHES;
+    hzlPlatform_AggBatch_t* const replaced = hzlPlatform_AggregatorBatchOf(&agg, newGid);
+    HZL_SIM_TEST_ASSERT(replaced == &agg.batches[dueFirstIdx]);
+    HZL_SIM_TEST_ASSERT(!hzlPlatform_AggBatchFits(replaced, newGid, 1U));
+    // Once secured and freed, the new Group opens it with its own deadline.
+    replaced->messages = 0U;
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorBatchOf(&agg, newGid) == replaced);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggBatchFits(replaced, newGid, 1U));
+    hzlPlatform_AggBatchAppend(replaced, newGid, message, sizeof(message), 3000U);
+    HZL_SIM_TEST_ASSERT(replaced->gid == newGid);
+    HZL_SIM_TEST_ASSERT(replaced->len == 2U);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorNextDeadline(&agg)
+                        == ((HZL_PLATFORM_AGGREGATION_BATCHES > 1U) ? 2000U : 3000U));
+    // A freed batch is preferred over replacing one due first.
+    agg.batches[0].messages = 0U;
+    HZL_SIM_TEST_ASSERT(hzlPlatform_AggregatorBatchOf(&agg, (hzl_Gid_t) (newGid + 1U))
+                        == &agg.batches[0]);
+}
+
+int
+main(void)
+{
+    hzlSim_TestWellFormed();
+    hzlSim_TestBatchBoundaries();
+    hzlSim_TestBatchReplacement();
+    return hzlSim_TestResult("hzlsim_test_aggregation");
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host test of the Request schedule of hzlPlatform_HandshakeBackoff.h: the startup jitter, the
+ * bounds of the next Request after each unanswered one, the doubling and capping of the backoff
+ * window and the reset by a completed handshake.
+ *
+ * Usage: `hzlsim_test_backoff`, exits with a failure status if any assertion fails.
+ */
+
+#include <stdint.h>
+
+#include "hzlPlatform_HandshakeBackoff.h"
+#include "hzlSim_Test.h"
+
+/** @internal Timeout of the Requests: the window doubles 4 times before reaching it. */
+#define HZL_SIM_TEST_CAP_MICROS (10U * HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS)
+/** @internal Start of the tests, far from 0 like the clock of a running node. */
+#define HZL_SIM_TEST_START_MICROS 1000000U
+
+/** @internal Random values covering both ends of the jitter and its wrap-around. */
+static const uint32_t gRandoms[] = {0U, 1U, 12345U, 0x7FFFFFFFU, 0x9E3779B9U, UINT32_MAX};
+#define HZL_SIM_TEST_RANDOMS_AMOUNT (sizeof(gRandoms) / sizeof(gRandoms[0]))
+
+/**
+ * @internal
+ * Backoff windows after 0, 1, 2... unanswered Requests, in units of the base window, for a cap
+ * of #HZL_SIM_TEST_CAP_MICROS: doubled until capped.
+ */
+static const uint32_t gWindowsInBase[] = {1U, 2U, 4U, 8U, 10U, 10U, 10U};
+#define HZL_SIM_TEST_WINDOWS_AMOUNT (sizeof(gWindowsInBase) / sizeof(gWindowsInBase[0]))
+
+/** @internal The first Request goes out within the startup jitter. */
+static void
+hzlSim_TestStartupJitter(void)
+{
+    hzlPlatform_HandshakeBackoff_t backoff;
+    for (size_t i = 0U; i < HZL_SIM_TEST_RANDOMS_AMOUNT; i++)
+    {
+        hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                         HZL_SIM_TEST_START_MICROS, gRandoms[i]);
+        HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros >= HZL_SIM_TEST_START_MICROS);
+        HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros
+                            <= HZL_SIM_TEST_START_MICROS
+                               + HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS);
+        HZL_SIM_TEST_ASSERT(backoff.capMicros == HZL_SIM_TEST_CAP_MICROS);
+        HZL_SIM_TEST_ASSERT(backoff.attempts == 0U);
+        HZL_SIM_TEST_ASSERT(!backoff.isDeferred);
+        HZL_SIM_TEST_ASSERT(hzlPlatform_HandshakeBackoffIsDue(&backoff, backoff.notBeforeMicros));
+        HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros == HZL_SIM_TEST_START_MICROS
+                            || !hzlPlatform_HandshakeBackoffIsDue(&backoff,
+                                                                  backoff.notBeforeMicros - 1U));
+    }
+    // Both ends of the jitter are reachable.
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS, 0U);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros == HZL_SIM_TEST_START_MICROS);
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS,
+                                     HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros
+                        == HZL_SIM_TEST_START_MICROS
+                           + HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS);
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS,
+                                     HZL_PLATFORM_HANDSHAKE_STARTUP_JITTER_MICROS + 1U);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros == HZL_SIM_TEST_START_MICROS);
+}
+
+/**
+ * @internal
+ * After each unanswered Request the next one is due within [now + cap - window / 2, now + cap],
+ * the window doubling per attempt up to the cap.
+ */
+static void
+hzlSim_TestWindowPerAttempt(void)
+{
+    hzlPlatform_HandshakeBackoff_t backoff;
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS, 0U);
+    uint64_t now = HZL_SIM_TEST_START_MICROS;
+    for (size_t attempt = 0U; attempt < HZL_SIM_TEST_WINDOWS_AMOUNT; attempt++)
+    {
+        HZL_SIM_TEST_ASSERT(backoff.attempts == attempt);
+        const uint64_t halfWindow =
+            (uint64_t) gWindowsInBase[attempt] * HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS / 2U;
+        const uint64_t latest = now + HZL_SIM_TEST_CAP_MICROS;
+        for (size_t i = 0U; i < HZL_SIM_TEST_RANDOMS_AMOUNT; i++)
+        {
+            hzlPlatform_HandshakeBackoff_t probe = backoff;
+            hzlPlatform_HandshakeBackoffSent(&probe, now, gRandoms[i]);
+            HZL_SIM_TEST_ASSERT(probe.notBeforeMicros >= latest - halfWindow);
+            HZL_SIM_TEST_ASSERT(probe.notBeforeMicros <= latest);
+        }
+        // The bounds are exact: half the window is the largest jitter.
+        hzlPlatform_HandshakeBackoff_t probe = backoff;
+        hzlPlatform_HandshakeBackoffSent(&probe, now, (uint32_t) halfWindow + 1U);
+        HZL_SIM_TEST_ASSERT(probe.notBeforeMicros == latest);
+        hzlPlatform_HandshakeBackoffSent(&backoff, now, (uint32_t) halfWindow);
+        HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros == latest - halfWindow);
+        HZL_SIM_TEST_ASSERT(!hzlPlatform_HandshakeBackoffIsDue(&backoff, now));
+        now = backoff.notBeforeMicros;
+        HZL_SIM_TEST_ASSERT(hzlPlatform_HandshakeBackoffIsDue(&backoff, now));
+    }
+}
+
+/** @internal A timeout below the base window caps the first window already. */
+static void
+hzlSim_TestCapBelowBase(void)
+{
+    const uint32_t capMicros = HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS / 2U;
+    hzlPlatform_HandshakeBackoff_t backoff;
+    hzlPlatform_HandshakeBackoffInit(&backoff, capMicros, HZL_SIM_TEST_START_MICROS, 0U);
+    hzlPlatform_HandshakeBackoffSent(&backoff, HZL_SIM_TEST_START_MICROS, capMicros / 2U);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros
+                        == HZL_SIM_TEST_START_MICROS + capMicros - capMicros / 2U);
+}
+
+/** @internal The attempts saturate instead of wrapping around to the base window. */
+static void
+hzlSim_TestAttemptsSaturate(void)
+{
+    hzlPlatform_HandshakeBackoff_t backoff;
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS, 0U);
+    const uint32_t halfCap = HZL_SIM_TEST_CAP_MICROS / 2U;
+    for (uint32_t i = 0U; i < UINT8_MAX + 2U; i++)
+    {
+        hzlPlatform_HandshakeBackoffSent(&backoff, HZL_SIM_TEST_START_MICROS, halfCap);
+    }
+    HZL_SIM_TEST_ASSERT(backoff.attempts == UINT8_MAX);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros
+                        == HZL_SIM_TEST_START_MICROS + HZL_SIM_TEST_CAP_MICROS - halfCap);
+}
+
+/** @internal A completed handshake drops the deferred Request and restarts the backoff. */
+static void
+hzlSim_TestCompleted(void)
+{
+    hzlPlatform_HandshakeBackoff_t backoff;
+    hzlPlatform_HandshakeBackoffInit(&backoff, HZL_SIM_TEST_CAP_MICROS,
+                                     HZL_SIM_TEST_START_MICROS, 0U);
+    hzlPlatform_HandshakeBackoffSent(&backoff, HZL_SIM_TEST_START_MICROS, 0U);
+    hzlPlatform_HandshakeBackoffSent(&backoff, HZL_SIM_TEST_START_MICROS, 0U);
+    backoff.isDeferred = true;  // As the TaskHzl does for a Request asked for too early.
+    hzlPlatform_HandshakeBackoffCompleted(&backoff);
+    HZL_SIM_TEST_ASSERT(!backoff.isDeferred);
+    HZL_SIM_TEST_ASSERT(backoff.attempts == 0U);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_HandshakeBackoffIsDue(&backoff, 0U));
+    const uint32_t halfBase = HZL_PLATFORM_HANDSHAKE_BACKOFF_BASE_MICROS / 2U;
+    hzlPlatform_HandshakeBackoffSent(&backoff, HZL_SIM_TEST_START_MICROS, halfBase);
+    HZL_SIM_TEST_ASSERT(backoff.notBeforeMicros
+                        == HZL_SIM_TEST_START_MICROS + HZL_SIM_TEST_CAP_MICROS - halfBase);
+}
+
+int
+main(void)
+{
+    hzlSim_TestStartupJitter();
+    hzlSim_TestWindowPerAttempt();
+    hzlSim_TestCapBelowBase();
+    hzlSim_TestAttemptsSaturate();
+    hzlSim_TestCompleted();
+    return hzlSim_TestResult("hzlsim_test_backoff");
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Host test of the security-warning limiter of hzlPlatform_SecWarnLimiter.h: the verdict on the
+ * consecutive warnings of a sender, its reset by an authenticated frame, the holdoff between two
+ * resynchronisations and the replacement of the sender that warned least recently.
+ *
+ * Usage: `hzlsim_test_secwarn`, exits with a failure status if any assertion fails.
+ */
+
+#include <stdint.h>
+
+#include "hzlPlatform_SecWarnLimiter.h"
+#include "hzlSim_Test.h"
+
+/** @internal Start of the tests, far from 0 like the clock of a running node. */
+#define HZL_SIM_TEST_START_MICROS 1000000U
+#define HZL_SIM_TEST_CANID_SERVER 0x700U
+#define HZL_SIM_TEST_CANID_ALICE 0x70AU
+
+_Static_assert(HZL_PLATFORM_SECWARN_SENDERS >= 2U, "The tests account 2 senders at once.");
+
+/**
+ * @internal
+ * Accounts the given amount of warnings of the CAN ID at the given time, all of which must be
+ * tolerated.
+ */
+static void
+hzlSim_TestTolerated(hzlPlatform_SecWarnLimiter_t* const limiter,
+                     const uint32_t canId,
+                     const uint32_t warnings,
+                     const uint64_t nowMicros)
+{
+    for (uint32_t i = 0U; i < warnings; i++)
+    {
+        HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(limiter, canId, nowMicros)
+                            == HZL_PLATFORM_SECWARN_VERDICT_TOLERATED);
+    }
+}
+
+/** @internal Resynchronisation on the (MAX_CONSECUTIVE + 1)-th warning in a row only. */
+static void
+hzlSim_TestResyncAfterMaxConsecutive(void)
+{
+    hzlPlatform_SecWarnLimiter_t limiter = {0};
+    const uint64_t now = HZL_SIM_TEST_START_MICROS;
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    HZL_SIM_TEST_ASSERT(!limiter.hasResynced);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_SERVER, now)
+                        == HZL_PLATFORM_SECWARN_VERDICT_RESYNC);
+    HZL_SIM_TEST_ASSERT(limiter.hasResynced);
+    HZL_SIM_TEST_ASSERT(limiter.lastResyncMicros == now);
+    // Judged: the count starts over.
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+}
+
+/** @internal An authenticated frame resets the count of its CAN ID only. */
+static void
+hzlSim_TestResetOnValidated(void)
+{
+    hzlPlatform_SecWarnLimiter_t limiter = {0};
+    const uint64_t now = HZL_SIM_TEST_START_MICROS;
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_ALICE,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    hzlPlatform_SecWarnLimiterValidated(&limiter, HZL_SIM_TEST_CANID_SERVER);
+    // Validating a CAN ID without warnings changes nothing.
+    hzlPlatform_SecWarnLimiterValidated(&limiter, HZL_SIM_TEST_CANID_ALICE + 1U);
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_ALICE, now)
+                        == HZL_PLATFORM_SECWARN_VERDICT_RESYNC);
+}
+
+/** @internal At most one resynchronisation per holdoff, counted from the last one. */
+static void
+hzlSim_TestHoldOff(void)
+{
+    hzlPlatform_SecWarnLimiter_t limiter = {0};
+    const uint64_t resyncMicros = HZL_SIM_TEST_START_MICROS;
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, resyncMicros);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_SERVER,
+                                                         resyncMicros)
+                        == HZL_PLATFORM_SECWARN_VERDICT_RESYNC);
+    // Desynchronised again, by another sender, just before the end of the holdoff.
+    uint64_t now = resyncMicros + HZL_PLATFORM_SECWARN_RESYNC_HOLDOFF_MICROS - 1U;
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_ALICE,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_ALICE, now)
+                        == HZL_PLATFORM_SECWARN_VERDICT_HELD_OFF);
+    // A held-off verdict does not extend the holdoff.
+    HZL_SIM_TEST_ASSERT(limiter.lastResyncMicros == resyncMicros);
+    // Desynchronised again right at the end of the holdoff.
+    now++;
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_ALICE,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_ALICE, now)
+                        == HZL_PLATFORM_SECWARN_VERDICT_RESYNC);
+    HZL_SIM_TEST_ASSERT(limiter.lastResyncMicros == now);
+}
+
+/** @internal With all entries in use, a new CAN ID replaces the one that warned least recently. */
+static void
+hzlSim_TestEviction(void)
+{
+    hzlPlatform_SecWarnLimiter_t limiter = {0};
+    // One CAN ID per entry, each one warning short of a verdict. The middle one warned least
+    // recently, although it was not the first to warn.
+    const size_t stalestIdx = HZL_PLATFORM_SECWARN_SENDERS / 2U;
+    uint64_t now = HZL_SIM_TEST_START_MICROS;
+    for (size_t i = 0U; i < HZL_PLATFORM_SECWARN_SENDERS; i++)
+    {
+        now++;
+        hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_ALICE + (uint32_t) i,
+                             HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE,
+                             (i == stalestIdx) ? HZL_SIM_TEST_START_MICROS : now);
+    }
+    // The new CAN ID takes the entry of the stalest one, whose warnings are forgotten.
+    const uint32_t newCanId = HZL_SIM_TEST_CANID_ALICE + HZL_PLATFORM_SECWARN_SENDERS;
+    now++;
+    HZL_SIM_TEST_ASSERT(hzlPlatform_SecWarnLimiterWarned(&limiter, newCanId, now)
+                        == HZL_PLATFORM_SECWARN_VERDICT_TOLERATED);
+    HZL_SIM_TEST_ASSERT(limiter.senders[stalestIdx].canId == newCanId);
+    HZL_SIM_TEST_ASSERT(limiter.senders[stalestIdx].warnings == 1U);
+    // The others kept their warnings: one more is a verdict each.
+    for (size_t i = 0U; i < HZL_PLATFORM_SECWARN_SENDERS; i++)
+    {
+        if (i != stalestIdx)
+        {
+            HZL_SIM_TEST_ASSERT(
+                hzlPlatform_SecWarnLimiterWarned(&limiter, HZL_SIM_TEST_CANID_ALICE + (uint32_t) i,
+                                                 now)
+                != HZL_PLATFORM_SECWARN_VERDICT_TOLERATED);
+        }
+    }
+    // The replaced CAN ID starts over.
+    hzlSim_TestTolerated(&limiter, HZL_SIM_TEST_CANID_ALICE + (uint32_t) stalestIdx,
+                         HZL_PLATFORM_SECWARN_MAX_CONSECUTIVE, now);
+}
+
+int
+main(void)
+{
+    hzlSim_TestResyncAfterMaxConsecutive();
+    hzlSim_TestResetOnValidated();
+    hzlSim_TestHoldOff();
+    hzlSim_TestEviction();
+    return hzlSim_TestResult("hzlsim_test_secwarn");
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Minimal subset of the S32 SDK and Processor Expert generated code used by the platform layer,
+ * declared for the host (Linux) simulation.
+ *
+ * Only the types, macros and functions the `Sources/hzlPlatform_*.c` files actually use are
+ * provided. Their behaviour is implemented in hzlSim_Sdk.c, which is compiled once per simulated
+ * node, so each node has its own peripherals.
+ */
+
+#ifndef HZL_SIM_SDK_H_
+#define HZL_SIM_SDK_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ------------- Common -----------------
+
+/**
+ * The host libc (printf, clock_gettime) needs much more stack than the 500 words the TaskHzl
+ * gets on the S32K144, so the simulated ones are given more.
+ */
+#define HZL_PLATFORM_TASK_STACK_WORDS_HZL (configMINIMAL_STACK_SIZE * 4U)
+
+typedef enum
+{
+    STATUS_SUCCESS = 0x000U,
+    STATUS_ERROR = 0x001U,
+    STATUS_BUSY = 0x002U,
+    STATUS_TIMEOUT = 0x003U,
+    STATUS_UNSUPPORTED = 0x004U,
+} status_t;
+
+#define NOP() __asm__ volatile ("nop")
+
+// The simulated interrupt service routines are executed by the bus task with the scheduler
+// suspended (see hzlSim_Bus.c). xTaskResumeAll() performs the context switch afterwards, so
+// yielding from within the "ISR" is neither needed nor allowed.
+#undef portYIELD_FROM_ISR
+#define portYIELD_FROM_ISR(x) ((void) (x))
+
+// ------------- Interrupt manager -----------------
+
+typedef enum
+{
+    CAN0_ORed_IRQn,
+    CAN0_Error_IRQn,
+    CAN0_ORed_0_15_MB_IRQn,
+    CAN0_ORed_16_31_MB_IRQn,
+    CAN1_ORed_IRQn,
+    CAN1_Error_IRQn,
+    CAN1_ORed_0_15_MB_IRQn,
+    CAN2_ORed_IRQn,
+    CAN2_Error_IRQn,
+    CAN2_ORed_0_15_MB_IRQn,
+    PORTA_IRQn,
+    PORTB_IRQn,
+    PORTC_IRQn,
+    PORTD_IRQn,
+    PORTE_IRQn,
+    LPIT0_Ch0_IRQn,
+    LPIT0_Ch1_IRQn,
+    LPIT0_Ch2_IRQn,
+    LPIT0_Ch3_IRQn,
+    HZL_SIM_IRQn_AMOUNT,
+} IRQn_Type;
+
+typedef void (*isr_t)(void);
+
+void INT_SYS_InstallHandler(IRQn_Type irqNumber, isr_t newHandler, isr_t* oldHandler);
+void INT_SYS_EnableIRQ(IRQn_Type irqNumber);
+void INT_SYS_DisableIRQ(IRQn_Type irqNumber);
+void INT_SYS_SetPriority(IRQn_Type irqNumber, uint8_t priority);
+
+// ------------- Clock manager -----------------
+
+typedef struct
+{
+    uint32_t unused;
+} clock_manager_user_config_t;
+
+extern clock_manager_user_config_t clockMan1_InitConfig0;
+
+status_t CLOCK_DRV_Init(const clock_manager_user_config_t* config);
+
+// ------------- Pins -----------------
+
+typedef uint32_t pins_channel_type_t;
+typedef uint32_t pins_level_type_t;
+
+typedef struct
+{
+    volatile uint32_t PDOR;  // Port Data Output Register
+    volatile uint32_t PDIR;  // Port Data Input Register
+    volatile uint32_t PDDR;  // Port Data Direction Register
+} GPIO_Type;
+
+typedef struct
+{
+    volatile uint32_t ISFR;  // Interrupt Status Flag Register
+} PORT_Type;
+
+typedef enum
+{
+    PORT_MUX_AS_GPIO = 1U,
+} port_mux_t;
+
+typedef enum
+{
+    PORT_DMA_INT_DISABLED = 0x0U,
+    PORT_INT_RISING_EDGE = 0x9U,
+    PORT_INT_FALLING_EDGE = 0xAU,
+    PORT_INT_EITHER_EDGE = 0xBU,
+} port_interrupt_config_t;
+
+typedef struct
+{
+    uint32_t unused;
+} pin_settings_config_t;
+
+extern GPIO_Type hzlSim_GpioC;
+extern GPIO_Type hzlSim_GpioD;
+extern PORT_Type hzlSim_PortC;
+extern PORT_Type hzlSim_PortD;
+#define PTC (&hzlSim_GpioC)
+#define PTD (&hzlSim_GpioD)
+#define PORTC (&hzlSim_PortC)
+#define PORTD (&hzlSim_PortD)
+
+#define NUM_OF_CONFIGURED_PINS 0U
+extern pin_settings_config_t g_pin_mux_InitConfigArr[];
+
+status_t PINS_DRV_Init(uint32_t pinCount, const pin_settings_config_t config[]);
+void PINS_DRV_SetMuxModeSel(PORT_Type* base, uint32_t pin, port_mux_t mux);
+void PINS_DRV_SetPinIntSel(PORT_Type* base, uint32_t pin, port_interrupt_config_t intConfig);
+uint32_t PINS_DRV_GetPortIntFlag(const PORT_Type* base);
+void PINS_DRV_ClearPortIntFlagCmd(PORT_Type* base);
+void PINS_DRV_SetPinsDirection(GPIO_Type* base, pins_channel_type_t pins);
+void PINS_DRV_SetPinDirection(GPIO_Type* base, pins_channel_type_t pin,
+                              pins_level_type_t direction);
+void PINS_DRV_WritePin(GPIO_Type* base, pins_channel_type_t pin, pins_level_type_t value);
+void PINS_DRV_SetPins(GPIO_Type* base, pins_channel_type_t pins);
+void PINS_DRV_ClearPins(GPIO_Type* base, pins_channel_type_t pins);
+void PINS_DRV_TogglePins(GPIO_Type* base, pins_channel_type_t pins);
+pins_channel_type_t PINS_DRV_ReadPins(const GPIO_Type* base);
+
+// ------------- CSEc -----------------
+
+typedef struct
+{
+    uint32_t unused;
+} csec_state_t;
+
+extern csec_state_t csec1_State;
+
+void CSEC_DRV_Init(csec_state_t* state);
+status_t CSEC_DRV_InitRNG(void);
+status_t CSEC_DRV_GenerateRND(uint8_t* rnd);
+
+// ------------- FLEXCAN -----------------
+
+#define HZL_SIM_FLEXCAN_INSTANCES 3U
+#define HZL_SIM_FLEXCAN_MAILBOXES 32U
+/** Protocol engine clock of every FLEXCAN, as pe_clock_value0 in ProcessorExpert.pe. */
+#define HZL_SIM_FLEXCAN_CLOCK_HZ 40000000UL
+#define INST_CANCOM1 0U
+#define INST_CANCOM2 1U
+#define INST_CANCOM3 2U
+
+typedef struct
+{
+    volatile uint32_t MCR;  // Module Configuration Register
+} CAN_Type;
+
+#define CAN_MCR_FRZ_MASK 0x40000000U
+#define CAN_MCR_HALT_MASK 0x10000000U
+/** The simulated FLEXCAN enters and leaves the freeze mode at once: FRZACK follows HALT. */
+#define CAN_MCR_FRZACK_MASK CAN_MCR_HALT_MASK
+#define CAN_MCR_SRXDIS_MASK 0x00020000U
+
+extern CAN_Type hzlSim_Can[HZL_SIM_FLEXCAN_INSTANCES];
+#define CAN_BASE_PTRS {&hzlSim_Can[0], &hzlSim_Can[1], &hzlSim_Can[2]}
+
+typedef enum
+{
+    FLEXCAN_MSG_ID_STD,
+    FLEXCAN_MSG_ID_EXT,
+} flexcan_msgbuff_id_type_t;
+
+typedef enum
+{
+    FLEXCAN_RX_MASK_GLOBAL,
+    FLEXCAN_RX_MASK_INDIVIDUAL,
+} flexcan_rx_mask_type_t;
+
+typedef enum
+{
+    FLEXCAN_EVENT_RX_COMPLETE,
+    FLEXCAN_EVENT_RXFIFO_COMPLETE,
+    FLEXCAN_EVENT_RXFIFO_WARNING,
+    FLEXCAN_EVENT_RXFIFO_OVERFLOW,
+    FLEXCAN_EVENT_TX_COMPLETE,
+    FLEXCAN_EVENT_WAKEUP_TIMEOUT,
+    FLEXCAN_EVENT_WAKEUP_MATCH,
+    FLEXCAN_EVENT_SELF_WAKEUP,
+    FLEXCAN_EVENT_DMA_COMPLETE,
+    FLEXCAN_EVENT_DMA_ERROR,
+    FLEXCAN_EVENT_ERROR,
+} flexcan_event_type_t;
+
+typedef struct
+{
+    uint32_t data_length;
+    flexcan_msgbuff_id_type_t msg_id_type;
+    bool enable_brs;
+    bool fd_enable;
+    uint8_t fd_padding;
+    bool is_remote;
+} flexcan_data_info_t;
+
+typedef struct
+{
+    uint32_t cs;
+    uint32_t msgId;
+    uint8_t data[64];
+    uint8_t dataLen;
+} flexcan_msgbuff_t;
+
+typedef struct
+{
+    uint32_t propSeg;
+    uint32_t phaseSeg1;
+    uint32_t phaseSeg2;
+    uint32_t preDivider;
+    uint32_t rJumpwidth;
+} flexcan_time_segment_t;
+
+typedef struct
+{
+    uint32_t max_num_mb;
+    bool fd_enable;
+    flexcan_time_segment_t bitrate;
+    flexcan_time_segment_t bitrate_cbt;
+} flexcan_user_config_t;
+
+struct FlexCANState;
+
+typedef void (*flexcan_callback_t)(uint8_t instance,
+                                   flexcan_event_type_t eventType,
+                                   uint32_t buffIdx,
+                                   struct FlexCANState* flexcanState);
+
+typedef struct FlexCANState
+{
+    flexcan_callback_t callback;
+    void* callbackParam;
+} flexcan_state_t;
+
+extern flexcan_state_t canCom1_State;
+extern const flexcan_user_config_t canCom1_InitConfig0;
+extern flexcan_state_t canCom2_State;
+extern const flexcan_user_config_t canCom2_InitConfig0;
+extern flexcan_state_t canCom3_State;
+extern const flexcan_user_config_t canCom3_InitConfig0;
+
+status_t FLEXCAN_DRV_Init(uint8_t instance, flexcan_state_t* state,
+                          const flexcan_user_config_t* data);
+status_t FLEXCAN_DRV_Deinit(uint8_t instance);
+void FLEXCAN_DRV_SetBitrateCbt(uint8_t instance, const flexcan_time_segment_t* bitrate);
+void FLEXCAN_DRV_SetTDCOffset(uint8_t instance, bool enable, uint8_t offset);
+void FLEXCAN_DRV_SetRxMaskType(uint8_t instance, flexcan_rx_mask_type_t type);
+status_t FLEXCAN_DRV_SetRxIndividualMask(uint8_t instance, flexcan_msgbuff_id_type_t idType,
+                                         uint8_t mbIdx, uint32_t mask);
+status_t FLEXCAN_DRV_ConfigTxMb(uint8_t instance, uint8_t mbIdx,
+                                const flexcan_data_info_t* txInfo, uint32_t msgId);
+status_t FLEXCAN_DRV_ConfigRxMb(uint8_t instance, uint8_t mbIdx,
+                                const flexcan_data_info_t* rxInfo, uint32_t msgId);
+status_t FLEXCAN_DRV_Receive(uint8_t instance, uint8_t mbIdx, flexcan_msgbuff_t* data);
+status_t FLEXCAN_DRV_Send(uint8_t instance, uint8_t mbIdx,
+                          const flexcan_data_info_t* txInfo, uint32_t msgId,
+                          const uint8_t* mbData);
+void FLEXCAN_DRV_InstallEventCallback(uint8_t instance, flexcan_callback_t callback,
+                                      void* callbackParam);
+
+// ------------- Simulation only -----------------
+
+struct hzlSim_Port;
+
+/**
+ * Connects the simulated peripherals of this node to its port on the virtual bus.
+ * The seed makes the simulated TRNG output different, yet repeatable, for each node.
+ */
+void hzlSim_SdkBind(struct hzlSim_Port* port, uint64_t trngSeed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_SIM_SDK_H_ */
@@ -0,0 +1,12 @@
+/**
+ * @file
+ * Host simulation replacement of the S32 SDK header with the same name.
+ * See hzlSim_Sdk.h.
+ */
+
+#ifndef HZL_SIM_SDK_PIN_MUX_H_
+#define HZL_SIM_SDK_PIN_MUX_H_
+
+#include "hzlSim_Sdk.h"
+
+#endif  /* HZL_SIM_SDK_PIN_MUX_H_ */